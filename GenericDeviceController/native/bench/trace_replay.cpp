@@ -0,0 +1,928 @@
+// trace_replay.cpp
+// 主机端到端基准测试：把录制的命令序列按原时间间隔送入真实的callback()，
+// 单线程按轮调用网络任务和执行任务的step函数，统计每条命令从收到到回执发布的延迟。
+// 同时测量命令分发（改为路由表前的sscanf+strcmp链与路由表+分发表对比）、单设备命令解析（parse_command与ArduinoJson对比）、
+// 回执编码（MessageWriter按JSON与MessagePack写入StateAck/SensorAck）和LOG_INFO调用的耗时；
+// 启用传感器模拟器的节点还按一组典型操作测量每次操作的TFT绘制像素数。
+// 回放结束后把每条单设备命令和批量命令以新的关联ID再送入两次，检查第二次由去重缓存重放原回执、不进入命令队列，并统计重放耗时；
+// 启动时测量setup()与设备表的加载耗时（映射分区与编译内置设备表两条路径），并核对按编号查找设备的下标
+//
+// 用法：.pio/build/native/program [trace文件] [-v] [--devtable 设备表文件]
+//   trace文件默认为native/bench/traces/node<CURRENT_NODE>.trace；-v时输出固件日志；
+//   --devtable时先把tools/device_table.py生成的设备表写入模拟的devtable分区，再调用setup()
+//
+// trace格式（与test/record_command_trace.py的输出一致），每行一条命令，#开头为注释：
+//   <相对首条命令的毫秒数> <topic> <payload>
+#include "GenericDeviceController.ino"
+#include <driver/spi_master.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+typedef std::chrono::steady_clock HostClock;
+
+static const unsigned long REPLAY_DRAIN_TIMEOUT_MS = 10000;     // 最后一条命令后等待回执的虚拟时间上限
+static const int DISPATCH_BENCH_ITERATIONS = 20000;
+static const int PARSE_BENCH_ITERATIONS = 20000;
+static const int CODEC_BENCH_ITERATIONS = 20000;
+static const int LOG_BENCH_ITERATIONS = 20000;
+static const size_t COMMAND_JSON_DOC_SIZE = 256;                // 改为原地解析前callback()使用的文档大小
+
+struct TraceEntry {
+    unsigned long offset_ms;
+    std::string topic;
+    std::string payload;
+};
+
+struct PendingCommand {
+    unsigned long start_ms;             // 虚拟时间
+    HostClock::time_point start_host;   // 主机时间
+};
+
+// 丢弃日志输出；-v时改为串口（标准错误）
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+};
+
+static NullPrint nullPrint;
+static Print* logOutput = &nullPrint;
+static std::map<std::string, std::deque<PendingCommand>> pendingCommands;
+static std::vector<double> virtualLatencyMs;
+static std::vector<double> hostLatencyUs;
+static size_t pendingCount = 0;
+static size_t ackCount = 0;
+static int deviceTableErrors = 0;
+static int dispatchErrors = 0;
+static int codecErrors = 0;
+static int dedupeErrors = 0;
+static bool injecting = false;         // 正在处理刚送入的命令（尚未推进虚拟时间）
+
+/**
+ * @brief 读取trace文件
+ * @return false表示文件无法打开或没有命令
+ */
+bool load_trace(const char* path, std::vector<TraceEntry>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        TraceEntry entry;
+        if (!(fields >> entry.offset_ms >> entry.topic)) {
+            continue;
+        }
+        std::getline(fields >> std::ws, entry.payload);
+        entries.push_back(entry);
+    }
+    return !entries.empty();
+}
+
+/**
+ * @brief 从回执中取出correlation_id（回执由MessageWriter流式生成，字段顺序固定）
+ */
+std::string ack_correlation_id(const uint8_t* payload, unsigned int length) {
+    static const char KEY[] = "\"correlation_id\":\"";
+    std::string text((const char*)payload, length);
+    size_t start = text.find(KEY);
+    if (start == std::string::npos) {
+        return std::string();
+    }
+    start += sizeof(KEY) - 1;
+    size_t end = text.find('"', start);
+    return end == std::string::npos ? std::string() : text.substr(start, end - start);
+}
+
+/**
+ * @brief PubSubClient替身的发布钩子：按correlation_id匹配待回执的命令，记录延迟
+ * 仍在执行时收到的重复命令与原命令共用一条回执，因此一条回执完成该关联ID下所有待回执的命令；
+ * 主机耗时只统计送入后立即完成的命令（延迟完成的命令期间包含推进虚拟时间的空转轮次）
+ */
+void on_publish(const char*, const uint8_t* payload, unsigned int length) {
+    auto it = pendingCommands.find(ack_correlation_id(payload, length));
+    if (it == pendingCommands.end()) {
+        return;
+    }
+    for (const PendingCommand& pending : it->second) {
+        virtualLatencyMs.push_back((double)(millis() - pending.start_ms));
+        if (injecting) {
+            hostLatencyUs.push_back(std::chrono::duration<double, std::micro>(HostClock::now() - pending.start_host).count());
+        }
+        pendingCount--;
+        ackCount++;
+    }
+    pendingCommands.erase(it);
+}
+
+/**
+ * @brief 命令中的correlation_id，用于匹配回执
+ */
+std::string command_correlation_id(const std::string& payload) {
+    return ack_correlation_id((const uint8_t*)payload.data(), (unsigned int)payload.size());
+}
+
+/**
+ * @brief 两个任务各运行一轮：收包→执行→发布回执，与固件中两任务相互通知后的顺序一致
+ */
+void run_round() {
+    network_task_step();
+    executor_task_step();
+    network_task_step();
+    async_log().drain(*logOutput);
+}
+
+/**
+ * @brief 推进虚拟时间到target_ms；期间按执行任务的周期运行，舵机关键帧和传感器遥测照常推进
+ */
+void advance_to(unsigned long target_ms) {
+    while (millis() < target_ms) {
+        unsigned long step = std::min<unsigned long>(EXECUTOR_TASK_PERIOD_MS, target_ms - millis());
+        mock_advance_ms(step);
+        run_round();
+    }
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+void print_distribution(const char* name, const std::vector<double>& values, const char* unit) {
+    printf("  %-24s p50 %9.2f  p99 %9.2f  max %9.2f %s\n", name, percentile(values, 0.50),
+           percentile(values, 0.99), percentile(values, 1.0), unit);
+}
+
+/**
+ * @brief 按trace回放命令，输出吞吐量与每条命令的延迟分布
+ */
+void bench_trace_replay(const std::vector<TraceEntry>& entries) {
+    client.publish_hook = on_publish;
+    unsigned long base_ms = millis();
+    double busy_us = 0;
+
+    for (const TraceEntry& entry : entries) {
+        advance_to(base_ms + entry.offset_ms);
+
+        std::string id = command_correlation_id(entry.payload);
+        pendingCommands[id].push_back(PendingCommand{millis(), HostClock::now()});
+        pendingCount++;
+
+        HostClock::time_point start = HostClock::now();
+        injecting = true;
+        client.inject(entry.topic.c_str(), (const uint8_t*)entry.payload.data(), (unsigned int)entry.payload.size());
+        while (client.pending() > 0) {
+            run_round();
+        }
+        injecting = false;
+        busy_us += std::chrono::duration<double, std::micro>(HostClock::now() - start).count();
+    }
+
+    // 舵机等延迟完成的命令：推进虚拟时间直到全部回执发布
+    unsigned long deadline = millis() + REPLAY_DRAIN_TIMEOUT_MS;
+    while (pendingCount > 0 && millis() < deadline) {
+        advance_to(millis() + EXECUTOR_TASK_PERIOD_MS);
+    }
+    client.publish_hook = nullptr;
+
+    printf("[Replay] %s: %u command(s), %u ACK(s), %u without ACK, %lu ms virtual\n", NODE_ID,
+           (unsigned)entries.size(), (unsigned)ackCount, (unsigned)pendingCount, millis() - base_ms);
+    printf("  %-24s %9.0f cmd/s (host time spent on receive/execute/publish)\n", "throughput",
+           busy_us > 0 ? entries.size() * 1e6 / busy_us : 0);
+    print_distribution("latency (firmware time)", virtualLatencyMs, "ms");
+    print_distribution("latency (host time)", hostLatencyUs, "us");
+    printf("  %u command(s) completed later (servo motions), counted in firmware time only\n",
+           (unsigned)(virtualLatencyMs.size() - hostLatencyUs.size()));
+}
+
+// 去重检查期间发布的、关联ID为dedupeId的回执（忽略同期的遥测和运行指标）
+static std::string dedupeId;
+static std::vector<std::string> dedupeAcks;
+
+void on_dedupe_publish(const char*, const uint8_t* payload, unsigned int length) {
+    if (ack_correlation_id(payload, length) == dedupeId) {
+        dedupeAcks.push_back(std::string((const char*)payload, length));
+    }
+}
+
+/**
+ * @brief 直接调用callback()送入一条命令（与client.loop()收包后的调用相同，payload会被原地改写，因此先复制）
+ * @return callback()的主机耗时（us）
+ */
+double dedupe_callback(const std::string& topic, const std::string& payload) {
+    std::vector<char> topic_buf(topic.begin(), topic.end());
+    topic_buf.push_back('\0');
+    std::vector<byte> buffer(payload.begin(), payload.end());
+    HostClock::time_point start = HostClock::now();
+    callback(topic_buf.data(), buffer.data(), (unsigned int)buffer.size());
+    return std::chrono::duration<double, std::micro>(HostClock::now() - start).count();
+}
+
+/**
+ * @brief 关联ID去重：每条单设备命令和批量命令换用新的关联ID送入两次，第一次正常执行（等待舵机等延迟回执），
+ * 第二次必须不进入commandQueue、在callback()内重放与第一次逐字节相同的回执；
+ * 另以两个前63字节相同的超长关联ID检查二者都被拒绝，不会命中同一缓存项
+ */
+void bench_dedupe(const std::vector<TraceEntry>& entries) {
+    client.publish_hook = on_dedupe_publish;
+    std::vector<double> replay_us;
+    int checked = 0;
+    std::string long_topic;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const TraceEntry& entry = entries[i];
+        std::string id = command_correlation_id(entry.payload);
+        bool batch = entry.topic == batchCommandTopic;
+        if ((!batch && find_route(entry.topic.c_str()) == nullptr) || id.empty()) {
+            continue;
+        }
+        if (!batch) {
+            long_topic = entry.topic;
+        }
+        dedupeId = "dedupe-" + std::to_string(i);
+        std::string payload = entry.payload;
+        payload.replace(payload.find(id), id.size(), dedupeId);
+
+        // 第一次：正常执行，等待回执发布
+        dedupeAcks.clear();
+        dedupe_callback(entry.topic, payload);
+        unsigned long deadline = millis() + REPLAY_DRAIN_TIMEOUT_MS;
+        while (dedupeAcks.empty() && millis() < deadline) {
+            advance_to(millis() + EXECUTOR_TASK_PERIOD_MS);
+        }
+        if (dedupeAcks.size() != 1) {
+            printf("  [FAIL] %s: %u ACK(s) for the first copy\n", entry.topic.c_str(), (unsigned)dedupeAcks.size());
+            dedupeErrors++;
+            continue;
+        }
+        std::string original = dedupeAcks[0];
+
+        // 第二次：同一关联ID，必须在callback()内由缓存回复
+        dedupeAcks.clear();
+        double us = dedupe_callback(entry.topic, payload);
+        if (commandQueue.size() != 0) {
+            printf("  [FAIL] %s: duplicate reached the command queue\n", entry.topic.c_str());
+            dedupeErrors++;
+            run_round();
+        } else if (dedupeAcks.size() != 1 || dedupeAcks[0] != original) {
+            printf("  [FAIL] %s: duplicate not answered with the original ACK\n", entry.topic.c_str());
+            dedupeErrors++;
+        } else {
+            replay_us.push_back(us);
+        }
+        checked++;
+    }
+
+    // 超长关联ID：前63字节相同的两个ID都应以CORRELATION_ID_TOO_LONG拒绝
+    if (!long_topic.empty()) {
+        std::string prefix(CORRELATION_ID_MAX_LEN - 1, 'x');
+        for (const char* suffix : {"-first", "-second"}) {
+            dedupeId = prefix + suffix;
+            dedupeAcks.clear();
+            dedupe_callback(long_topic, "{\"action\":\"ON\",\"correlation_id\":\"" + prefix + suffix + "\"}");
+            if (commandQueue.size() != 0 || dedupeAcks.size() != 1 ||
+                dedupeAcks[0].find("CORRELATION_ID_TOO_LONG") == std::string::npos) {
+                printf("  [FAIL] over-long correlation_id%s was not rejected\n", suffix);
+                dedupeErrors++;
+                run_round();
+            }
+        }
+    }
+    client.publish_hook = nullptr;
+
+    printf("[Dedupe] %d command(s) sent twice, %u duplicate(s) answered from the cache\n", checked,
+           (unsigned)replay_us.size());
+    print_distribution("replay (host time)", replay_us, "us");
+}
+
+// 改为分发表前callback()中按设备类型比较的顺序（baseline）
+static const char* const BASELINE_DEVICE_TYPES[] = {
+    "light", "ac", "hood", "fan", "bedside_light", "window", "curtain",
+    "temp_sensor", "humidity_sensor", "brightness_sensor", "smoke_sensor", "gas_sensor"
+};
+
+/**
+ * @brief 改为路由表前的分发过程：sscanf拆分Topic，按设备类型逐个strcmp，再在设备列表中逐项比较房间和设备ID
+ * @param topic 命令Topic
+ * @param type 输出设备类型在BASELINE_DEVICE_TYPES中的下标，-1表示未知类型
+ * @return 设备下标，不是本节点设备时返回-1
+ */
+int baseline_dispatch(const char* topic, int* type) {
+    char room[32], device[32];
+    *type = -1;
+    if (sscanf(topic, "smarthome/%31[^/]/%31[^/]/command", room, device) != 2) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(BASELINE_DEVICE_TYPES) / sizeof(BASELINE_DEVICE_TYPES[0]); i++) {
+        if (strcmp(device, BASELINE_DEVICE_TYPES[i]) == 0) {
+            *type = (int)i;
+            break;
+        }
+    }
+    for (int i = 0; i < device_count; i++) {
+        if (strcmp(devices[i].room_id, room) == 0 && strcmp(devices[i].device_id, device) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 命令分发：对trace中的命令Topic比较baseline的strcmp链、find_route()和find_device_route()，
+ * 后两者都再经lookup_device_handler()按设备类型编号取处理函数；三者找到的设备必须一致
+ */
+void bench_dispatch(const std::vector<TraceEntry>& entries) {
+    struct DispatchTopic {
+        std::string topic;
+        std::string room;
+        std::string device;
+    };
+    std::vector<DispatchTopic> topics;
+    for (const TraceEntry& entry : entries) {
+        char room[32], device[32];
+        if (sscanf(entry.topic.c_str(), "smarthome/%31[^/]/%31[^/]/command", room, device) == 2) {
+            topics.push_back(DispatchTopic{entry.topic, room, device});
+        }
+    }
+    if (topics.empty()) {
+        return;
+    }
+
+    int mismatches = 0;
+    for (const DispatchTopic& t : topics) {
+        int type;
+        int expected = baseline_dispatch(t.topic.c_str(), &type);
+        const DeviceRoute* route = find_route(t.topic.c_str());
+        const DeviceRoute* by_name = find_device_route(t.room.c_str(), t.device.c_str());
+        int found = route != nullptr ? (int)(route->handle - device_handles) : -1;
+        int found_by_name = by_name != nullptr ? (int)(by_name->handle - device_handles) : -1;
+        if (found != expected || found_by_name != expected) {
+            printf("  [FAIL] %s: strcmp chain -> %d, find_route -> %d, find_device_route -> %d\n",
+                   t.topic.c_str(), expected, found, found_by_name);
+            mismatches++;
+        }
+    }
+    dispatchErrors += mismatches;
+
+    volatile intptr_t sink = 0;
+    HostClock::time_point start = HostClock::now();
+    for (int i = 0; i < DISPATCH_BENCH_ITERATIONS; i++) {
+        int type;
+        sink += baseline_dispatch(topics[i % topics.size()].topic.c_str(), &type) + type;
+    }
+    double baseline_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+
+    start = HostClock::now();
+    for (int i = 0; i < DISPATCH_BENCH_ITERATIONS; i++) {
+        const DeviceRoute* route = find_route(topics[i % topics.size()].topic.c_str());
+        sink += route != nullptr ? (intptr_t)lookup_device_handler(route->handle->type) : 0;
+    }
+    double route_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+
+    start = HostClock::now();
+    for (int i = 0; i < DISPATCH_BENCH_ITERATIONS; i++) {
+        const DispatchTopic& t = topics[i % topics.size()];
+        const DeviceRoute* route = find_device_route(t.room.c_str(), t.device.c_str());
+        sink += route != nullptr ? (intptr_t)lookup_device_handler(route->handle->type) : 0;
+    }
+    double by_name_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+    (void)sink;
+
+    printf("[Dispatch] %d lookup(s) over %u command topic(s), %d mismatch(es)\n", DISPATCH_BENCH_ITERATIONS,
+           (unsigned)topics.size(), mismatches);
+    printf("  %-24s %9.1f ns/cmd\n", "sscanf + strcmp chain", baseline_ns / DISPATCH_BENCH_ITERATIONS);
+    printf("  %-24s %9.1f ns/cmd\n", "find_route() + switch", route_ns / DISPATCH_BENCH_ITERATIONS);
+    printf("  %-24s %9.1f ns/cmd\n", "find_device_route()", by_name_ns / DISPATCH_BENCH_ITERATIONS);
+}
+
+/**
+ * @brief 单设备命令解析：原地解析器与ArduinoJson反序列化对比，每次都从原始payload复制（两者都会改写缓冲区）
+ */
+void bench_parsers(const std::vector<TraceEntry>& entries) {
+    std::vector<std::string> payloads;
+    for (const TraceEntry& entry : entries) {
+        if (find_route(entry.topic.c_str()) != nullptr) {
+            payloads.push_back(entry.payload);
+        }
+    }
+    if (payloads.empty()) {
+        return;
+    }
+
+    byte buffer[MQTT_BUFFER_SIZE];
+    volatile int sink = 0;
+    HostClock::time_point start = HostClock::now();
+    for (int i = 0; i < PARSE_BENCH_ITERATIONS; i++) {
+        const std::string& payload = payloads[i % payloads.size()];
+        memcpy(buffer, payload.data(), payload.size());
+        ParsedCommand command;
+        sink += parse_command(buffer, (unsigned int)payload.size(), command);
+    }
+    double parser_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+
+    start = HostClock::now();
+    for (int i = 0; i < PARSE_BENCH_ITERATIONS; i++) {
+        const std::string& payload = payloads[i % payloads.size()];
+        memcpy(buffer, payload.data(), payload.size());
+        StaticJsonDocument<COMMAND_JSON_DOC_SIZE> doc;
+        sink += (int)(bool)deserializeJson(doc, buffer, payload.size());
+    }
+    double json_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+    (void)sink;
+
+    // 只有pio run -e native链接lib_deps中的ArduinoJson时对比才有意义，其他替身头文件的耗时不代表真实的库
+#ifdef ARDUINOJSON_VERSION
+    printf("[Parse] %d command payload(s), ArduinoJson %s\n", PARSE_BENCH_ITERATIONS, ARDUINOJSON_VERSION);
+#else
+    printf("[Parse] %d command payload(s), ArduinoJson stand-in (deserializeJson() time not comparable)\n",
+           PARSE_BENCH_ITERATIONS);
+#endif
+    printf("  %-24s %9.1f ns/cmd\n", "parse_command()", parser_ns / PARSE_BENCH_ITERATIONS);
+    printf("  %-24s %9.1f ns/cmd\n", "deserializeJson()", json_ns / PARSE_BENCH_ITERATIONS);
+}
+
+// 写入固定缓冲区的Print，替代编码基准中的MQTT连接
+class BufferPrint : public Print {
+public:
+    uint8_t data[256];
+    size_t used = 0;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        size_t n = std::min(size, sizeof(data) - used);
+        memcpy(data + used, buffer, n);
+        used += n;
+        return n;
+    }
+};
+
+/**
+ * @brief 按publish_message()的方式编码一条回执：先写入ByteCounter得到长度，再经ChunkedPrint写入输出流
+ * @return 消息字节数
+ */
+template <typename Message>
+size_t encode_ack(const Message& message, bool msgpack, BufferPrint& out) {
+    ByteCounter counter;
+    MessageWriter counting(counter, msgpack);
+    message.write(counting);
+
+    out.used = 0;
+    ChunkedPrint chunked(out);
+    MessageWriter writer(chunked, msgpack);
+    message.write(writer);
+    chunked.flush_chunk();
+    return counter.count;
+}
+
+/**
+ * @brief 测量一种回执在两种格式下的编码耗时与字节数
+ */
+template <typename Message>
+void bench_codec_message(const char* name, const Message& message) {
+    BufferPrint out;
+    size_t bytes[2] = {0, 0};
+    double ns[2] = {0, 0};
+    for (int format = 0; format < 2; format++) {
+        volatile size_t sink = 0;
+        HostClock::time_point start = HostClock::now();
+        for (int i = 0; i < CODEC_BENCH_ITERATIONS; i++) {
+            sink += encode_ack(message, format == 1, out);
+        }
+        ns[format] = std::chrono::duration<double, std::nano>(HostClock::now() - start).count() / CODEC_BENCH_ITERATIONS;
+        bytes[format] = out.used;
+        (void)sink;
+    }
+    printf("  %-10s JSON %7.1f ns %3u B   MessagePack %7.1f ns %3u B\n", name,
+           ns[0], (unsigned)bytes[0], ns[1], (unsigned)bytes[1]);
+}
+
+/**
+ * @brief 回执编码：MessageWriter以JSON和MessagePack写入典型的StateAck与SensorAck（含计算长度的一遍）
+ */
+void bench_codec() {
+    static const char CORRELATION_ID[] = "b48438b5-c41f-4dfd-acb8-5f3f4a24e39a";
+    StateAck state = { "ON", CORRELATION_ID };
+    SensorAck sensor = { "READ", CORRELATION_ID, 26.1f, "°C" };
+
+    printf("[Codec] %d encode(s) per message, length pass included\n", CODEC_BENCH_ITERATIONS);
+    bench_codec_message("StateAck", state);
+    bench_codec_message("SensorAck", sensor);
+
+    // 读数失败时的非有限值在JSON中必须输出为null（"%.2f"会得到无效的inf/nan）
+    const float non_finite[] = { NAN, INFINITY, -INFINITY };
+    BufferPrint out;
+    for (float value : non_finite) {
+        SensorAck ack = { "READ", CORRELATION_ID, value, "°C" };
+        encode_ack(ack, false, out);
+        std::string json((const char*)out.data, out.used);
+        if (json.find("\"value\":null") == std::string::npos) {
+            printf("  [FAIL] non-finite reading encoded as %s\n", json.c_str());
+            codecErrors++;
+        }
+    }
+}
+
+/**
+ * @brief 调用方看到的LOG_INFO耗时（格式化并写入环形缓冲区，不含串口输出）
+ */
+void bench_logging() {
+    std::vector<double> latency_ns;
+    latency_ns.reserve(LOG_BENCH_ITERATIONS);
+    for (int i = 0; i < LOG_BENCH_ITERATIONS; i++) {
+        HostClock::time_point start = HostClock::now();
+        LOG_INFO("[Bench] Message arrived on topic: %s (%d)", "smarthome/livingroom/light/command", i);
+        latency_ns.push_back(std::chrono::duration<double, std::nano>(HostClock::now() - start).count());
+        if (i % 32 == 31) {
+            async_log().drain(nullPrint);
+        }
+    }
+    async_log().drain(nullPrint);
+
+    printf("[Log] %d LOG_INFO call(s), %u dropped\n", LOG_BENCH_ITERATIONS, (unsigned)async_log().dropped());
+    print_distribution("LOG_INFO()", latency_ns, "ns");
+}
+
+/**
+ * @brief 设备表加载耗时（映射分区与编译内置设备表）及按(房间, 设备名)编号查找的结果
+ * @param setup_us setup()的主机耗时
+ */
+void bench_device_table(double setup_us) {
+    const int iterations = 20000;
+    const DeviceTable loaded = device_table;
+    bool from_partition = loaded.mapped;
+    printf("[DevTable] %s, %d device(s) in %d room(s), setup() %.1f us\n",
+           from_partition ? "mapped from partition" : "built-in device list", device_count, loaded.header->room_count, setup_us);
+
+    // 内置设备表编译到内存（分区为空时的启动路径），与分区中的设备表逐字节比较
+    alignas(4) static uint8_t compiled[DEVICE_TABLE_MAX_SIZE];
+    size_t size = 0;
+    HostClock::time_point start = HostClock::now();
+    for (int i = 0; i < iterations; i++) {
+        size = device_table_compile(builtin_devices, BUILTIN_DEVICE_COUNT, NODE_ID, compiled, sizeof(compiled));
+        device_table_attach(compiled, size, false);
+    }
+    double compile_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count() / iterations;
+    if (from_partition) {
+        bool same = loaded.header->size == size && memcmp(loaded.base, compiled, size) == 0;
+        printf("  partition table is %s the built-in list (%u bytes)\n", same ? "identical to" : "different from", (unsigned)loaded.header->size);
+    } else {
+        mock_partition_write(compiled, size);   // 测量映射路径时使用同一份设备表
+    }
+
+    start = HostClock::now();
+    for (int i = 0; i < iterations; i++) {
+        device_table_map_partition();
+    }
+    double map_ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count() / iterations;
+    if (!from_partition) {
+        mock_partition_erase();
+    }
+    device_table = loaded;
+
+    printf("  %-34s %9.1f ns\n", "map partition + validate", map_ns);
+    printf("  %-34s %9.1f ns\n", "compile built-in list + validate", compile_ns);
+
+    // 每个设备都能按编号直接取到自己的下标，不存在的组合返回-1
+    for (int i = 0; i < device_count; i++) {
+        int found = device_table_find(device_table_room(devices[i].room_id), device_table_name(devices[i].device_id));
+        deviceTableErrors += found == i ? 0 : 1;
+    }
+    deviceTableErrors += device_table_find(device_table_room("no_such_room"), 0) == -1 ? 0 : 1;
+    deviceTableErrors += device_table_find(device_table.header->room_count, 0) == -1 ? 0 : 1;
+    printf("  O(1) lookup: %s\n", deviceTableErrors == 0 ? "every device resolves to its own slot" : "WRONG SLOT");
+
+    // 设备句柄中的房间与设备类型编号与按字符串驻留的结果一致（不在符号表中的房间为ROOM_NONE）
+    int symbol_errors = 0;
+    for (int i = 0; i < device_count; i++) {
+        symbol_errors += device_handles[i].room_index == intern_room(devices[i].room_id) &&
+                         device_handles[i].type == intern_device_type(devices[i].device_id) ? 0 : 1;
+    }
+    deviceTableErrors += symbol_errors;
+    printf("  symbols: %s\n", symbol_errors == 0 ? "every handle carries its interned room and device type" : "WRONG SYMBOL");
+}
+
+#if ENABLE_SENSOR_SIMULATOR
+// 正交信号的四个相位（A, B）；顺时针时按此顺序前进，A相领先
+static const uint8_t QUADRATURE_PHASES[4][2] = {{HIGH, HIGH}, {LOW, HIGH}, {LOW, LOW}, {HIGH, LOW}};
+static int quadraturePhase = 0;
+
+/**
+ * @brief 旋钮转过一个正交边沿（只有一相电平变化）
+ * @param direction 1为顺时针，-1为逆时针
+ * @return 变化的引脚
+ */
+uint8_t ui_quadrature_edge(int direction) {
+    quadraturePhase = (quadraturePhase + (direction > 0 ? 1 : 3)) & 3;
+    uint8_t pin = mock_pin_input[EC11_A] != QUADRATURE_PHASES[quadraturePhase][0] ? EC11_A : EC11_B;
+    mock_set_input(pin, QUADRATURE_PHASES[quadraturePhase][pin == EC11_A ? 0 : 1]);
+    return pin;
+}
+
+/**
+ * @brief 旋钮转动一个逻辑步长（一个完整的正交周期），之后执行任务运行一轮
+ * @param direction 1为顺时针，-1为逆时针
+ */
+void ui_rotate(int direction) {
+    for (int edge = 0; edge < UI_ENCODER_COUNTS_PER_STEP; edge++) {
+        ui_quadrature_edge(direction);
+    }
+    executor_task_step();
+}
+
+/**
+ * @brief 按下并松开按键（编码器按键或OK键），按下和松开各保持100ms
+ */
+void ui_press(uint8_t pin) {
+    mock_set_input(pin, LOW);
+    executor_task_step();
+    mock_advance_ms(100);
+    mock_set_input(pin, HIGH);
+    executor_task_step();
+    mock_advance_ms(100);
+}
+
+/**
+ * @brief 经SPI写入屏幕的像素数：直接绘制时为各图元的像素，帧缓冲模式下为DMA刷新的像素
+ */
+uint32_t ui_pixels_pushed() {
+    return uiController.display().pixels_drawn() + mock_panel_pixels_written;
+}
+
+/**
+ * @brief SPI传输次数：直接绘制时每个图元一次阻塞传输，帧缓冲模式下为DMA队列中的事务（命令、参数、像素数据）
+ */
+uint32_t ui_spi_transfers() {
+    return uiController.display().writes() + mock_spi_transactions;
+}
+
+#if UI_FRAMEBUFFER
+static uint32_t frameChecks = 0;
+static uint32_t frameMismatches = 0;
+
+/**
+ * @brief 帧内容检查：屏幕显存与画布一致（只刷新脏行时没有遗漏），
+ *        且增量刷新得到的画布与整页重绘逐像素相同（控件区域的清除没有残留）。
+ *        设置页的轮次统计随时间变化，不参与比较
+ */
+void ui_check_frame(const char* name) {
+    const FrameCanvas& frame = uiController.frame();
+    std::vector<uint16_t> incremental((size_t)SCREEN_WIDTH * SCREEN_HEIGHT);
+    int panel_diff = 0;
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            incremental[y * SCREEN_WIDTH + x] = frame.pixel(x, y);
+            panel_diff += mock_panel_ram[y * MOCK_PANEL_WIDTH + x] != frame.pixel(x, y);
+        }
+    }
+
+    uiController.invalidate();
+    executor_task_step();
+    bool settings = uiController.getState() == STATE_SETTINGS;
+    int redraw_diff = 0;
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        if (settings && y >= UI_LOOP_STATS_Y && y < UI_LOOP_STATS_Y + 36) {
+            continue;
+        }
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            redraw_diff += incremental[y * SCREEN_WIDTH + x] != frame.pixel(x, y);
+        }
+    }
+
+    frameChecks++;
+    if (panel_diff != 0 || redraw_diff != 0) {
+        frameMismatches++;
+        printf("  frame check failed after \"%s\": %d pixel(s) differ from the panel, %d from a full redraw\n",
+               name, panel_diff, redraw_diff);
+    }
+}
+#endif
+
+/**
+ * @brief 一次操作期间经SPI写入屏幕的像素数（整屏为128×160=20480）、SPI传输次数和主机耗时
+ */
+template <typename Action>
+void ui_measure(const char* name, int repeat, Action action) {
+    uint32_t total = 0;
+    uint32_t transfers = 0;
+    double host_us = 0;
+    for (int i = 0; i < repeat; i++) {
+        uint32_t before = ui_pixels_pushed();
+        uint32_t transfers_before = ui_spi_transfers();
+        HostClock::time_point start = HostClock::now();
+        action();
+        host_us += std::chrono::duration<double, std::micro>(HostClock::now() - start).count();
+        total += ui_pixels_pushed() - before;
+        transfers += ui_spi_transfers() - transfers_before;
+        #if UI_FRAMEBUFFER
+        ui_check_frame(name);
+        #endif
+    }
+    printf("  %-24s %7u px %6u SPI transfers %8.1f us host (x%d)\n", name, (unsigned)(total / repeat),
+           (unsigned)(transfers / repeat), host_us / repeat, repeat);
+}
+
+/**
+ * @brief 按典型操作序列测量每次操作的绘制像素数（UI_INCREMENTAL_RENDER=0时为整页重绘的基准）
+ */
+void bench_ui() {
+    #if UI_FRAMEBUFFER
+    const char* mode = uiController.usingFrameBuffer() ? (UI_FLUSH_DIRTY_ROWS ? "frame buffer, dirty rows" : "frame buffer, full frame") : "direct";
+    #else
+    const char* mode = "direct";
+    #endif
+    printf("[UI] per interaction, incremental render %s, %s\n", UI_INCREMENTAL_RENDER ? "on" : "off", mode);
+    ui_measure("overview: select room", 4, [] { ui_rotate(1); });
+    ui_measure("enter room", 1, [] { ui_press(EC11_SW); });
+    ui_measure("browse: select item", 3, [] { ui_rotate(1); });
+    ui_measure("enter edit mode", 1, [] { ui_press(EC11_SW); });
+    ui_measure("edit: adjust value", 6, [] { ui_rotate(1); });
+    ui_measure("leave edit mode", 1, [] { ui_press(EC11_SW); });
+    ui_measure("back to overview", 1, [] { ui_press(BTN_OK); });
+    ui_measure("open settings", 1, [] { ui_press(BTN_OK); });
+    // MQTT断开再恢复：只运行执行任务，网络任务不会据此重连
+    ui_measure("settings: MQTT status", 2, [] {
+        mqttState = mqttState == MQTT_STATE_CONNECTED ? MQTT_STATE_DISCONNECTED : MQTT_STATE_CONNECTED;
+        uiController.setRedraw();
+        executor_task_step();
+    });
+    ui_measure("back to overview", 1, [] { ui_press(BTN_OK); });
+    #if UI_FRAMEBUFFER
+    printf("  frame check: %u frame(s), %u mismatch(es)\n", (unsigned)frameChecks, (unsigned)frameMismatches);
+    #endif
+}
+
+static uint32_t inputErrors = 0;
+
+/**
+ * @brief 以给定转速送入正交信号，执行任务按周期运行
+ * @param legacy_steps 累加按原方式（A相中断只记录最后一次方向，每轮处理一个咔嗒）能得到的步数
+ * @return 执行任务处理的步数
+ */
+int32_t ui_spin(int direction, int steps, uint32_t steps_per_second, int32_t& legacy_steps) {
+    int32_t start = uiController.getEncoderPosition();
+    uint32_t edge_us = 1000000 / (steps_per_second * UI_ENCODER_COUNTS_PER_STEP);
+    unsigned long last_poll = micros();
+    int legacy_clicks = 0;
+    bool a_changed = false;
+    for (int edge = 0; edge < steps * UI_ENCODER_COUNTS_PER_STEP; edge++) {
+        a_changed |= ui_quadrature_edge(direction) == EC11_A;
+        delayMicroseconds(edge_us);
+        if (micros() - last_poll >= EXECUTOR_TASK_PERIOD_MS * 1000UL) {
+            executor_task_step();
+            last_poll = micros();
+            legacy_clicks += a_changed ? direction : 0;
+            a_changed = false;
+            if (abs(legacy_clicks) >= 2) {
+                legacy_steps += legacy_clicks > 0 ? 1 : -1;
+                legacy_clicks = 0;
+            }
+        }
+    }
+    executor_task_step();
+    legacy_clicks += a_changed ? direction : 0;
+    if (abs(legacy_clicks) >= 2) {
+        legacy_steps += legacy_clicks > 0 ? 1 : -1;
+    }
+    return uiController.getEncoderPosition() - start;
+}
+
+static unsigned long longestInputRound = 0;   // 按键期间执行任务单轮的最长耗时（虚拟时钟，us）
+
+void ui_input_round() {
+    unsigned long start = micros();
+    executor_task_step();
+    unsigned long elapsed = micros() - start;
+    if (elapsed > longestInputRound) {
+        longestInputRound = elapsed;
+    }
+}
+
+/**
+ * @brief 按下或松开按键，电平变化后抖动若干次（每次间隔1ms）再稳定
+ */
+void ui_bounce(uint8_t pin, uint8_t level, int bounces) {
+    for (int i = 0; i < bounces; i++) {
+        mock_set_input(pin, level);
+        delayMicroseconds(500);
+        mock_set_input(pin, !level);
+        delayMicroseconds(500);
+        ui_input_round();
+    }
+    mock_set_input(pin, level);
+    ui_input_round();
+}
+
+/**
+ * @brief 旋钮高速转动不丢步、按键抖动只触发一次且不阻塞执行任务
+ */
+void bench_input() {
+    static const uint32_t rates[] = {20, 200, 1000, 5000};
+    const int forward = 400;
+    const int backward = 250;
+    printf("[Input] encoder: %d steps clockwise then %d back, executor every %d ms\n", forward, backward, EXECUTOR_TASK_PERIOD_MS);
+    for (uint32_t rate : rates) {
+        int32_t legacy = 0;
+        int32_t cw = ui_spin(1, forward, rate, legacy);
+        int32_t legacy_cw = legacy;
+        legacy = 0;
+        int32_t ccw = ui_spin(-1, backward, rate, legacy);
+        bool lost = cw != forward || ccw != -backward;
+        inputErrors += lost ? 1 : 0;
+        printf("  %5u steps/s   handled %+4d / %+4d   (one click per poll: %+4d / %+4d)%s\n",
+               (unsigned)rate, (int)cw, (int)ccw, (int)legacy_cw, (int)legacy, lost ? "  STEPS LOST" : "");
+        mock_advance_ms(UI_ENCODER_RESYNC_MS + 100);
+        executor_task_step();
+    }
+
+    // 返回键：按下和松开各抖动5次，应只打开一次设置页、再按一次回到概览页
+    UIState before = uiController.getState();
+    ui_bounce(BTN_OK, LOW, 5);
+    mock_advance_ms(100);
+    ui_bounce(BTN_OK, HIGH, 5);
+    mock_advance_ms(100);
+    bool opened = before == STATE_OVERVIEW && uiController.getState() == STATE_SETTINGS;
+    ui_bounce(BTN_OK, LOW, 5);
+    mock_advance_ms(100);
+    ui_bounce(BTN_OK, HIGH, 5);
+    mock_advance_ms(100);
+    bool closed = uiController.getState() == STATE_OVERVIEW;
+    inputErrors += opened && closed ? 0 : 1;
+    printf("  bounced presses: %s, longest executor round %.1f ms\n",
+           opened && closed ? "one action each" : "WRONG ACTION COUNT", longestInputRound / 1000.0);
+}
+#endif
+
+int main(int argc, char** argv) {
+    char default_path[64];
+    snprintf(default_path, sizeof(default_path), "native/bench/traces/node%d.trace", CURRENT_NODE);
+    const char* path = default_path;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            logOutput = &Serial;
+        } else if (strcmp(argv[i], "--devtable") == 0 && i + 1 < argc) {
+            std::ifstream file(argv[++i], std::ios::binary);
+            std::vector<char> blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (!file || !mock_partition_write((const uint8_t*)blob.data(), blob.size())) {
+                fprintf(stderr, "Cannot load device table: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            path = argv[i];
+        }
+    }
+    mock_serial_enabled = logOutput == &Serial;
+
+    std::vector<TraceEntry> entries;
+    if (!load_trace(path, entries)) {
+        fprintf(stderr, "Cannot read trace: %s\n", path);
+        return 1;
+    }
+
+    // 跳过WiFi/MQTT连接过程，直接进入已连接状态
+    HostClock::time_point setup_start = HostClock::now();
+    setup();
+    double setup_us = std::chrono::duration<double, std::micro>(HostClock::now() - setup_start).count();
+    client.mock_set_connected(true);
+    wifiState = WIFI_CONNECTED;
+    mqttState = MQTT_STATE_CONNECTED;
+    lastWifiState = wifiState;
+    lastMqttState = mqttState;
+    run_round();
+
+    bench_device_table(setup_us);
+    bench_trace_replay(entries);
+    bench_dedupe(entries);
+    bench_dispatch(entries);
+    bench_parsers(entries);
+    bench_codec();
+    bench_logging();
+    // 流式发布时长度计算与实际写入不一致的次数（见PubSubClient替身endPublish()）
+    printf("[Publish] %u message(s), %u length mismatch(es)\n", client.publish_count, client.publish_length_errors);
+    #if ENABLE_SENSOR_SIMULATOR
+    bench_ui();
+    bench_input();
+    if (inputErrors > 0) {
+        return 1;
+    }
+    #endif
+    #if ENABLE_SENSOR_SIMULATOR && UI_FRAMEBUFFER
+    if (frameMismatches > 0) {
+        return 1;
+    }
+    #endif
+    return pendingCount == 0 && deviceTableErrors == 0 && dispatchErrors == 0 && codecErrors == 0 &&
+           dedupeErrors == 0 && client.publish_length_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// Adafruit_GFX.h（主机构建替身）
+// 与真实库相同的结构：图元为虚函数，默认逐列/逐点落到drawPixel()，由屏幕（Adafruit_ST7735）或画布（GFXcanvas16）实现。
+// 文字不使用真实字库，而是按字符编码生成固定的5x7点阵，不同字符绘制出不同的像素，
+// 足以在主机上比较两种绘制方式的帧内容是否一致
+#ifndef MOCK_ADAFRUIT_GFX_H
+#define MOCK_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 替身字形：字符c第col列（0~4）的7位点阵
+ */
+inline uint8_t mock_glyph_column(uint32_t c, uint8_t col) {
+    uint32_t hash = (c + 1) * 2654435761u;
+    hash ^= hash >> 13;
+    return (uint8_t)((hash >> (col * 5)) & 0x7F) | (col == 0 ? 0x01 : 0);
+}
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h)
+        : width_(w), height_(h), cursor_x_(0), cursor_y_(0), text_size_(1),
+          text_color_(0xFFFF), text_bg_color_(0xFFFF) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < h; i++) {
+            drawPixel(x, y + i, color);
+        }
+    }
+
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+        for (int16_t i = 0; i < w; i++) {
+            drawPixel(x + i, y, color);
+        }
+    }
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < w; i++) {
+            drawFastVLine(x + i, y, h, color);
+        }
+    }
+
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, width_, height_, color); }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+        if (y0 == y1) {
+            drawFastHLine(x0 < x1 ? x0 : x1, y0, abs(x1 - x0) + 1, color);
+        } else if (x0 == x1) {
+            drawFastVLine(x0, y0 < y1 ? y0 : y1, abs(y1 - y0) + 1, color);
+        } else {
+            int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+            int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+            int16_t err = dx + dy;
+            while (true) {
+                drawPixel(x0, y0, color);
+                if (x0 == x1 && y0 == y1) break;
+                int16_t e2 = 2 * err;
+                if (e2 >= dy) { err += dy; x0 += sx; }
+                if (e2 <= dx) { err += dx; y0 += sy; }
+            }
+        }
+    }
+
+    // 与真实库相同：只设前景色时文字背景透明
+    void setTextColor(uint16_t color) { text_color_ = text_bg_color_ = color; }
+    void setTextColor(uint16_t color, uint16_t background) { text_color_ = color; text_bg_color_ = background; }
+    void setTextSize(uint8_t size) { text_size_ = size; }
+    void setCursor(int16_t x, int16_t y) { cursor_x_ = x; cursor_y_ = y; }
+    void setRotation(uint8_t) {}
+    int16_t width() const { return width_; }
+    int16_t height() const { return height_; }
+    int16_t getCursorX() const { return cursor_x_; }
+    int16_t getCursorY() const { return cursor_y_; }
+
+    // 5x7字形加1像素间距，共6x8；透明背景时只绘制点阵中的像素
+    size_t write(uint8_t c) override {
+        if (c == '\n') {
+            cursor_x_ = 0;
+            cursor_y_ += 8 * text_size_;
+        } else if (c != '\r') {
+            drawChar(cursor_x_, cursor_y_, c);
+            cursor_x_ += 6 * text_size_;
+        }
+        return 1;
+    }
+    using Print::write;
+
+protected:
+    int16_t width_;
+    int16_t height_;
+    int16_t cursor_x_;
+    int16_t cursor_y_;
+    uint8_t text_size_;
+    uint16_t text_color_;
+    uint16_t text_bg_color_;
+
+    void drawChar(int16_t x, int16_t y, uint8_t c) {
+        for (uint8_t col = 0; col < 6; col++) {
+            uint8_t bits = col < 5 ? mock_glyph_column(c, col) : 0;
+            for (uint8_t row = 0; row < 8; row++, bits >>= 1) {
+                bool set = bits & 1;
+                if (!set && text_bg_color_ == text_color_) {
+                    continue;
+                }
+                uint16_t color = set ? text_color_ : text_bg_color_;
+                if (text_size_ == 1) {
+                    drawPixel(x + col, y + row, color);
+                } else {
+                    fillRect(x + col * text_size_, y + row * text_size_, text_size_, text_size_, color);
+                }
+            }
+        }
+    }
+};
+
+// 内存中的16位画布：像素按写入的值原样保存
+class GFXcanvas16 : public Adafruit_GFX {
+public:
+    GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+        buffer_ = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+    }
+    ~GFXcanvas16() { free(buffer_); }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (buffer_ != nullptr && x >= 0 && y >= 0 && x < width_ && y < height_) {
+            buffer_[y * width_ + x] = color;
+        }
+    }
+
+    // 与真实库相同：直线直接写入缓冲区，不经过drawPixel()
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+        for (int16_t i = 0; i < h; i++) {
+            GFXcanvas16::drawPixel(x, y + i, color);
+        }
+    }
+
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+        for (int16_t i = 0; i < w; i++) {
+            GFXcanvas16::drawPixel(x + i, y, color);
+        }
+    }
+
+    void fillScreen(uint16_t color) override {
+        if (buffer_ != nullptr) {
+            for (int32_t i = 0; i < (int32_t)width_ * height_; i++) {
+                buffer_[i] = color;
+            }
+        }
+    }
+
+    uint16_t getPixel(int16_t x, int16_t y) const {
+        return (buffer_ != nullptr && x >= 0 && y >= 0 && x < width_ && y < height_) ? buffer_[y * width_ + x] : 0;
+    }
+
+    uint16_t* getBuffer() const { return buffer_; }
+
+private:
+    uint16_t* buffer_;
+};
+
+#endif // MOCK_ADAFRUIT_GFX_H
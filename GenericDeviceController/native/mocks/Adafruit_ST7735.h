@@ -0,0 +1,44 @@
+// Adafruit_ST7735.h（主机构建替身）
+// 不保存像素，只统计经SPI写入屏幕的像素数和写入次数：矩形填充按面积计、为一次地址窗口写入，单点按1计、也是一次写入，
+// 用于在主机上比较UI刷新的绘制量
+#ifndef MOCK_ADAFRUIT_ST7735_H
+#define MOCK_ADAFRUIT_ST7735_H
+
+#include <Adafruit_GFX.h>
+
+#define INITR_BLACKTAB  0x02
+
+class Adafruit_ST7735 : public Adafruit_GFX {
+public:
+    Adafruit_ST7735(int8_t, int8_t, int8_t) : Adafruit_GFX(128, 160), pixels_drawn_(0), writes_(0) {}
+    void initR(uint8_t) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t) override {
+        if (x >= 0 && y >= 0 && x < width_ && y < height_) {
+            pixels_drawn_++;
+            writes_++;
+        }
+    }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override { fillRect(x, y, 1, h, color); }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override { fillRect(x, y, w, 1, color); }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t) override {
+        int32_t x1 = x + w < width_ ? x + w : width_;
+        int32_t y1 = y + h < height_ ? y + h : height_;
+        int32_t x0 = x > 0 ? x : 0;
+        int32_t y0 = y > 0 ? y : 0;
+        if (x1 > x0 && y1 > y0) {
+            pixels_drawn_ += (uint32_t)((x1 - x0) * (y1 - y0));
+            writes_++;
+        }
+    }
+
+    uint32_t pixels_drawn() const { return pixels_drawn_; }
+    uint32_t writes() const { return writes_; }     // 每次写入为一次阻塞的SPI传输（设置地址窗口+像素）
+
+private:
+    uint32_t pixels_drawn_;
+    uint32_t writes_;
+};
+
+#endif // MOCK_ADAFRUIT_ST7735_H
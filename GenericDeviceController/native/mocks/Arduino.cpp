@@ -0,0 +1,398 @@
+// Arduino.cpp（主机构建替身的实现）
+#include <Arduino.h>
+#include <SPI.h>
+#include <WiFi.h>
+#include <driver/pcnt.h>
+#include <driver/spi_master.h>
+#include <esp_partition.h>
+#include <deque>
+#include <stdarg.h>
+
+// =================== 时间（虚拟时钟） ===================
+static uint64_t clock_us = 0;
+
+unsigned long millis() {
+    return (unsigned long)(clock_us / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)clock_us;
+}
+
+void delay(unsigned long ms) {
+    clock_us += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    clock_us += us;
+}
+
+void mock_advance_ms(unsigned long ms) {
+    clock_us += (uint64_t)ms * 1000;
+}
+
+// =================== GPIO / LEDC ===================
+uint8_t mock_pin_level[MOCK_PIN_COUNT];
+uint8_t mock_pin_input[MOCK_PIN_COUNT] = {
+    HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH,
+    HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH
+};
+uint32_t mock_ledc_duty[MOCK_LEDC_CHANNELS];
+uint32_t mock_gpio_writes = 0;
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < MOCK_PIN_COUNT) {
+        mock_pin_level[pin] = value;
+    }
+    mock_gpio_writes++;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < MOCK_PIN_COUNT ? mock_pin_input[pin] : LOW;
+}
+
+double ledcSetup(uint8_t, double freq, uint8_t) {
+    return freq;
+}
+
+void ledcAttachPin(uint8_t, uint8_t) {}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel < MOCK_LEDC_CHANNELS) {
+        mock_ledc_duty[channel] = duty;
+    }
+    mock_gpio_writes++;
+}
+
+struct MockInterrupt {
+    void (*handler)();
+    int mode;
+};
+static MockInterrupt mock_interrupts[MOCK_PIN_COUNT];
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    if (pin < MOCK_PIN_COUNT) {
+        mock_interrupts[pin].handler = handler;
+        mock_interrupts[pin].mode = mode;
+    }
+}
+
+static void mock_pcnt_edge(uint8_t pin, uint8_t level);
+
+void mock_set_input(uint8_t pin, uint8_t level) {
+    if (pin >= MOCK_PIN_COUNT || mock_pin_input[pin] == level) {
+        return;
+    }
+    mock_pin_input[pin] = level;
+    mock_pcnt_edge(pin, level);
+    const MockInterrupt& interrupt = mock_interrupts[pin];
+    if (interrupt.handler != nullptr &&
+        (interrupt.mode == CHANGE || (interrupt.mode == FALLING) == (level == LOW))) {
+        interrupt.handler();
+    }
+}
+
+// =================== 脉冲计数器（PCNT） ===================
+struct MockPcntUnit {
+    pcnt_config_t channels[PCNT_CHANNEL_MAX];
+    bool configured[PCNT_CHANNEL_MAX];
+    int16_t count;
+    int16_t high_limit;
+    int16_t low_limit;
+    uint16_t filter;
+    bool filter_enabled;
+    bool paused;
+};
+static MockPcntUnit mock_pcnt_units[PCNT_UNIT_MAX];
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* config) {
+    if (config->unit >= PCNT_UNIT_MAX || config->channel >= PCNT_CHANNEL_MAX ||
+        config->counter_h_lim <= 0 || config->counter_l_lim >= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    MockPcntUnit& unit = mock_pcnt_units[config->unit];
+    unit.channels[config->channel] = *config;
+    unit.configured[config->channel] = true;
+    unit.high_limit = config->counter_h_lim;
+    unit.low_limit = config->counter_l_lim;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val) {
+    if (unit >= PCNT_UNIT_MAX || filter_val > 1023) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mock_pcnt_units[unit].filter = filter_val;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit) {
+    mock_pcnt_units[unit].filter_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit) {
+    mock_pcnt_units[unit].paused = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit) {
+    mock_pcnt_units[unit].paused = false;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+    mock_pcnt_units[unit].count = 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count) {
+    *count = mock_pcnt_units[unit].count;
+    return ESP_OK;
+}
+
+static void mock_pcnt_edge(uint8_t pin, uint8_t level) {
+    for (MockPcntUnit& unit : mock_pcnt_units) {
+        for (int c = 0; c < PCNT_CHANNEL_MAX; c++) {
+            const pcnt_config_t& channel = unit.channels[c];
+            if (unit.paused || !unit.configured[c] || channel.pulse_gpio_num != pin) {
+                continue;
+            }
+            pcnt_count_mode_t mode = level == HIGH ? channel.pos_mode : channel.neg_mode;
+            bool control_high = channel.ctrl_gpio_num >= 0 && mock_pin_input[channel.ctrl_gpio_num] == HIGH;
+            pcnt_ctrl_mode_t control = control_high ? channel.hctrl_mode : channel.lctrl_mode;
+            if (mode == PCNT_COUNT_DIS || control == PCNT_MODE_DISABLE) {
+                continue;
+            }
+            int delta = mode == PCNT_COUNT_INC ? 1 : -1;
+            unit.count += control == PCNT_MODE_REVERSE ? -delta : delta;
+            if (unit.count >= unit.high_limit || unit.count <= unit.low_limit) {
+                unit.count = 0;
+            }
+        }
+    }
+}
+
+// =================== 数学 ===================
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return min + random(max - min);
+}
+
+// =================== 串口 ===================
+HardwareSerial Serial;
+bool mock_serial_enabled = true;
+EspClass ESP;
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (mock_serial_enabled) {
+        fputc(c, stderr);
+    }
+    return 1;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return print(buffer);
+}
+
+// =================== FreeRTOS ===================
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t, void*, unsigned,
+                                   TaskHandle_t* handle, int) {
+    MockTask* task = new MockTask{function, name, 0};
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (task != nullptr) {
+        ((MockTask*)task)->notifications++;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) {
+    return 0;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    mock_advance_ms(ticks);
+}
+
+void vTaskDelete(TaskHandle_t) {}
+
+// =================== SPI主机驱动（ST7735模拟显存） ===================
+struct MockSpiDevice {
+    transaction_cb_t pre_cb;
+    std::deque<spi_transaction_t*> done;
+    uint8_t command;
+    uint8_t args[4];
+    uint8_t arg_count;
+    uint16_t window[4];     // x0, x1, y0, y1
+    uint16_t x;
+    uint16_t y;
+};
+
+uint16_t mock_panel_ram[MOCK_PANEL_WIDTH * MOCK_PANEL_HEIGHT];
+uint32_t mock_panel_pixels_written = 0;
+uint32_t mock_spi_transactions = 0;
+
+static const uint8_t ST7735_CASET = 0x2A;
+static const uint8_t ST7735_RASET = 0x2B;
+static const uint8_t ST7735_RAMWR = 0x2C;
+
+esp_err_t spi_bus_initialize(spi_host_device_t, const spi_bus_config_t*, spi_dma_chan_t) {
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t) {
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t, const spi_device_interface_config_t* config, spi_device_handle_t* handle) {
+    MockSpiDevice* device = new MockSpiDevice();
+    device->pre_cb = config->pre_cb;
+    *handle = device;
+    return ESP_OK;
+}
+
+/**
+ * @brief 按ST7735命令集处理一个数据字节
+ */
+static void mock_panel_data(MockSpiDevice* device, uint8_t value) {
+    if (device->command == ST7735_CASET || device->command == ST7735_RASET) {
+        if (device->arg_count < 4) {
+            device->args[device->arg_count++] = value;
+        }
+        if (device->arg_count == 4) {
+            int base = device->command == ST7735_CASET ? 0 : 2;
+            device->window[base] = (uint16_t)(device->args[0] << 8 | device->args[1]);
+            device->window[base + 1] = (uint16_t)(device->args[2] << 8 | device->args[3]);
+        }
+    } else if (device->command == ST7735_RAMWR) {
+        // 每两个字节一个像素，高字节在前
+        if (device->arg_count == 0) {
+            device->args[0] = value;
+            device->arg_count = 1;
+            return;
+        }
+        device->arg_count = 0;
+        if (device->x < MOCK_PANEL_WIDTH && device->y < MOCK_PANEL_HEIGHT) {
+            mock_panel_ram[device->y * MOCK_PANEL_WIDTH + device->x] = (uint16_t)(device->args[0] << 8 | value);
+        }
+        mock_panel_pixels_written++;
+        if (++device->x > device->window[1]) {
+            device->x = device->window[0];
+            if (++device->y > device->window[3]) {
+                device->y = device->window[2];
+            }
+        }
+    }
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t device, spi_transaction_t* trans) {
+    if (device == nullptr || trans == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (device->pre_cb != nullptr) {
+        device->pre_cb(trans);
+    }
+    const uint8_t* data = (trans->flags & SPI_TRANS_USE_TXDATA) ? trans->tx_data : (const uint8_t*)trans->tx_buffer;
+    size_t length = trans->length / 8;
+    if ((intptr_t)trans->user == 0) {
+        // 命令字节：开始新命令，RAMWR从地址窗口左上角写起
+        device->command = length > 0 ? data[0] : 0;
+        device->arg_count = 0;
+        device->x = device->window[0];
+        device->y = device->window[2];
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            mock_panel_data(device, data[i]);
+        }
+    }
+    mock_spi_transactions++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t device, spi_transaction_t* trans, TickType_t) {
+    esp_err_t result = spi_device_polling_transmit(device, trans);
+    if (result == ESP_OK) {
+        device->done.push_back(trans);
+    }
+    return result;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t device, spi_transaction_t** trans, TickType_t) {
+    if (device == nullptr || device->done.empty()) {
+        return ESP_FAIL;
+    }
+    *trans = device->done.front();
+    device->done.pop_front();
+    return ESP_OK;
+}
+
+// =================== 分区（devtable） ===================
+alignas(4) static uint8_t mock_partition_data[MOCK_PARTITION_SIZE];
+static bool mock_partition_ready = false;
+static const esp_partition_t mock_devtable_partition = {
+    ESP_PARTITION_TYPE_DATA, 0x40, 0x3EF000, MOCK_PARTITION_SIZE, "devtable", false
+};
+uint32_t mock_partition_mapped = 0;
+
+void mock_partition_erase() {
+    memset(mock_partition_data, 0xFF, sizeof(mock_partition_data));
+    mock_partition_ready = true;
+}
+
+bool mock_partition_write(const uint8_t* data, size_t size) {
+    if (size > sizeof(mock_partition_data)) {
+        return false;
+    }
+    mock_partition_erase();
+    memcpy(mock_partition_data, data, size);
+    return true;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+    if (type != mock_devtable_partition.type || subtype != mock_devtable_partition.subtype ||
+        (label != nullptr && strcmp(label, mock_devtable_partition.label) != 0)) {
+        return nullptr;
+    }
+    if (!mock_partition_ready) {
+        mock_partition_erase();
+    }
+    return &mock_devtable_partition;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size, spi_flash_mmap_memory_t,
+                             const void** out_ptr, spi_flash_mmap_handle_t* out_handle) {
+    if (partition != &mock_devtable_partition || offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_ptr = mock_partition_data + offset;
+    *out_handle = ++mock_partition_mapped;
+    return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t) {
+    mock_partition_mapped--;
+}
+
+// =================== 外设与库的全局实例 ===================
+WiFiClass WiFi;
+wl_status_t mock_wifi_status = WL_CONNECTED;
+SPIClass SPI;
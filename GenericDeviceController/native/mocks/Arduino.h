@@ -0,0 +1,163 @@
+// Arduino.h（主机构建替身）
+// 在PC上编译固件逻辑所需的最小Arduino/ESP32接口：GPIO与LEDC写入只记录到数组，
+// 时间由虚拟时钟提供（只在delay()/vTaskDelay()/mock_advance_ms()时前进），结果与运行速度无关、可重复
+// FreeRTOS任务只登记不运行，由基准测试在单线程中按轮调用各任务的step函数
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define RISING          0x01
+#define FALLING         0x02
+#define CHANGE          0x03
+#define DEC             10
+#define IRAM_ATTR
+
+#define MOCK_PIN_COUNT          40
+#define MOCK_LEDC_CHANNELS      16
+
+// =================== 时间（虚拟时钟） ===================
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void mock_advance_ms(unsigned long ms);     // 推进虚拟时钟
+
+// =================== GPIO / LEDC ===================
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+#define digitalPinToInterrupt(pin) (pin)
+
+extern uint8_t mock_pin_level[MOCK_PIN_COUNT];          // digitalWrite()写入的电平
+extern uint8_t mock_pin_input[MOCK_PIN_COUNT];          // digitalRead()返回的电平（默认HIGH，按键未按下）
+void mock_set_input(uint8_t pin, uint8_t level);        // 改变输入电平：更新脉冲计数器，并调用attachInterrupt()注册的中断函数
+extern uint32_t mock_ledc_duty[MOCK_LEDC_CHANNELS];     // ledcWrite()写入的占空比
+extern uint32_t mock_gpio_writes;                       // digitalWrite()与ledcWrite()的总次数
+
+// =================== 数学 ===================
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long max);
+long random(long min, long max);
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// =================== String / Print ===================
+class String : public std::string {
+public:
+    String(const char* s = "") : std::string(s) {}
+    String(const std::string& s) : std::string(s) {}
+};
+
+class Printable;
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int = DEC) { return format("%d", v); }
+    size_t print(unsigned v, int = DEC) { return format("%u", v); }
+    size_t print(long v, int = DEC) { return format("%ld", v); }
+    size_t print(unsigned long v, int = DEC) { return format("%lu", v); }
+    size_t print(double v, int digits = 2) { return format("%.*f", digits, v); }
+    size_t print(const Printable& p);
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+    template <typename T> size_t println(const T& v, int d) { return print(v, d) + println(); }
+    size_t println() { return print("\r\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    template <typename... Args>
+    size_t format(const char* fmt, Args... args) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), fmt, args...);
+        return print(buffer);
+    }
+};
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+inline size_t Print::print(const Printable& p) {
+    return p.printTo(*this);
+}
+
+// 串口输出到标准错误；mock_serial_enabled为false时丢弃（基准测试默认关闭，避免终端输出影响计时）
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+extern bool mock_serial_enabled;
+
+// =================== ESP ===================
+// 主机上没有对应的堆统计，返回固定值
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 180000; }
+};
+
+extern EspClass ESP;
+
+// =================== FreeRTOS ===================
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define portMAX_DELAY       0xFFFFFFFFu
+#define tskNO_AFFINITY      -1
+
+// 任务只登记不运行；通知计数保留，供基准测试判断任务是否被唤醒
+struct MockTask {
+    TaskFunction_t function;
+    const char* name;
+    uint32_t notifications;
+};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_size, void* arg,
+                                   unsigned priority, TaskHandle_t* handle, int core);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+
+#endif // MOCK_ARDUINO_H
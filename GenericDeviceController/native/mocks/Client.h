@@ -0,0 +1,45 @@
+// Client.h / IPAddress（主机构建替身）
+#ifndef MOCK_CLIENT_H
+#define MOCK_CLIENT_H
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : address_(0) {}
+
+    bool fromString(const char* s) {
+        return inet_pton(AF_INET, s, &address_) == 1;
+    }
+
+    operator uint32_t() const { return address_; }
+
+    String toString() const {
+        char buffer[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &address_, buffer, sizeof(buffer));
+        return String(buffer);
+    }
+
+    size_t printTo(Print& p) const override {
+        return p.print(toString());
+    }
+
+private:
+    uint32_t address_;      // 网络字节序，与ESP32的IPAddress一致
+};
+
+class Client : public Print {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+};
+
+#endif // MOCK_CLIENT_H
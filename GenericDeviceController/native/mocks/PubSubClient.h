@@ -0,0 +1,171 @@
+// PubSubClient.h（主机构建替身）
+// 接口与PubSubClient 2.8一致。收包由inject()放入队列，与真实库相同，每次loop()只处理一条；
+// 发布的消息交给publish_hook（基准测试据此匹配回执）。流式发布时endPublish()核对实际写入字节数与
+// beginPublish()声明的长度：真实库只按声明长度写报文头，二者不一致会让代理收到错位的报文，
+// 替身因此拒绝发布并计入publish_length_errors。connect()沿用2.8的逻辑：
+// 传输层已连接时直接发送CONNECT并读取CONNACK，因此经MqttTransport完成的非阻塞握手也能在主机上运行
+#ifndef MOCK_PUBSUBCLIENT_H
+#define MOCK_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <deque>
+#include <functional>
+#include <string>
+
+#define MQTT_KEEPALIVE          15
+#define MQTT_MAX_PACKET_SIZE    256
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient : public Print {
+public:
+    typedef void (*PublishHook)(const char* topic, const uint8_t* payload, unsigned int length);
+
+    explicit PubSubClient(Client& client)
+        : client_(&client), connected_(false), pending_length_(0), publish_hook(nullptr), publish_count(0),
+          publish_length_errors(0), subscribe_count(0) {}
+
+    PubSubClient& setServer(const char*, uint16_t) { return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { callback_ = callback; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+    PubSubClient& setKeepAlive(uint16_t) { return *this; }
+    bool setBufferSize(uint16_t) { return true; }
+
+    boolean connect(const char* id, const char*, const char*, const char*, uint8_t, boolean, const char*,
+                    boolean clean_session) {
+        if (connected()) {
+            return true;
+        }
+        if (!client_->connected() && client_->connect("", 0) != 1) {
+            return false;
+        }
+        uint8_t packet[64];
+        size_t id_len = strlen(id);
+        size_t n = 0;
+        const uint8_t header[] = {0x10, (uint8_t)(12 + id_len), 0, 4, 'M', 'Q', 'T', 'T', 4,
+                                  (uint8_t)(clean_session ? 0x02 : 0x00), 0, MQTT_KEEPALIVE, 0, (uint8_t)id_len};
+        memcpy(packet, header, sizeof(header));
+        n += sizeof(header);
+        memcpy(packet + n, id, id_len);
+        n += id_len;
+        client_->write(packet, n);
+
+        uint8_t connack[4];
+        for (int i = 0; i < 4; i++) {
+            int c = client_->read();
+            if (c < 0) {
+                client_->stop();
+                return false;
+            }
+            connack[i] = (uint8_t)c;
+        }
+        if (connack[0] != 0x20 || connack[3] != 0) {
+            client_->stop();
+            return false;
+        }
+        connected_ = true;
+        return true;
+    }
+
+    // 不经传输层直接进入已连接状态，供基准测试使用
+    void mock_set_connected(bool connected) { connected_ = connected; }
+
+    void disconnect() {
+        connected_ = false;
+        client_->stop();
+    }
+
+    boolean connected() { return connected_; }
+    int state() { return connected_ ? 0 : -1; }
+
+    // 放入一条待接收的消息，下一次loop()时交给回调
+    void inject(const char* topic, const uint8_t* payload, unsigned int length) {
+        inbox_.push_back(Message{topic, std::string((const char*)payload, length)});
+    }
+
+    size_t pending() const { return inbox_.size(); }
+
+    boolean loop() {
+        if (!inbox_.empty() && callback_) {
+            Message message = inbox_.front();
+            inbox_.pop_front();
+            callback_(&message.topic[0], (uint8_t*)&message.payload[0], (unsigned int)message.payload.size());
+        }
+        return connected_;
+    }
+
+    boolean subscribe(const char* topic) { return subscribe(topic, 0); }
+    boolean subscribe(const char*, uint8_t) {
+        subscribe_count++;
+        return connected_;
+    }
+    boolean unsubscribe(const char*) { return connected_; }
+
+    boolean publish(const char* topic, const char* payload) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload), false);
+    }
+    boolean publish(const char* topic, const char* payload, boolean retained) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int length) {
+        return publish(topic, payload, length, false);
+    }
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int length, boolean) {
+        publish_count++;
+        if (publish_hook != nullptr) {
+            publish_hook(topic, payload, length);
+        }
+        return connected_;
+    }
+
+    boolean beginPublish(const char* topic, unsigned int length, boolean) {
+        pending_topic_ = topic;
+        pending_length_ = length;
+        pending_payload_.clear();
+        pending_payload_.reserve(length);
+        return connected_;
+    }
+
+    size_t write(uint8_t c) override {
+        pending_payload_.push_back((char)c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        pending_payload_.append((const char*)buffer, size);
+        return size;
+    }
+
+    int endPublish() {
+        if (pending_payload_.size() != pending_length_) {
+            publish_length_errors++;
+            ::printf("[MQTT] length mismatch on %s: declared %u, wrote %u\n", pending_topic_.c_str(),
+                   pending_length_, (unsigned int)pending_payload_.size());
+            return 0;
+        }
+        return publish(pending_topic_.c_str(), (const uint8_t*)pending_payload_.data(),
+                       (unsigned int)pending_payload_.size(), false) ? 1 : 0;
+    }
+
+private:
+    struct Message {
+        std::string topic;
+        std::string payload;
+    };
+
+    Client* client_;
+    bool connected_;
+    std::function<void(char*, uint8_t*, unsigned int)> callback_;
+    std::deque<Message> inbox_;
+    std::string pending_topic_;
+    std::string pending_payload_;
+    unsigned int pending_length_;
+
+public:
+    PublishHook publish_hook;       // 每条发布的消息（含流式发布）
+    uint32_t publish_count;
+    uint32_t publish_length_errors; // endPublish()时写入字节数与声明长度不符的次数
+    uint32_t subscribe_count;
+};
+
+#endif // MOCK_PUBSUBCLIENT_H
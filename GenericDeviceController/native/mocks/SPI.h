@@ -0,0 +1,15 @@
+// SPI.h（主机构建替身）
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+#include <Arduino.h>
+
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif // MOCK_SPI_H
@@ -0,0 +1,125 @@
+// WiFi.h（主机构建替身）
+// WiFi.status()由mock_wifi_status控制；WiFiClient直接使用主机套接字，可连接本机的MQTT Broker
+#ifndef MOCK_WIFI_H
+#define MOCK_WIFI_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <errno.h>
+#include <memory>
+#include <netdb.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define WL_IDLE_STATUS      0
+#define WL_CONNECTED        3
+#define WL_DISCONNECTED     6
+#define WIFI_STA            1
+
+typedef int wl_status_t;
+typedef int WiFiEvent_t;
+typedef int WiFiEventInfo_t;
+
+extern wl_status_t mock_wifi_status;    // 默认WL_CONNECTED
+
+class WiFiClass {
+public:
+    void mode(int) {}
+    void begin(const char*, const char*) {}
+    void disconnect() {}
+    wl_status_t status() { return mock_wifi_status; }
+    bool isConnected() { return mock_wifi_status == WL_CONNECTED; }
+    IPAddress localIP() {
+        IPAddress ip;
+        ip.fromString("127.0.0.1");
+        return ip;
+    }
+    String SSID() { return String("native"); }
+    template <typename Handler> void onEvent(Handler) {}
+
+    int hostByName(const char* host, IPAddress& ip) {
+        struct addrinfo hints;
+        struct addrinfo* result = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+            return 0;
+        }
+        char buffer[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &((struct sockaddr_in*)result->ai_addr)->sin_addr, buffer, sizeof(buffer));
+        freeaddrinfo(result);
+        return ip.fromString(buffer) ? 1 : 0;
+    }
+};
+
+extern WiFiClass WiFi;
+
+// 与ESP32的WiFiClient相同：套接字由共享句柄管理，复制后共用同一连接，最后一个副本释放时关闭
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : socket_(std::make_shared<Socket>(fd)) {}
+
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override { return 0; }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!socket_) {
+            return 0;
+        }
+        ssize_t n = ::send(socket_->fd, buffer, size, MSG_NOSIGNAL);
+        return n < 0 ? 0 : (size_t)n;
+    }
+
+    int available() override {
+        int n = 0;
+        if (!socket_ || ioctl(socket_->fd, FIONREAD, &n) < 0) {
+            return 0;
+        }
+        return n;
+    }
+
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int read(uint8_t* buffer, size_t size) override {
+        if (!socket_) {
+            return -1;
+        }
+        ssize_t n = ::recv(socket_->fd, buffer, size, MSG_DONTWAIT);
+        return n <= 0 ? -1 : (int)n;
+    }
+
+    void stop() override {
+        socket_.reset();
+    }
+
+    uint8_t connected() override {
+        if (!socket_) {
+            return 0;
+        }
+        char c;
+        ssize_t n = ::recv(socket_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0) {
+            return 0;
+        }
+        return n > 0 || errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+private:
+    struct Socket {
+        int fd;
+        explicit Socket(int f) : fd(f) {}
+        ~Socket() { ::close(fd); }
+    };
+    std::shared_ptr<Socket> socket_;
+};
+
+#endif // MOCK_WIFI_H
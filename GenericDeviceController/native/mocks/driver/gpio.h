@@ -0,0 +1,16 @@
+// driver/gpio.h（主机构建替身）：电平写入mock_pin_level，与digitalWrite()相同
+#ifndef MOCK_DRIVER_GPIO_H
+#define MOCK_DRIVER_GPIO_H
+
+#include <Arduino.h>
+
+typedef int gpio_num_t;
+
+inline int gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num >= 0 && gpio_num < MOCK_PIN_COUNT) {
+        mock_pin_level[gpio_num] = (uint8_t)level;
+    }
+    return 0;
+}
+
+#endif // MOCK_DRIVER_GPIO_H
@@ -0,0 +1,38 @@
+// driver/pcnt.h（主机构建替身）
+// ESP-IDF脉冲计数器（旧版驱动）的最小接口。计数在mock_set_input()改变引脚电平时按各通道的边沿与控制电平模式更新，
+// 与硬件相同：计数达到上限或下限时归零。毛刺滤波只记录设置值，输入由测试直接给出干净的边沿
+#ifndef MOCK_DRIVER_PCNT_H
+#define MOCK_DRIVER_PCNT_H
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef enum { PCNT_UNIT_0 = 0, PCNT_UNIT_1, PCNT_UNIT_2, PCNT_UNIT_3, PCNT_UNIT_MAX = 8 } pcnt_unit_t;
+typedef enum { PCNT_CHANNEL_0 = 0, PCNT_CHANNEL_1, PCNT_CHANNEL_MAX } pcnt_channel_t;
+typedef enum { PCNT_COUNT_DIS = 0, PCNT_COUNT_INC, PCNT_COUNT_DEC } pcnt_count_mode_t;
+typedef enum { PCNT_MODE_KEEP = 0, PCNT_MODE_REVERSE, PCNT_MODE_DISABLE } pcnt_ctrl_mode_t;
+
+#define PCNT_PIN_NOT_USED   (-1)
+
+typedef struct {
+    int pulse_gpio_num;
+    int ctrl_gpio_num;
+    pcnt_ctrl_mode_t lctrl_mode;    // 控制引脚为低电平时
+    pcnt_ctrl_mode_t hctrl_mode;    // 控制引脚为高电平时
+    pcnt_count_mode_t pos_mode;     // 脉冲引脚上升沿
+    pcnt_count_mode_t neg_mode;     // 脉冲引脚下降沿
+    int16_t counter_h_lim;
+    int16_t counter_l_lim;
+    pcnt_unit_t unit;
+    pcnt_channel_t channel;
+} pcnt_config_t;
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* config);
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val);
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit);
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit);
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit);
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit);
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count);
+
+#endif // MOCK_DRIVER_PCNT_H
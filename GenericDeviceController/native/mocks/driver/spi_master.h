@@ -0,0 +1,85 @@
+// driver/spi_master.h（主机构建替身）
+// ESP-IDF SPI主机驱动的最小接口。传输在送入队列时立即完成（先调用pre_cb），
+// 数据按ST7735的命令集写入一块模拟显存（CASET/RASET设置地址窗口，RAMWR之后的数据为高字节在前的像素），
+// 用于在主机上检查DMA刷新到屏幕的内容。与常见的ST7735驱动写法一致，事务的user字段为DC电平（0=命令，1=数据）
+#ifndef MOCK_DRIVER_SPI_MASTER_H
+#define MOCK_DRIVER_SPI_MASTER_H
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef enum { SPI1_HOST = 0, SPI2_HOST = 1, SPI3_HOST = 2 } spi_host_device_t;
+#define HSPI_HOST SPI2_HOST
+#define VSPI_HOST SPI3_HOST
+
+typedef enum { SPI_DMA_DISABLED = 0, SPI_DMA_CH1 = 1, SPI_DMA_CH2 = 2, SPI_DMA_CH_AUTO = 3 } spi_dma_chan_t;
+
+#define SPI_TRANS_USE_TXDATA (1 << 3)
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;      // 位数
+    size_t rxlength;
+    void* user;
+    union {
+        const void* tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void* rx_buffer;
+        uint8_t rx_data[4];
+    };
+};
+
+typedef void (*transaction_cb_t)(spi_transaction_t* trans);
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    uint16_t duty_cycle_pos;
+    uint16_t cs_ena_pretrans;
+    uint8_t cs_ena_posttrans;
+    int clock_speed_hz;
+    int input_delay_ns;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+struct MockSpiDevice;
+typedef MockSpiDevice* spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* bus_config, spi_dma_chan_t dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* dev_config,
+                             spi_device_handle_t* handle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans_desc, TickType_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** trans_desc,
+                                      TickType_t ticks_to_wait);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc);
+
+// 模拟显存（常规字节序）与写入统计
+#define MOCK_PANEL_WIDTH    128
+#define MOCK_PANEL_HEIGHT   160
+extern uint16_t mock_panel_ram[MOCK_PANEL_WIDTH * MOCK_PANEL_HEIGHT];
+extern uint32_t mock_panel_pixels_written;     // RAMWR之后写入显存的像素数
+extern uint32_t mock_spi_transactions;
+
+#endif // MOCK_DRIVER_SPI_MASTER_H
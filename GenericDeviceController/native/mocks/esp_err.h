@@ -0,0 +1,10 @@
+// esp_err.h（主机构建替身）：ESP-IDF驱动共用的错误码
+#ifndef MOCK_ESP_ERR_H
+#define MOCK_ESP_ERR_H
+
+typedef int esp_err_t;
+#define ESP_OK              0
+#define ESP_FAIL            -1
+#define ESP_ERR_INVALID_ARG 0x102
+
+#endif // MOCK_ESP_ERR_H
@@ -0,0 +1,35 @@
+// esp_partition.h（主机构建替身）
+// ESP-IDF分区API的最小接口。只有一个自定义数据分区devtable（4KB，与partitions_devtable.csv一致），
+// 初始内容与刚擦除的flash相同（全为0xFF）；esp_partition_mmap()直接返回分区内容的地址，与硬件映射一样不复制数据
+#ifndef MOCK_ESP_PARTITION_H
+#define MOCK_ESP_PARTITION_H
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0x00, ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+typedef enum { SPI_FLASH_MMAP_DATA = 0, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label);
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory,
+                             const void** out_ptr, spi_flash_mmap_handle_t* out_handle);
+void spi_flash_munmap(spi_flash_mmap_handle_t handle);
+
+// --- 测试辅助 ---
+#define MOCK_PARTITION_SIZE 0x1000
+bool mock_partition_write(const uint8_t* data, size_t size);   // 擦除分区后写入数据（如tools/device_table.py生成的设备表）
+void mock_partition_erase();                                    // 恢复为全0xFF
+extern uint32_t mock_partition_mapped;                          // 当前未释放的映射数
+
+#endif // MOCK_ESP_PARTITION_H
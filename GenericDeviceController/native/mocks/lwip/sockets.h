@@ -0,0 +1,12 @@
+// lwip/sockets.h（主机构建替身）：ESP32的lwIP套接字接口与POSIX同名，直接使用主机实现
+#ifndef MOCK_LWIP_SOCKETS_H
+#define MOCK_LWIP_SOCKETS_H
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif // MOCK_LWIP_SOCKETS_H
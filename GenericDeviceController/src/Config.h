@@ -2,8 +2,10 @@
 #define CONFIG_H
 
 // =================== 编译配置 ===================
-// 决定此次编译使用哪个节点配置
+// 决定此次编译使用哪个节点配置（主机构建通过-DCURRENT_NODE覆盖，见platformio.ini中的[env:native]）
+#ifndef CURRENT_NODE
 #define CURRENT_NODE 2  // 1=Node1, 2=Node2
+#endif
 
 // 根据节点选择包含对应配置并设置UI显示
 #if CURRENT_NODE == 1
@@ -14,4 +16,85 @@
     #error "CURRENT_NODE must be 1 or 2"
 #endif
 
+// =================== MQTT订阅模式 ===================
+// 0 = 每个设备单独订阅命令Topic（重连时为每个设备各发送一个SUBSCRIBE）
+// 1 = 只订阅一个通配符Topic，由节点按路由表在本地过滤，非本节点设备的消息静默丢弃
+#define MQTT_WILDCARD_SUBSCRIBE 0
+#define MQTT_WILDCARD_COMMAND_TOPIC "smarthome/+/+/command"
+
+// =================== MQTT会话 ===================
+// 0 = 清除会话（默认）：每次重连重新订阅全部命令Topic，断线期间下发的命令丢失
+// 1 = 持久会话（cleanSession=false）：命令Topic以QoS 1订阅，短暂断线期间Broker保留订阅并缓存命令（上位机需以QoS 1发布），
+//     重连时CONNACK的session present标志表明订阅仍在，跳过重新订阅；Broker重启或会话过期时完整订阅。
+//     Broker重投的单设备命令和批量命令由关联ID去重缓存拦截
+// 需要时在platformio.ini对应环境的build_flags中加入-DMQTT_PERSISTENT_SESSION=1开启
+#ifndef MQTT_PERSISTENT_SESSION
+#define MQTT_PERSISTENT_SESSION 0
+#endif
+
+// =================== 消息编码 ===================
+// 启动时的默认回执格式：0 = JSON，1 = MessagePack
+// 收到命令后，节点按命令的实际格式（首字节自动识别）发布后续回执
+#define MQTT_PAYLOAD_FORMAT 0
+
+// =================== MQTT缓冲区 ===================
+// PubSubClient默认缓冲区为256字节，批量命令（最多BATCH_MAX_ENTRIES条）需要更大的接收缓冲区
+// 回执以beginPublish()/write()/endPublish()流式发布，不受该缓冲区限制
+#define MQTT_BUFFER_SIZE        2048
+#define BATCH_COMMAND_DOC_SIZE  3072    // 批量命令解析用JSON文档大小
+#define COMMAND_MAX_PAYLOAD_LEN 256     // 单设备命令的最大长度，超出按JSON_PARSE_ERROR拒绝
+
+// =================== 任务划分 ===================
+// 网络任务（核心0）：WiFi/MQTT状态机、PubSubClient收发、命令解析与回执发布
+// 执行任务（核心1）：设备处理函数、舵机运动、UI刷新与遥测检测
+// 两者之间通过单生产者/单消费者队列传递命令和回执，TFT重绘或舵机动作不会延迟MQTT心跳和收包
+#define NETWORK_TASK_CORE         0
+#define NETWORK_TASK_PRIORITY     2       // 高于日志任务，低于WiFi/lwIP协议栈任务
+#define NETWORK_TASK_STACK_SIZE   8192
+#define NETWORK_TASK_PERIOD_MS    5       // 无新回执时client.loop()的轮询间隔
+#define EXECUTOR_TASK_CORE        1
+#define EXECUTOR_TASK_PRIORITY    1
+#define EXECUTOR_TASK_STACK_SIZE  8192
+#define EXECUTOR_TASK_PERIOD_MS   10      // 无新命令时舵机关键帧和UI的推进间隔
+#define COMMAND_QUEUE_DEPTH       8       // 待执行命令数（2的幂），队列满时回复NODE_BUSY
+#define RESULT_QUEUE_DEPTH        16      // 待发布回执数（2的幂）
+#define COMMAND_PENDING_MAX       16      // 执行任务中待执行命令表的容量（含等待舵机结束的命令）
+
+// =================== 运行指标 ===================
+// 命令处理各阶段的延迟直方图、消息计数、错误码计数和空闲堆内存，定期发布到smarthome/<NODE_ID>/metrics（见core/Metrics.h）
+#define METRICS_ENABLED             1
+#define METRICS_PUBLISH_INTERVAL_MS 60000   // 发布间隔
+
+// =================== 任务轮次剖析 ===================
+// 记录网络任务和执行任务每一轮及其各部分的耗时（见core/LoopProfiler.h），统计结果随运行指标发布，设置页显示轮次频率和最长卡顿
+#define LOOP_PROFILER_ENABLED       1
+#define LOOP_STALL_THRESHOLD_MS     50      // 单轮超过该时长时在串口输出卡顿报告
+
+// =================== UI刷新 ===================
+// 0 = 每次刷新整页重绘（清屏后重画全部内容）
+// 1 = 增量刷新：界面模型记录屏幕上各控件（数值、选中光标、进度条、连接状态）当前显示的内容，
+//     同一页面内只清除并重绘发生变化的控件区域，切换页面时才整页重绘
+// 主机构建可通过-DUI_INCREMENTAL_RENDER=0对比两种方式的绘制像素数（见native/bench/trace_replay.cpp）
+#ifndef UI_INCREMENTAL_RENDER
+#define UI_INCREMENTAL_RENDER       1
+#endif
+
+// 0 = 直接绘制到屏幕，每个图元（矩形、文字像素）一次阻塞的SPI传输
+// 1 = 离屏帧缓冲：绘制到内存中的16位画布（40KB），绘制完成后由SPI DMA在后台发送到屏幕（见sensorsimulator/FrameCanvas.h）；
+//     画布内存不足或SPI总线初始化失败时自动退回直接绘制
+#ifndef UI_FRAMEBUFFER
+#define UI_FRAMEBUFFER              1
+#endif
+#define UI_FLUSH_DIRTY_ROWS         1           // 1 = 只发送上次刷新以来改动过的行，0 = 每次发送整帧
+#define UI_SPI_CLOCK_HZ             27000000    // 帧缓冲模式下DMA传输的SPI时钟
+
+// =================== UI输入 ===================
+// EC11旋钮由脉冲计数器（PCNT）硬件解码A、B两相的全部边沿（见sensorsimulator/RotaryEncoder.h），CPU不处理编码器中断；
+// 按键在中断中记录电平和时间戳放入无锁队列，执行任务按时间去抖，不再在按键后delay()
+#define UI_ENCODER_COUNTS_PER_STEP  4           // 每个逻辑步长的计数（一个完整的正交周期，与原来A相两次跳变对应一步一致）
+#define UI_ENCODER_GLITCH_FILTER    1023        // 毛刺滤波：短于该APB时钟周期数（80MHz下约12.8us）的脉冲被忽略，最大1023
+#define UI_ENCODER_RESYNC_MS        500         // 停止转动超过该时长时丢弃不足一步的计数，重新对齐咔嗒位置
+#define UI_BUTTON_DEBOUNCE_MS       50          // 按键电平变化后该时长内的抖动被忽略
+#define UI_BUTTON_EVENT_QUEUE_DEPTH 16          // 按键事件队列容量（2的幂）
+
 #endif // CONFIG_H 
\ No newline at end of file
@@ -1,5 +1,6 @@
 // GenericDeviceController.ino
 // ESP32主程序，处理设备控制与通信逻辑。
+// 网络任务（核心0）负责WiFi/MQTT、命令解析与回执发布；执行任务（核心1）负责设备、舵机、UI与遥测
 
 // 必要库引用
 #include <WiFi.h>
@@ -13,7 +14,24 @@
     #include "nodeconfig/Node2Config.h"
 #endif
 
+#include "core/AsyncLog.h"
+#include "core/Metrics.h"
+#include "core/LoopProfiler.h"
+#include "core/Symbols.h"
+#include "core/DeviceTable.h"
 #include "core/DeviceControl.h"
+#include "core/CommandDispatch.h"
+#include "core/TopicRouter.h"
+#include "core/BatchCommand.h"
+#include "core/PayloadCodec.h"
+#include "core/CommandParser.h"
+#include "core/MessageWriter.h"
+#include "core/AckMessages.h"
+#include "core/SpscQueue.h"
+#include "core/CommandScheduler.h"
+#include "core/DedupeCache.h"
+#include "core/MqttTransport.h"
+#include "core/RetryBackoff.h"
 
 #if ENABLE_SENSOR_SIMULATOR
     #include "sensorsimulator/UIController.h"
@@ -22,8 +40,8 @@
 #endif
 
 // --- 初始化客户端实例 ---
-WiFiClient espClient;
-PubSubClient client(espClient);
+MqttTransport mqttTransport;    // TCP连接和CONNECT/CONNACK握手由状态机非阻塞完成
+PubSubClient client(mqttTransport);
 
 // --- 状态机定义 ---
 enum WiFiState {
@@ -34,17 +52,84 @@ enum WiFiState {
 
 enum MQTTState {
     MQTT_STATE_DISCONNECTED,    // 未连接
-    MQTT_STATE_CONNECTING,      // 正在连接
+    MQTT_STATE_CONNECTING,      // 正在建立TCP连接
+    MQTT_STATE_HANDSHAKE,       // 已发送CONNECT，等待CONNACK
     MQTT_STATE_CONNECTED        // 已连接
 };
 
 // --- 状态机变量 ---
 static WiFiState wifiState = WIFI_DISCONNECTED;
 static MQTTState mqttState = MQTT_STATE_DISCONNECTED;
-static unsigned long nextWifiRetryMs = 0;
-static unsigned long nextMqttRetryMs = 0;
+static unsigned long wifiRetryStartMs = 0;
+static unsigned long wifiRetryDelayMs = 0;
+static unsigned long mqttRetryStartMs = 0;
+static unsigned long mqttRetryDelayMs = 0;
 static unsigned long wifiConnectStartMs = 0;
 static unsigned long mqttConnectStartMs = 0;
+static unsigned long mqttConnackUs = 0;       // 收到CONNACK（connect()返回成功）的时间，用于统计就绪耗时
+static unsigned long setupDurationUs = 0;     // setup()耗时（含加载设备表），随运行指标发布
+
+// --- 批量命令Topic（启动时生成） ---
+static char batchCommandTopic[TOPIC_MAX_LEN];
+static char batchStateTopic[TOPIC_MAX_LEN];
+
+// --- 运行指标Topic（启动时生成） ---
+static char metricsTopic[TOPIC_MAX_LEN];
+static unsigned long lastMetricsMs = 0;
+
+// --- 节点级传感器快照Topic（启动时生成） ---
+#define SENSORS_DEVICE_ID "sensors"
+static char sensorsCommandTopic[TOPIC_MAX_LEN];
+static char sensorsStateTopic[TOPIC_MAX_LEN];
+
+// --- 持久会话 ---
+// 命令Topic的订阅QoS：持久会话下为1，Broker在节点离线期间缓存命令，重连后补发
+static const uint8_t COMMAND_SUBSCRIBE_QOS = MQTT_PERSISTENT_SESSION ? 1 : 0;
+#if MQTT_PERSISTENT_SESSION
+static bool sessionSubscribed = false;          // 本次启动后是否已在Broker上建立过订阅（节点配置可能随固件改变）
+#endif
+
+#if ENABLE_SENSOR_SIMULATOR
+// --- 各房间遥测Topic（启动时生成） ---
+static char telemetryTopics[ROOM_COUNT][TOPIC_MAX_LEN];
+#endif
+
+// --- 任务间消息 ---
+// 网络任务 -> 执行任务的CommandMessage定义在core/CommandScheduler.h
+// 执行任务 -> 网络任务：待发布的回执
+enum ResultKind : uint8_t {
+    RESULT_COMMAND,     // 单设备命令回执（含舵机结束后的延迟回执）
+    RESULT_BATCH,       // 批量命令汇总回执，内容在batch_context中
+    RESULT_TELEMETRY    // 传感器遥测
+};
+
+struct ResultMessage {
+    ResultKind kind;
+    uint8_t room;                   // 遥测的房间索引
+    const char* state_topic;        // 预先生成的状态Topic或遥测Topic
+    const char* state;              // 回执的state或遥测原因（均为静态字符串）
+    CommandResult result;
+    unsigned long received_us;      // 命令的收到时间，0表示不统计端到端延迟（延迟回执、遥测）
+#if ENABLE_SENSOR_SIMULATOR
+    SensorData sensors;             // 遥测的传感器数据（执行任务提交时复制，发布时不再读取rooms[]）
+#endif
+    char correlation_id[CORRELATION_ID_MAX_LEN];
+};
+
+static SpscQueue<CommandMessage, COMMAND_QUEUE_DEPTH> commandQueue;
+static SpscQueue<ResultMessage, RESULT_QUEUE_DEPTH> resultQueue;
+static CommandScheduler commandScheduler;   // 执行任务独占
+static DedupeCache dedupeCache;             // 网络任务独占
+static TaskHandle_t networkTaskHandle = nullptr;
+static TaskHandle_t executorTaskHandle = nullptr;
+
+// --- 任务轮次剖析 ---
+enum NetworkSection : uint8_t { NET_SECTION_WIFI, NET_SECTION_MQTT, NET_SECTION_CLIENT_LOOP, NET_SECTION_PUBLISH, NET_SECTION_COUNT };
+enum ExecutorSection : uint8_t { EXEC_SECTION_COMMANDS, EXEC_SECTION_SERVO, EXEC_SECTION_UI, EXEC_SECTION_TELEMETRY, EXEC_SECTION_COUNT };
+static const char* const NETWORK_SECTION_NAMES[NET_SECTION_COUNT] = { "wifi", "mqtt", "client.loop", "publish" };
+static const char* const EXECUTOR_SECTION_NAMES[EXEC_SECTION_COUNT] = { "commands", "servo", "ui", "telemetry" };
+static LoopProfiler networkProfiler("network", NETWORK_SECTION_NAMES, NET_SECTION_COUNT, LOOP_STALL_THRESHOLD_MS * 1000UL);
+static LoopProfiler executorProfiler("executor", EXECUTOR_SECTION_NAMES, EXEC_SECTION_COUNT, LOOP_STALL_THRESHOLD_MS * 1000UL);
 
 // --- 状态缓存，用于检测状态变化 ---
 static WiFiState lastWifiState = WIFI_DISCONNECTED;
@@ -52,9 +137,28 @@ static MQTTState lastMqttState = MQTT_STATE_DISCONNECTED;
 
 // --- 状态机超时配置 ---
 static const unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;  // WiFi连接超时10秒
-static const unsigned long WIFI_RETRY_INTERVAL_MS = 5000;    // WiFi重试间隔5秒
-static const unsigned long MQTT_CONNECT_TIMEOUT_MS = 3000;   // MQTT连接超时3秒
-static const unsigned long MQTT_RETRY_INTERVAL_MS = 5000;    // MQTT重试间隔5秒
+static const unsigned long WIFI_RETRY_BASE_MS = 1000;        // WiFi重试间隔1秒起，连续失败时翻倍
+static const unsigned long WIFI_RETRY_MAX_MS = 30000;        // WiFi重试间隔上限30秒
+static const unsigned long MQTT_CONNECT_TIMEOUT_MS = 3000;   // MQTT连接超时3秒（TCP连接与CONNACK合计）
+static const unsigned long MQTT_RETRY_BASE_MS = 1000;        // MQTT重试间隔1秒起，连续失败时翻倍
+static const unsigned long MQTT_RETRY_MAX_MS = 30000;        // MQTT重试间隔上限30秒
+
+// --- 重试退避（带随机抖动，Broker或路由器重启后各节点错开重连） ---
+static RetryBackoff wifiBackoff(WIFI_RETRY_BASE_MS, WIFI_RETRY_MAX_MS);
+static RetryBackoff mqttBackoff(MQTT_RETRY_BASE_MS, MQTT_RETRY_MAX_MS);
+static IPAddress mqttServerIp;
+static bool mqttServerResolved = false;
+
+/**
+ * @brief WiFi连接失败或断开：回到未连接状态，按退避间隔等待下一次重试
+ * @param reason 日志中的原因
+ */
+void schedule_wifi_retry(const char* reason) {
+    wifiState = WIFI_DISCONNECTED;
+    wifiRetryStartMs = millis();
+    wifiRetryDelayMs = wifiBackoff.next_delay_ms();
+    LOG_WARN("[WiFi] %s, retry in %lu ms", reason, wifiRetryDelayMs);
+}
 
 /**
  * @brief 处理WiFi连接状态机
@@ -63,9 +167,9 @@ void handleWiFiState() {
     switch (wifiState) {
         case WIFI_DISCONNECTED:
             // 状态：未连接
-            if (millis() >= nextWifiRetryMs) {
+            if (millis() - wifiRetryStartMs >= wifiRetryDelayMs) {
                 // 事件：到重试时间，开始连接
-                Serial.println("[WiFi] Starting connection...");
+                LOG_INFO("[WiFi] Starting connection...");
                 WiFi.mode(WIFI_STA);
                 WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
                 wifiState = WIFI_CONNECTING;
@@ -78,14 +182,12 @@ void handleWiFiState() {
             if (WiFi.status() == WL_CONNECTED) {
                 // 事件：连接成功
                 wifiState = WIFI_CONNECTED;
-                Serial.println("[WiFi] Connected successfully!");
-                Serial.print("[WiFi] IP: ");
-                Serial.println(WiFi.localIP());
+                wifiBackoff.reset();
+                LOG_INFO("[WiFi] Connected successfully!");
+                LOG_INFO("[WiFi] IP: %s", WiFi.localIP().toString().c_str());
             } else if (millis() - wifiConnectStartMs >= WIFI_CONNECT_TIMEOUT_MS) {
                 // 事件：连接超时
-                Serial.println("[WiFi] Connection timeout, will retry later");
-                wifiState = WIFI_DISCONNECTED;
-                nextWifiRetryMs = millis() + WIFI_RETRY_INTERVAL_MS;
+                schedule_wifi_retry("Connection timeout");
             }
             break;
             
@@ -93,9 +195,7 @@ void handleWiFiState() {
             // 状态：已连接
             if (WiFi.status() != WL_CONNECTED) {
                 // 事件：连接断开
-                Serial.println("[WiFi] Connection lost");
-                wifiState = WIFI_DISCONNECTED;
-                nextWifiRetryMs = millis() + 1000; // 1秒后重试
+                schedule_wifi_retry("Connection lost");
             }
             break;
     }
@@ -110,56 +210,144 @@ void handleWiFiState() {
 }
 
 /**
- * @brief 处理MQTT连接状态机
+ * @brief 订阅命令Topic，并输出从CONNACK到订阅完成的耗时，便于比较两种订阅模式
+ */
+void subscribe_command_topics() {
+#if MQTT_WILDCARD_SUBSCRIBE
+    // 通配符模式：一次订阅，由callback()按路由表过滤
+    client.subscribe(MQTT_WILDCARD_COMMAND_TOPIC, COMMAND_SUBSCRIBE_QOS);
+    int subscribe_count = 1;
+#else
+    // 逐设备订阅（Topic已在路由表中预先生成），另加本节点的批量命令Topic
+    for (int i = 0; i < route_count; i++) {
+        client.subscribe(device_routes[i].command_topic, COMMAND_SUBSCRIBE_QOS);
+    }
+    client.subscribe(batchCommandTopic, COMMAND_SUBSCRIBE_QOS);
+    int subscribe_count = route_count + 1;
+    #if ENABLE_SENSOR_SIMULATOR
+    client.subscribe(sensorsCommandTopic, COMMAND_SUBSCRIBE_QOS);
+    subscribe_count++;
+    #endif
+#endif
+#if MQTT_PERSISTENT_SESSION
+    sessionSubscribed = client.connected();
+#endif
+    unsigned long ready_us = micros() - mqttConnackUs;
+    LOG_INFO("[MQTT] Subscribed %d topic(s), ready %lu us after CONNACK", subscribe_count, ready_us);
+}
+
+/**
+ * @brief 收到CONNACK：持久会话仍在且本次启动已订阅过时跳过重新订阅，否则立即订阅
+ * @param session_present CONNACK中的session present标志
+ */
+void on_mqtt_connected(bool session_present) {
+    mqttConnackUs = micros();
+    mqttState = MQTT_STATE_CONNECTED;
+    mqttBackoff.reset();
+    LOG_INFO("[MQTT] Connected successfully!");
+
+#if MQTT_PERSISTENT_SESSION
+    if (session_present && sessionSubscribed) {
+        LOG_INFO("[MQTT] Session resumed, subscriptions kept");
+        return;
+    }
+#else
+    (void)session_present;  // 清除会话下Broker不保留订阅，总是重新订阅
+#endif
+    subscribe_command_topics();
+}
+
+/**
+ * @brief MQTT连接失败或断开：关闭传输层，回到未连接状态，按退避间隔等待下一次重试
+ * @param reason 日志中的原因
+ */
+void schedule_mqtt_retry(const char* reason) {
+    mqttTransport.stop();
+    mqttState = MQTT_STATE_DISCONNECTED;
+    mqttRetryStartMs = millis();
+    mqttRetryDelayMs = mqttBackoff.next_delay_ms();
+    LOG_WARN("[MQTT] %s, retry in %lu ms", reason, mqttRetryDelayMs);
+}
+
+/**
+ * @brief 解析Broker地址。MQTT_SERVER通常为IP地址，无需DNS；配置为主机名时首次解析会阻塞，结果缓存
+ */
+bool resolve_mqtt_server() {
+    if (!mqttServerResolved) {
+        mqttServerResolved = mqttServerIp.fromString(MQTT_SERVER) || WiFi.hostByName(MQTT_SERVER, mqttServerIp) == 1;
+    }
+    return mqttServerResolved;
+}
+
+/**
+ * @brief 处理MQTT连接状态机。每一步只做零超时的轮询，Broker宕机或无响应时网络任务不被阻塞
  */
 void handleMQTTState() {
     switch (mqttState) {
         case MQTT_STATE_DISCONNECTED:
             // 状态：未连接
-            if (wifiState == WIFI_CONNECTED && millis() >= nextMqttRetryMs) {
-                // 事件：WiFi已连接且到重试时间，开始连接
-                Serial.println("[MQTT] Starting connection...");
-                mqttState = MQTT_STATE_CONNECTING;
+            if (wifiState == WIFI_CONNECTED && millis() - mqttRetryStartMs >= mqttRetryDelayMs) {
+                // 事件：WiFi已连接且到重试时间，发起非阻塞TCP连接
+                LOG_INFO("[MQTT] Starting connection...");
                 mqttConnectStartMs = millis();
+                if (!resolve_mqtt_server()) {
+                    schedule_mqtt_retry("Cannot resolve broker address");
+                } else if (mqttTransport.begin_connect(mqttServerIp, MQTT_PORT)) {
+                    mqttState = MQTT_STATE_CONNECTING;
+                } else {
+                    schedule_mqtt_retry("Connection failed");
+                }
             }
             break;
             
-        case MQTT_STATE_CONNECTING:
-            // 状态：正在连接
-            if (client.connected()) {
-                // 事件：连接成功
-                mqttState = MQTT_STATE_CONNECTED;
-                Serial.println("[MQTT] Connected successfully!");
-                
-                // 订阅所有设备Topic
-                for (int i = 0; i < DEVICE_COUNT; i++) {
-                    char command_topic[128];
-                    snprintf(command_topic, sizeof(command_topic), "smarthome/%s/%s/command", devices[i].room_id, devices[i].device_id);
-                    client.subscribe(command_topic);
-                    Serial.print("[MQTT] Subscribed to: ");
-                    Serial.println(command_topic);
+        case MQTT_STATE_CONNECTING: {
+            // 状态：正在建立TCP连接
+            TransportStatus status = mqttTransport.poll_connect();
+            if (status == TRANSPORT_DONE) {
+                // 事件：TCP连接建立，发送CONNECT（持久会话以NODE_ID为会话标识，cleanSession=false）
+                if (mqttTransport.send_connect(NODE_ID, !MQTT_PERSISTENT_SESSION, MQTT_KEEPALIVE)) {
+                    mqttState = MQTT_STATE_HANDSHAKE;
+                } else {
+                    schedule_mqtt_retry("CONNECT send failed");
                 }
+            } else if (status == TRANSPORT_FAILED) {
+                // 事件：连接被拒绝（Broker未运行）
+                schedule_mqtt_retry("Connection refused");
             } else if (millis() - mqttConnectStartMs >= MQTT_CONNECT_TIMEOUT_MS) {
                 // 事件：连接超时
-                Serial.println("[MQTT] Connection timeout, will retry later");
-                mqttState = MQTT_STATE_DISCONNECTED;
-                nextMqttRetryMs = millis() + MQTT_RETRY_INTERVAL_MS;
-            } else {
-                // 尝试连接（非阻塞，因为设置了短超时）
-                if (!client.connect(NODE_ID)) {
-                    // 连接失败，但继续尝试直到超时
-                    delay(100); // 短暂延迟避免过于频繁
+                schedule_mqtt_retry("Connection timeout");
+            }
+            break;
+        }
+
+        case MQTT_STATE_HANDSHAKE: {
+            // 状态：等待CONNACK
+            bool session_present = false;
+            uint8_t return_code;
+            TransportStatus status = mqttTransport.poll_connack(&session_present, &return_code);
+            if (status == TRANSPORT_DONE) {
+                // 事件：收到CONNACK。PubSubClient直接读取已收到的CONNACK，不再阻塞；同一轮内立即订阅
+                if (client.connect(NODE_ID, nullptr, nullptr, nullptr, 0, false, nullptr, !MQTT_PERSISTENT_SESSION)) {
+                    on_mqtt_connected(session_present);
+                } else {
+                    schedule_mqtt_retry("Handshake failed");
                 }
+            } else if (status == TRANSPORT_FAILED) {
+                // 事件：Broker拒绝连接或断开
+                LOG_WARN("[MQTT] CONNACK return code %u", return_code);
+                schedule_mqtt_retry("Connection rejected");
+            } else if (millis() - mqttConnectStartMs >= MQTT_CONNECT_TIMEOUT_MS) {
+                // 事件：Broker接受了TCP连接但未回复CONNACK
+                schedule_mqtt_retry("CONNACK timeout");
             }
             break;
+        }
             
         case MQTT_STATE_CONNECTED:
             // 状态：已连接
             if (!client.connected()) {
                 // 事件：连接断开
-                Serial.println("[MQTT] Connection lost");
-                mqttState = MQTT_STATE_DISCONNECTED;
-                nextMqttRetryMs = millis() + 1000; // 1秒后重试
+                schedule_mqtt_retry("Connection lost");
             }
             break;
     }
@@ -173,17 +361,23 @@ void handleMQTTState() {
     }
 }
 
+/**
+ * @brief MQTT是否已连接，供执行任务中的UI和遥测使用（不访问网络任务独占的PubSubClient）
+ */
+bool mqtt_connected() {
+    return __atomic_load_n(&mqttState, __ATOMIC_RELAXED) == MQTT_STATE_CONNECTED;
+}
+
 /**
  * @brief 初始化WiFi连接（非阻塞）
  */
 void setup_wifi() {
-    Serial.println();
-    Serial.print("[WiFi] Connecting to: ");
-    Serial.println(WIFI_SSID);
+    LOG_INFO("[WiFi] Connecting to: %s", WIFI_SSID);
     
     // 初始化状态机
     wifiState = WIFI_DISCONNECTED;
-    nextWifiRetryMs = millis() + 1000; // 1秒后开始连接
+    wifiRetryStartMs = millis();
+    wifiRetryDelayMs = WIFI_RETRY_BASE_MS; // 1秒后开始连接
 }
 
 /**
@@ -192,278 +386,678 @@ void setup_wifi() {
  */
 void reconnect() {
     // 此函数保留兼容性，但实际由状态机处理
-    Serial.println("[MQTT] reconnect() called, but using state machine instead");
+    LOG_DEBUG("[MQTT] reconnect() called, but using state machine instead");
 }
 
 /**
  * @brief 发布设备状态，向对应的状态Topic发布执行回执（ACK）。
- * @param device_id 设备ID，用于构建状态Topic
+ * @param state_topic 状态Topic（启动时预先生成）
  * @param state 状态字符串，"ON"或"OFF"等
  * @param correlation_id 关联ID，从命令中收到的原始ID用于匹配请求和响应
  */
-void publish_state(const char* room_id, const char* device_id, const char* state, const char* correlation_id) {
-    // 构造状态Topic的字符串
-    char state_topic[128];
-    snprintf(state_topic, sizeof(state_topic), "smarthome/%s/%s/state", room_id, device_id);
-
-    // 使用ArduinoJson创建一个JSON对象
-    StaticJsonDocument<256> doc;
-    doc["state"] = state;
-    doc["correlation_id"] = correlation_id;
-
-    // 将JSON对象序列化为字符串
-    char buffer[256];
-    size_t n = serializeJson(doc, buffer);
-
-    // 发布回执消息
-    client.publish(state_topic, buffer, n);
-    Serial.print("Published state to "); 
-    Serial.print(state_topic);
-    Serial.print(": "); Serial.println(buffer);
+void publish_state(const char* state_topic, const char* state, const char* correlation_id) {
+    StateAck ack = { state, correlation_id };
+    publish_message(client, state_topic, ack, "state");
 }
 
 /**
  * @brief 发布传感器状态，包含传感器数据
- * @param room_id 房间ID
- * @param device_id 传感器设备ID
+ * @param state_topic 状态Topic
  * @param state 状态字符串，"READ"等
  * @param correlation_id 关联ID
  * @param value 传感器数值
  * @param unit 单位
  */
-void publish_sensor_state(const char* room_id, const char* device_id, const char* state, const char* correlation_id, float value, const char* unit) {
-    // 构造状态Topic的字符串
-    char state_topic[128];
-    snprintf(state_topic, sizeof(state_topic), "smarthome/%s/%s/state", room_id, device_id);
-
-    // 使用ArduinoJson创建一个JSON对象
-    StaticJsonDocument<256> doc;
-    doc["state"] = state;
-    doc["correlation_id"] = correlation_id;
-    doc["value"] = value;
-    doc["unit"] = unit;
-
-    // 将JSON对象序列化为字符串
-    char buffer[256];
-    size_t n = serializeJson(doc, buffer);
-
-    // 发布回执消息
-    client.publish(state_topic, buffer, n);
-    Serial.print("Published sensor state to "); 
-    Serial.print(state_topic);
-    Serial.print(": "); Serial.println(buffer);
+void publish_sensor_state(const char* state_topic, const char* state, const char* correlation_id, float value, const char* unit) {
+    SensorAck ack = { state, correlation_id, value, unit };
+    publish_message(client, state_topic, ack, "sensor state");
 }
 
 /**
  * @brief 发布空调状态，包含温度信息
- * @param room_id 房间ID
- * @param device_id 空调设备ID
+ * @param state_topic 状态Topic
  * @param state 状态字符串，"SET_TEMP"等
  * @param correlation_id 关联ID
  * @param temperature 温度值
  */
-void publish_ac_state(const char* room_id, const char* device_id, const char* state, const char* correlation_id, int temperature) {
-    // 构造状态Topic的字符串
-    char state_topic[128];
-    snprintf(state_topic, sizeof(state_topic), "smarthome/%s/%s/state", room_id, device_id);
-
-    // 使用ArduinoJson创建一个JSON对象
-    StaticJsonDocument<256> doc;
-    doc["state"] = state;
-    doc["correlation_id"] = correlation_id;
-    doc["temperature"] = temperature;
-    doc["unit"] = "°C";
-
-    // 将JSON对象序列化为字符串
-    char buffer[256];
-    size_t n = serializeJson(doc, buffer);
-
-    // 发布回执消息
-    client.publish(state_topic, buffer, n);
-    Serial.print("Published AC state to "); 
-    Serial.print(state_topic);
-    Serial.print(": "); Serial.println(buffer);
+void publish_ac_state(const char* state_topic, const char* state, const char* correlation_id, int temperature) {
+    AcAck ack = { state, correlation_id, temperature, "°C" };
+    publish_message(client, state_topic, ack, "AC state");
 }
 
 /**
  * @brief 发送错误回执给上位机
- * @param room_id 房间ID
- * @param device_id 设备ID
+ * @param state_topic 状态Topic
  * @param correlation_id 请求关联ID
  * @param error_code 错误代码
  * @param error_message 错误描述
  */
-void publish_error_state(const char* room_id, const char* device_id, const char* correlation_id, const char* error_code, const char* error_message) {
-    StaticJsonDocument<256> doc;
-    doc["state"] = "ERROR";
-    doc["correlation_id"] = correlation_id;
-    doc["error_code"] = error_code;
-    doc["error_message"] = error_message;
-    
-    char buffer[256];
-    serializeJson(doc, buffer);
-    
-    char state_topic[128];
-    snprintf(state_topic, sizeof(state_topic), "smarthome/%s/%s/state", room_id, device_id);
-    
-    Serial.print("Published error state to ");
-    Serial.print(state_topic);
-    Serial.print(": "); Serial.println(buffer);
-    
-    client.publish(state_topic, buffer);
+void publish_error_state(const char* state_topic, const char* correlation_id, const char* error_code, const char* error_message) {
+    ErrorAck ack = { "ERROR", correlation_id, error_code, error_message };
+    metrics_count_error(error_code);
+    publish_message(client, state_topic, ack, "error state");
 }
 
 /**
- * @brief MQTT消息回调函数。当任何已订阅的Topic收到消息时，此函数会被自动调用。
- * @param topic 收到消息的Topic名称
- * @param payload 消息的具体内容
- * @param length 消息的长度
+ * @brief 发布传感器快照，一条消息包含一个或全部房间的传感器数据
+ * @param state_topic 状态Topic（房间级为smarthome/{room}/sensors/state，节点级为smarthome/{NODE_ID}/sensors/state）
+ * @param correlation_id 关联ID
+ * @param room_index 房间索引，-1表示全部房间
  */
-void callback(char* topic, byte* payload, unsigned int length) {
-    Serial.println("----------");
-    Serial.print("Message arrived on topic: ");
-    Serial.println(topic);
-
-    // 解析Topic获取房间和设备信息
-    char room[32], device[32];
-    if (sscanf(topic, "smarthome/%[^/]/%[^/]/command", room, device) != 2) {
-        Serial.println("Error: Topic format does not match 'smarthome/{room}/{device}/command'");
-        // 无法解析Topic，无法发送错误回执
+void publish_sensor_snapshot(const char* state_topic, const char* correlation_id, int room_index) {
+    SensorRooms sensors;
+    sensors.capture();
+    SnapshotAck ack = { correlation_id, room_index, sensors };
+    publish_message(client, state_topic, ack, "sensor snapshot");
+}
+
+#if ENABLE_SENSOR_SIMULATOR
+/**
+ * @brief 发布传感器遥测，负载格式与READ_ALL快照一致，无correlation_id
+ * @param telemetry_topic 遥测Topic: smarthome/{room_id}/sensors/telemetry
+ * @param reason 上报原因
+ * @param room_index 房间索引
+ * @param data 执行任务检测到变化时复制的传感器数据
+ */
+void publish_sensor_telemetry(const char* telemetry_topic, const char* reason, int room_index, const SensorData& data) {
+    SensorRooms sensors;
+    sensors.rooms[room_index] = data;
+    TelemetryMessage message = { reason, room_index, sensors };
+    publish_message(client, telemetry_topic, message, "telemetry");
+}
+#endif
+
+/**
+ * @brief 根据处理结果的回执类型发布对应的回执
+ * @param state_topic 状态Topic
+ * @param action 命令中的动作字符串，作为回执的state
+ * @param correlation_id 关联ID
+ * @param result 设备处理函数的执行结果
+ */
+void publish_result(const char* state_topic, const char* action, const char* correlation_id, const CommandResult& result) {
+    switch (result.kind) {
+        case ACK_STATE:
+            publish_state(state_topic, action, correlation_id);
+            break;
+        case ACK_SENSOR:
+            publish_sensor_state(state_topic, action, correlation_id, result.value, result.unit);
+            break;
+        case ACK_AC:
+            publish_ac_state(state_topic, action, correlation_id, (int)result.value);
+            break;
+        case ACK_ERROR:
+            publish_error_state(state_topic, correlation_id, result.error_code, result.error_message);
+            break;
+        case ACK_SNAPSHOT:
+            publish_sensor_snapshot(state_topic, correlation_id, (int)result.value);
+            break;
+        case ACK_DEFERRED:
+            // 回执由舵机运动引擎在序列结束后发布
+            break;
+    }
+}
+
+/**
+ * @brief 发布批量命令的汇总回执，results数组与命令中的commands数组一一对应
+ */
+void publish_batch_state() {
+    SensorRooms sensors;
+    sensors.capture();
+    BatchAck ack = { batch_context, sensors };
+    publish_message(client, batchStateTopic, ack, "batch state");
+}
+
+/**
+ * @brief (网络任务) 发布执行任务送回的全部回执
+ */
+void publish_pending_results() {
+    ResultMessage message;
+    while (resultQueue.pop(message)) {
+        switch (message.kind) {
+            case RESULT_COMMAND:
+                publish_result(message.state_topic, message.state, message.correlation_id, message.result);
+                if (message.received_us != 0) {
+                    metrics_record(STAGE_ACK, message.received_us);
+                }
+                if (message.result.kind == ACK_ERROR && (strcmp(message.result.error_code, "NODE_BUSY") == 0 ||
+                                                         strcmp(message.result.error_code, "BATCH_BUSY") == 0)) {
+                    dedupeCache.remove(message.correlation_id);     // 未执行，允许以相同关联ID重试
+                } else {
+                    dedupeCache.complete(message.correlation_id, message.state, message.result);
+                }
+                break;
+            case RESULT_BATCH:
+                publish_batch_state();
+                dedupeCache.complete(batch_context.correlation_id, "BATCH", command_ok());
+                batch_release();
+                break;
+            case RESULT_TELEMETRY:
+#if ENABLE_SENSOR_SIMULATOR
+                publish_sensor_telemetry(message.state_topic, message.state, message.room, message.sensors);
+#endif
+                break;
+        }
+    }
+}
+
+/**
+ * @brief 网络任务和执行任务的轮次摘要（设置页显示）
+ */
+void loop_profiler_stats(LoopStats& network, LoopStats& executor) {
+    network = networkProfiler.stats();
+    executor = executorProfiler.stats();
+}
+
+/**
+ * @brief (网络任务) 每METRICS_PUBLISH_INTERVAL_MS发布一次运行指标（累计值）
+ */
+void publish_metrics_if_due() {
+    if (!METRICS_ENABLED || mqttState != MQTT_STATE_CONNECTED || millis() - lastMetricsMs < METRICS_PUBLISH_INTERVAL_MS) {
         return;
     }
+    lastMetricsMs = millis();
+
+    // 先复制一份再序列化：执行任务仍在更新直方图和轮次统计，发布本身也会计数，
+    // 统计长度与写入两遍读到的数值必须相同。拷贝约1KB，放在静态存储区，不占用网络任务的栈
+    static NodeMetrics metrics;
+    static LoopProfiler network_loop(networkProfiler);
+    static LoopProfiler executor_loop(executorProfiler);
+    metrics = node_metrics();
+    network_loop = networkProfiler;
+    executor_loop = executorProfiler;
+    MetricsMessage message = { metrics, (uint32_t)(millis() / 1000), ESP.getFreeHeap(), ESP.getMinFreeHeap(),
+                               async_log().dropped(), network_loop, executor_loop, device_table, (uint32_t)setupDurationUs };
+    publish_message(client, metricsTopic, message, "metrics");
+}
+
+/**
+ * @brief (私有辅助函数) 复制关联ID，超长时截断
+ */
+void copy_correlation_id(char* dest, const char* src) {
+    snprintf(dest, CORRELATION_ID_MAX_LEN, "%s", src ? src : "");
+}
+
+/**
+ * @brief (网络任务) 把命令交给执行任务
+ * @return false表示命令队列已满
+ */
+bool post_command(const CommandMessage& message) {
+    if (!commandQueue.push(message)) {
+        return false;
+    }
+    xTaskNotifyGive(executorTaskHandle);
+    return true;
+}
+
+/**
+ * @brief (执行任务) 把回执交给网络任务发布；队列已满时等待网络任务取走，回执不丢弃
+ */
+void post_result(const ResultMessage& message) {
+    while (!resultQueue.push(message)) {
+        vTaskDelay(1);
+    }
+    xTaskNotifyGive(networkTaskHandle);
+}
+
+/**
+ * @brief (执行任务) 提交单设备命令的回执
+ * @param state_topic 状态Topic
+ * @param state 回执的state（静态字符串）
+ * @param correlation_id 关联ID
+ * @param result 执行结果
+ * @param received_us 命令的收到时间，用于统计端到端延迟；0表示不统计
+ */
+void post_command_result(const char* state_topic, const char* state, const char* correlation_id, const CommandResult& result,
+                         unsigned long received_us = 0) {
+    ResultMessage message;
+    message.kind = RESULT_COMMAND;
+    message.room = 0;
+    message.state_topic = state_topic;
+    message.state = state;
+    message.result = result;
+    message.received_us = received_us;
+    copy_correlation_id(message.correlation_id, correlation_id);
+    post_result(message);
+}
+
+/**
+ * @brief (执行任务) 提交批量命令的汇总回执，网络任务发布后释放batch_context
+ */
+void post_batch_result() {
+    ResultMessage message;
+    message.kind = RESULT_BATCH;
+    message.room = 0;
+    message.state_topic = batchStateTopic;
+    message.state = nullptr;
+    message.received_us = 0;
+    message.correlation_id[0] = '\0';
+    post_result(message);
+}
+
+#if ENABLE_SENSOR_SIMULATOR
+/**
+ * @brief 遥测上报回调（执行任务）：传感器数据变化（超过死区）、烟雾/燃气跳变或心跳到期时提交房间快照
+ * 数据随回执消息复制一份，网络任务只序列化这份拷贝，计算长度与写入两遍读到的数值相同
+ * @param room 房间索引
+ * @param data 当前传感器数据
+ * @param reason 上报原因
+ * @return true表示已提交；MQTT未连接或回执队列已满时返回false，下一轮重试
+ */
+bool post_sensor_telemetry(RoomId room, const SensorData& data, const char* reason) {
+    if (!mqtt_connected()) {
+        return false;
+    }
+    ResultMessage message;
+    message.kind = RESULT_TELEMETRY;
+    message.room = room;
+    message.state_topic = telemetryTopics[room];
+    message.state = reason;
+    message.received_us = 0;
+    message.sensors = data;
+    message.correlation_id[0] = '\0';
+    if (!resultQueue.push(message)) {
+        return false;
+    }
+    xTaskNotifyGive(networkTaskHandle);
+    return true;
+}
+#endif
+
+/**
+ * @brief (私有辅助函数) 复制批量命令条目中的字符串字段，缺失或非字符串时为空字符串
+ */
+void copy_batch_field(char* dest, const char* src) {
+    strncpy(dest, src ? src : "", BATCH_NAME_MAX_LEN - 1);
+    dest[BATCH_NAME_MAX_LEN - 1] = '\0';
+}
 
-    // 使用ArduinoJson解析收到的JSON payload
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, payload, length);
+/**
+ * @brief (网络任务) 处理批量命令：校验后交给执行任务逐条执行；含舵机条目时汇总回执在最后一个舵机结束后发布
+ * @param payload 消息内容
+ * @param length 消息长度
+ */
+void handle_batch_message(byte* payload, unsigned int length) {
+    static StaticJsonDocument<BATCH_COMMAND_DOC_SIZE> doc;
+    unsigned long parse_start = metrics_now();
+    DeserializationError error = decode_payload(doc, payload, length);
+    metrics_record(STAGE_PARSE, parse_start);
     if (error) {
-        Serial.print("deserializeJson() failed: ");
-        Serial.println(error.c_str());
-        publish_error_state(room, device, "unknown", "JSON_PARSE_ERROR", "Invalid JSON format");
+        LOG_ERROR("decode_payload() failed: %s", error.c_str());
+        publish_error_state(batchStateTopic, "unknown", "JSON_PARSE_ERROR", payload_format_error_message());
         return;
     }
 
-    const char* action = doc["action"];
-    int value = doc["value"] | 0; // 如果"value"不存在，则默认为0
     const char* correlation_id = doc["correlation_id"];
-    
-    if (!action || !correlation_id) {
-        Serial.println("Error: 'action' or 'correlation_id' missing.");
-        publish_error_state(room, device, correlation_id ? correlation_id : "unknown", "MISSING_REQUIRED_FIELDS", "Missing required fields: action or correlation_id");
+    JsonArray commands = doc["commands"].as<JsonArray>();
+    if (!correlation_id || commands.isNull()) {
+        LOG_ERROR("Error: 'commands' or 'correlation_id' missing.");
+        publish_error_state(batchStateTopic, correlation_id ? correlation_id : "unknown", "MISSING_REQUIRED_FIELDS", "Missing required fields: commands or correlation_id");
+        return;
+    }
+    if (commands.size() > BATCH_MAX_ENTRIES) {
+        publish_error_state(batchStateTopic, correlation_id, "BATCH_TOO_LARGE", "Too many commands in one batch");
+        return;
+    }
+    if (!DedupeCache::fits(correlation_id)) {
+        publish_error_state(batchStateTopic, correlation_id, "CORRELATION_ID_TOO_LONG", "correlation_id is longer than 63 bytes");
         return;
     }
 
-    bool is_on = (strcmp(action, "ON") == 0);
-
-    // --- 将解析出的设备类型分发给对应的HAL函数 ---
-    bool control_success = false;
-    if (strcmp(device, "light") == 0) {
-        control_success = control_light(room, is_on);
-    } else if (strcmp(device, "ac") == 0) {
-        if (strcmp(action, "SET_TEMP") == 0) {
-            // SET_TEMP操作：必须提供有效温度值
-            if (value < 0 || value > 40) {
-                publish_error_state(room, device, correlation_id, "INVALID_TEMPERATURE", "Temperature value invalid. Valid range: 0-40°C");
-                return;
-            }
-            control_success = control_ac_set_temperature(room, value);
-        } else if (strcmp(action, "ON") == 0) {
-            // ON操作：必须提供有效温度值
-            if (value >= 0 && value <= 40) {
-                control_success = control_ac(room, true, value);
-            } else {
-                publish_error_state(room, device, correlation_id, "MISSING_OR_INVALID_VALUE", "ON operation requires valid temperature value (0-40°C)");
-                return;
-            }
-        } else if (strcmp(action, "OFF") == 0) {
-            // OFF操作：不需要温度值
-            control_success = control_ac(room, false, 0);
+    // 重复的批量命令（持久会话下Broker重投或上位机重试）：整个场景不再执行，重放原汇总回执
+    const DedupeEntry* seen = dedupeCache.find(correlation_id);
+    if (seen != nullptr) {
+        if (!seen->completed) {
+            LOG_INFO("[Dedupe] Duplicate batch %s still executing, ignored", correlation_id);
+        } else if (batch_replayable(correlation_id)) {
+            LOG_INFO("[Dedupe] Duplicate batch %s, replaying ACK", correlation_id);
+            publish_batch_state();
         } else {
-            publish_error_state(room, device, correlation_id, "UNKNOWN_ACTION", "Unsupported action for AC device");
-            return;
-        }
-    } else if (strcmp(device, "hood") == 0) {
-        control_success = control_hood(room, is_on);
-    } else if (strcmp(device, "fan") == 0) {
-        control_success = control_fan(room, is_on);
-    } else if (strcmp(device, "bedside_light") == 0) {
-        control_success = control_bedside_light(room, is_on);
-    } else if (strcmp(device, "window") == 0) {
-        control_success = control_window(room, is_on);
-    // } else if (strcmp(device, "door") == 0) {
-    //     control_success = control_door(room, is_on);  // 门设备控制已禁用
-    } else if (strcmp(device, "curtain") == 0) {
-        control_success = control_curtain(room, is_on);
-    } else if (strcmp(device, "temp_sensor") == 0) {
-        float temp_value = control_temperature_sensor(room);
-        if (temp_value != -999.0) {
-            publish_sensor_state(room, device, "READ", correlation_id, temp_value, "°C");
-        } else {
-            publish_error_state(room, device, correlation_id, "SENSOR_READ_ERROR", "Temperature sensor read failed");
+            // 汇总回执已被之后的批量命令覆盖，只能不再执行
+            LOG_WARN("[Dedupe] Duplicate batch %s, ACK no longer held, ignored", correlation_id);
         }
         return;
-    } else if (strcmp(device, "humidity_sensor") == 0) {
-        float humidity_value = control_humidity_sensor(room);
-        if (humidity_value != -999.0) {
-            publish_sensor_state(room, device, "READ", correlation_id, humidity_value, "%");
-        } else {
-            publish_error_state(room, device, correlation_id, "SENSOR_READ_ERROR", "Humidity sensor read failed");
+    }
+
+    BatchRequest* request = batch_request_acquire();
+    if (request == nullptr) {
+        publish_error_state(batchStateTopic, correlation_id, "BATCH_BUSY", "Previous batch is still waiting for servo motions");
+        return;
+    }
+
+    copy_correlation_id(request->correlation_id, correlation_id);
+    for (JsonVariant command : commands) {
+        BatchRequestEntry& entry = request->entries[request->count++];
+        copy_batch_field(entry.room_id, command["room"]);
+        copy_batch_field(entry.device_id, command["device"]);
+        copy_batch_field(entry.action, command["action"]);
+        entry.value = command["value"] | 0;
+        batch_resolve_entry(entry);
+    }
+    batch_request_submit();
+
+    CommandMessage message;
+    message.kind = COMMAND_BATCH;
+    message.action = ACTION_UNKNOWN;
+    message.value = 0;
+    message.route = nullptr;
+    message.received_us = metrics_now();
+    copy_correlation_id(message.correlation_id, correlation_id);
+    if (!post_command(message)) {
+        batch_request_done();
+        publish_error_state(batchStateTopic, correlation_id, "NODE_BUSY", "Command queue is full");
+        return;
+    }
+    dedupeCache.insert(correlation_id, batchStateTopic);
+}
+
+/**
+ * @brief (执行任务) 执行网络任务交来的批量命令
+ */
+void execute_batch_request() {
+    if (!batch_begin(batch_request.correlation_id)) {
+        post_command_result(batchStateTopic, "ERROR", batch_request.correlation_id,
+                            command_error("BATCH_BUSY", "Previous batch is still waiting for servo motions"));
+        batch_request_done();
+        return;
+    }
+
+    // 所有条目在同一轮中执行：开关类设备依次写GPIO，舵机序列同时启动
+    for (int i = 0; i < batch_request.count; i++) {
+        batch_execute_entry(batch_request.entries[i]);
+    }
+    batch_request_done();
+    LOG_INFO("[Batch] %d command(s) executed, %d servo motion(s) pending", batch_context.count, batch_context.pending);
+
+    if (batch_end()) {
+        post_batch_result();
+    }
+}
+
+/**
+ * @brief (执行任务) 把命令队列中取出的命令放入待执行表；批量命令不参与调度，立即执行
+ */
+void schedule_command(const CommandMessage& command) {
+    if (command.kind == COMMAND_BATCH) {
+        execute_batch_request();
+        return;
+    }
+    CommandMessage superseded;
+    switch (commandScheduler.submit(command, &superseded)) {
+        case SCHEDULE_SUPERSEDED:
+            // 旧命令不再执行，立即回复，上位机无需等到超时
+            LOG_INFO("[Scheduler] %s superseded by %s", superseded.correlation_id, command.correlation_id);
+            post_command_result(superseded.route->state_topic, "SUPERSEDED", superseded.correlation_id, command_ok(),
+                                superseded.received_us);
+            break;
+        case SCHEDULE_FULL:
+            LOG_WARN("[Scheduler] Pending command table full, rejecting %s", command.correlation_id);
+            post_command_result(command.route->state_topic, "ERROR", command.correlation_id,
+                                command_error("NODE_BUSY", "Command queue is full"), command.received_us);
+            break;
+        case SCHEDULE_QUEUED:
+            break;
+    }
+}
+
+/**
+ * @brief (执行任务) 执行一条单设备命令，立即完成的命令把回执交给网络任务发布
+ */
+void execute_command(const CommandMessage& command) {
+    const DeviceRoute* route = command.route;
+    metrics_record(STAGE_QUEUE, command.received_us);
+    unsigned long handler_start = metrics_now();
+    CommandResult result = route->handler(*route->handle, command.action, command.value, command.correlation_id);
+    metrics_record(STAGE_HANDLER, handler_start);
+    if (result.kind != ACK_DEFERRED) {
+        // 动作在解析时已精确匹配，action_name()即为命令中的原始动作字符串
+        post_command_result(route->state_topic, action_name(command.action), command.correlation_id, result,
+                            command.received_us);
+    }
+}
+
+/**
+ * @brief 舵机运动序列结束回调（执行任务）：属于批量命令的舵机计入汇总回执，其余单独提交状态回执
+ */
+void on_servo_motion_done(int device, const char* state, const char* correlation_id) {
+    bool batch_done;
+    if (batch_servo_done(device, correlation_id, &batch_done)) {
+        if (batch_done) {
+            post_batch_result();
         }
         return;
-            } else if (strcmp(device, "brightness_sensor") == 0) {
-            float brightness_value = control_brightness_sensor(room);
-            if (brightness_value != -999.0) {
-                publish_sensor_state(room, device, "READ", correlation_id, brightness_value, "%");
-            } else {
-                publish_error_state(room, device, correlation_id, "SENSOR_READ_ERROR", "Brightness sensor read failed");
-            }
-            return;
-        } else if (strcmp(device, "smoke_sensor") == 0) {
-            float smoke_value = control_smoke_sensor(room);
-            if (smoke_value != -999.0) {
-                publish_sensor_state(room, device, "READ", correlation_id, smoke_value, "");
-            } else {
-                publish_error_state(room, device, correlation_id, "SENSOR_READ_ERROR", "Smoke sensor read failed");
-            }
-            return;
-        } else if (strcmp(device, "gas_sensor") == 0) {
-            float gas_value = control_gas_sensor(room);
-            if (gas_value != -999.0) {
-                publish_sensor_state(room, device, "READ", correlation_id, gas_value, "");
-            } else {
-                publish_error_state(room, device, correlation_id, "SENSOR_READ_ERROR", "Gas sensor read failed");
-            }
+    }
+    const DeviceRoute* route = device_route(device);
+    if (route != nullptr) {
+        post_command_result(route->state_topic, state, correlation_id, command_ok());
+    }
+}
+
+/**
+ * @brief MQTT消息回调函数（网络任务）。当任何已订阅的Topic收到消息时，此函数会被自动调用。
+ * 格式错误、未知设备等可直接判定的错误在此回复，设备命令交给执行任务
+ * @param topic 收到消息的Topic名称
+ * @param payload 消息的具体内容
+ * @param length 消息的长度
+ */
+void callback(char* topic, byte* payload, unsigned int length) {
+    unsigned long received_us = metrics_now();
+    if (METRICS_ENABLED) {
+        node_metrics().messages_received++;
+    }
+
+    // client.loop()每次只处理一个数据包：收到消息后通知自身，本轮结束后立即再次轮询，连续到达的命令不受轮询间隔限制
+    xTaskNotifyGive(networkTaskHandle);
+
+    // 本节点的批量命令
+    if (strcmp(topic, batchCommandTopic) == 0) {
+        LOG_INFO("----------");
+        LOG_INFO("Message arrived on topic: %s", topic);
+        handle_batch_message(payload, length);
+        return;
+    }
+
+    // 节点级传感器快照，不对应具体设备
+    bool node_snapshot = false;
+    #if ENABLE_SENSOR_SIMULATOR
+    node_snapshot = strcmp(topic, sensorsCommandTopic) == 0;
+    #endif
+
+    // 通过路由表直接找到设备句柄和处理函数
+    const DeviceRoute* route = node_snapshot ? nullptr : find_route(topic);
+    metrics_record(STAGE_ROUTE, received_us);
+#if MQTT_WILDCARD_SUBSCRIBE
+    if (route == nullptr && !node_snapshot) {
+        // 通配符订阅会收到所有节点的命令，非本节点设备的消息由其他节点处理
+        return;
+    }
+#endif
+
+    LOG_INFO("----------");
+    LOG_INFO("Message arrived on topic: %s", topic);
+
+    // 回执Topic：本节点设备直接使用路由表中预先生成的状态Topic
+    const char* state_topic;
+    const char* device;
+    char device_buf[32];
+    char fallback_topic[96];
+    if (route != nullptr) {
+        state_topic = route->state_topic;
+        device = route->handle->device->device_id;
+    } else if (node_snapshot) {
+        state_topic = sensorsStateTopic;
+        device = SENSORS_DEVICE_ID;
+    } else {
+        // 未命中路由表（非本节点设备），解析Topic以便发送错误回执
+        char room_buf[32];
+        if (sscanf(topic, "smarthome/%31[^/]/%31[^/]/command", room_buf, device_buf) != 2) {
+            LOG_ERROR("Error: Topic format does not match 'smarthome/{room}/{device}/command'");
+            // 无法解析Topic，无法发送错误回执
             return;
+        }
+        snprintf(fallback_topic, sizeof(fallback_topic), "smarthome/%s/%s/state", room_buf, device_buf);
+        state_topic = fallback_topic;
+        device = device_buf;
+    }
+
+    // 原地解析payload（JSON或MessagePack，按首字节自动识别），字符串直接指向接收缓冲区
+    ParsedCommand command;
+    unsigned long parse_start = metrics_now();
+    CommandParseStatus status = parse_command(payload, length, command);
+    metrics_record(STAGE_PARSE, parse_start);
+    if (status != COMMAND_PARSE_OK) {
+        LOG_ERROR("parse_command() failed: %s", status == COMMAND_PARSE_TOO_LARGE ? "TooLarge" : "InvalidInput");
+        publish_error_state(state_topic, "unknown", "JSON_PARSE_ERROR", command_parse_error_message(status));
+        return;
+    }
+
+    const char* action = command.action.data;
+    int value = command.value; // 如果"value"不存在，则默认为0
+    const char* correlation_id = command.correlation_id.data;
+    
+    if (!command.has_required_fields()) {
+        LOG_ERROR("Error: 'action' or 'correlation_id' missing.");
+        publish_error_state(state_topic, correlation_id ? correlation_id : "unknown", "MISSING_REQUIRED_FIELDS", "Missing required fields: action or correlation_id");
+        return;
     }
-    // 添加其他设备类型的判断...
-    // else if (strcmp(device, "oven") == 0) {
-    //     control_oven(room, is_on);
-    // } 
-    else {
-        Serial.print("Warning: No control logic in .ino for device type '");
-        Serial.print(device); Serial.println("'");
+
+    if (node_snapshot) {
+        // 节点级快照只支持READ_ALL，返回全部房间的传感器数据
+        CommandAction node_action = parse_action(action);
+        publish_result(state_topic, action, correlation_id,
+                       node_action == ACTION_READ_ALL ? command_snapshot(-1) : command_unknown_action());
+        return;
+    }
+
+    // --- 本节点设备的处理函数已在建立路由表时按设备类型编号解析；未命中路由表时在此驻留一次设备ID ---
+    DeviceHandler handler = route != nullptr ? route->handler : lookup_device_handler(intern_device_type(device));
+    if (handler == nullptr) {
+        LOG_WARN("Warning: No control logic in .ino for device type '%s'", device);
         // 未知设备类型，发送错误回执
-        publish_error_state(room, device, correlation_id, "UNKNOWN_DEVICE_TYPE", "Device type not supported");
-        return; 
+        publish_error_state(state_topic, correlation_id, "UNKNOWN_DEVICE_TYPE", "Device type not supported");
+        return;
+    }
+    if (route == nullptr) {
+        // 已知设备类型，但不在本节点配置中
+        publish_error_state(state_topic, correlation_id, "DEVICE_NOT_FOUND", "Device not found in this node's configuration");
+        return;
     }
 
-    // 检查设备控制是否成功
-    if (!control_success) {
-        publish_error_state(room, device, correlation_id, "DEVICE_NOT_FOUND", "Device not found in this node's configuration");
+    // 去重缓存与回执队列只保存CORRELATION_ID_MAX_LEN - 1字节的关联ID，超长的ID截断后可能与其他命令冲突，直接拒绝
+    if (!DedupeCache::fits(correlation_id)) {
+        publish_error_state(state_topic, correlation_id, "CORRELATION_ID_TOO_LONG", "correlation_id is longer than 63 bytes");
         return;
     }
-    
-    // 如果上面的if/else块执行了，说明是已知设备，发送回执
-    if (strcmp(device, "ac") == 0 && strcmp(action, "SET_TEMP") == 0) {
-        // 空调温度设置操作需要特殊回执，包含温度信息
-        AirConditionerState* state = get_ac_state(room);
-        if (state != nullptr) {
-            publish_ac_state(room, device, action, correlation_id, state->target_temperature);
+
+    CommandMessage message;
+    message.kind = COMMAND_DEVICE;
+    message.action = parse_action(action);
+    message.value = value;
+    message.route = route;
+    message.received_us = received_us;
+    copy_correlation_id(message.correlation_id, correlation_id);
+
+    // 重复的关联ID（MQTT重投或上位机重试）：不再执行，重放原回执；仍在执行时原回执稍后发布
+    const DedupeEntry* seen = dedupeCache.find(message.correlation_id);
+    if (seen != nullptr) {
+        if (seen->completed) {
+            LOG_INFO("[Dedupe] Duplicate %s, replaying ACK", seen->correlation_id);
+            publish_result(seen->state_topic, seen->state, seen->correlation_id, seen->result);
         } else {
-            publish_state(room, device, action, correlation_id);
+            LOG_INFO("[Dedupe] Duplicate %s still executing, ignored", seen->correlation_id);
         }
-    } else {
-        // 其他操作使用标准回执
-        publish_state(room, device, action, correlation_id);
+        return;
+    }
+
+    if (!post_command(message)) {
+        LOG_WARN("[Task] Command queue full, rejecting command for %s", topic);
+        publish_error_state(state_topic, correlation_id, "NODE_BUSY", "Command queue is full");
+        return;
+    }
+    dedupeCache.insert(message.correlation_id, route->state_topic);
+}
+
+/**
+ * @brief 网络任务的一轮：状态机、收包与回执发布（主机构建的基准测试直接调用）
+ */
+void network_task_step() {
+    networkProfiler.begin_iteration();
+
+    // 处理WiFi状态机
+    handleWiFiState();
+    networkProfiler.end_section(NET_SECTION_WIFI);
+
+    // 处理MQTT状态机
+    handleMQTTState();
+    networkProfiler.end_section(NET_SECTION_MQTT);
+
+    // PubSubClient库的心跳函数，必须持续调用
+    // 负责处理底层的网络收发和消息检查，并在有新消息时触发注册的callback函数
+    client.loop();
+    networkProfiler.end_section(NET_SECTION_CLIENT_LOOP);
+
+    publish_pending_results();
+    publish_metrics_if_due();
+    networkProfiler.end_section(NET_SECTION_PUBLISH);
+
+    networkProfiler.end_iteration();
+}
+
+/**
+ * @brief 网络任务：WiFi/MQTT状态机和PubSubClient只在此任务中访问
+ * 收到命令后交给执行任务，执行任务送回的回执在此发布；执行任务再忙也不会延迟MQTT心跳和收包
+ */
+void network_task(void*) {
+    for (;;) {
+        network_task_step();
+
+        // 有新回执或刚收到消息时立即进入下一轮，否则按周期轮询
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NETWORK_TASK_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief 执行任务的一轮：调度并执行命令、推进舵机、刷新UI与遥测（主机构建的基准测试直接调用）
+ */
+void executor_task_step() {
+    executorProfiler.begin_iteration();
+
+    CommandMessage command;
+    while (commandQueue.pop(command)) {
+        schedule_command(command);
+    }
+    executorProfiler.end_section(EXEC_SECTION_COMMANDS);
+
+    // 推进舵机运动序列（非阻塞）
+    update_servo_motions();
+    executorProfiler.end_section(EXEC_SECTION_SERVO);
+
+    // 按优先级执行待执行表中的命令；舵机仍在运动的设备，其命令留到序列结束后执行
+    while (commandScheduler.next(&command)) {
+        execute_command(command);
+    }
+    executorProfiler.end_section(EXEC_SECTION_COMMANDS);
+
+    #if ENABLE_SENSOR_SIMULATOR
+    uiController.update();
+    executorProfiler.end_section(EXEC_SECTION_UI);
+
+    // 传感器数据变化时上报遥测，无变化时按心跳间隔上报
+    updateSensorTelemetry();
+    executorProfiler.end_section(EXEC_SECTION_TELEMETRY);
+    #endif
+
+    executorProfiler.end_iteration();
+}
+
+/**
+ * @brief 执行任务：设备处理函数、舵机运动、UI和遥测检测只在此任务中运行
+ */
+void executor_task(void*) {
+    for (;;) {
+        executor_task_step();
+
+        // 有新命令时由网络任务立即唤醒，否则按周期推进舵机关键帧和UI
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EXECUTOR_TASK_PERIOD_MS));
     }
 }
 
@@ -471,41 +1065,53 @@ void callback(char* topic, byte* payload, unsigned int length) {
  * @brief 程序入口和初始化。
  */
 void setup() {
+    unsigned long setupStartUs = micros();
     Serial.begin(115200);   // 启动串口，用于调试输出
+    async_log_begin();      // 启动日志输出任务，之后的日志不再阻塞主循环
+    load_device_table();    // 映射devtable分区中的设备表（分区无效时使用内置设备表），生成devices[]
     setup_devices();        // 初始化硬件设备
+    build_device_routes();  // 建立命令Topic路由表
+    snprintf(batchCommandTopic, sizeof(batchCommandTopic), "smarthome/%s/%s/command", NODE_ID, BATCH_DEVICE_ID);
+    snprintf(batchStateTopic, sizeof(batchStateTopic), "smarthome/%s/%s/state", NODE_ID, BATCH_DEVICE_ID);
+    snprintf(metricsTopic, sizeof(metricsTopic), "smarthome/%s/metrics", NODE_ID);
+    snprintf(sensorsCommandTopic, sizeof(sensorsCommandTopic), "smarthome/%s/%s/command", NODE_ID, SENSORS_DEVICE_ID);
+    snprintf(sensorsStateTopic, sizeof(sensorsStateTopic), "smarthome/%s/%s/state", NODE_ID, SENSORS_DEVICE_ID);
+    #if ENABLE_SENSOR_SIMULATOR
+    for (int i = 0; i < ROOM_COUNT; i++) {
+        snprintf(telemetryTopics[i], sizeof(telemetryTopics[i]), "smarthome/%s/%s/telemetry", room_symbol_id(i), SENSORS_DEVICE_ID);
+    }
+    #endif
     
     #if ENABLE_SENSOR_SIMULATOR
     initSensorData();       // 初始化传感器数据
+    setSensorTelemetryCallback(post_sensor_telemetry); // 传感器数据变化时主动上报
     uiController.begin();   // 初始化UI控制器
     #endif
     
     setup_wifi();                               // 连接WiFi
-    client.setServer(MQTT_SERVER, MQTT_PORT);   // 设置MQTT Broker的地址
+    client.setServer(MQTT_SERVER, MQTT_PORT);   // 设置MQTT Broker的地址（实际连接由状态机经mqttTransport建立）
     client.setSocketTimeout(1);                 // 降低阻塞时长，单位秒
+    client.setBufferSize(MQTT_BUFFER_SIZE);     // 批量命令超过默认的256字节（回执以流式发布，不占用该缓冲区）
     client.setCallback(callback);               // 注册的回调函数
+    set_servo_motion_callback(on_servo_motion_done); // 舵机运动序列结束时提交回执
 
     // WiFi状态事件，触发UI刷新（状态机会自动处理状态变化检测）
-    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t){
+    WiFi.onEvent([](WiFiEvent_t, WiFiEventInfo_t){
         // 事件回调保留，但实际刷新由状态机统一处理
         // 避免重复刷新
     });
+
+    // 先创建执行任务，网络任务收到的第一条命令即可通知到它
+    xTaskCreatePinnedToCore(executor_task, "executor", EXECUTOR_TASK_STACK_SIZE, nullptr, EXECUTOR_TASK_PRIORITY, &executorTaskHandle, EXECUTOR_TASK_CORE);
+    xTaskCreatePinnedToCore(network_task, "network", NETWORK_TASK_STACK_SIZE, nullptr, NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+
+    setupDurationUs = micros() - setupStartUs;
+    LOG_INFO("[Boot] setup() finished in %lu us (device table %lu us)", setupDurationUs, (unsigned long)device_table.load_us);
 }
 
 /**
- * @brief 主循环。
+ * @brief 主循环。工作已全部移至网络任务和执行任务，loopTask删除自身
  */
 void loop() {
-    #if ENABLE_SENSOR_SIMULATOR
-    uiController.update();
-    #endif
-    
-    // 处理WiFi状态机
-    handleWiFiState();
-
-    // 处理MQTT状态机
-    handleMQTTState();
-
-    // PubSubClient库的心跳函数，必须在loop中持续调用
-    // 负责处理底层的网络收发和消息检查，并在有新消息时触发注册的callback函数
-    client.loop();
-}
\ No newline at end of file
+    vTaskDelete(nullptr);
+}
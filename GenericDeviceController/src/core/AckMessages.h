@@ -0,0 +1,347 @@
+// AckMessages.h
+// 回执消息类型：每种回执是一个只保存指针和数值的结构体，序列化代码由字段列表在编译期生成
+// 所有回执共用publish_message()：先统计长度，再经beginPublish()/write()/endPublish()直接写入MQTT连接，
+// 不构建JSON文档、不复制到中间缓冲区，栈占用固定；回执日志直接写入异步日志缓冲区
+#ifndef ACK_MESSAGES_H
+#define ACK_MESSAGES_H
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+
+// =================== 编译期生成的平铺消息 ===================
+// 字段列表 F(名称, 类型) 同时生成结构体成员、字段个数和序列化代码，字段名即为消息中的键名
+#define MESSAGE_MEMBER(name, type) type name;
+#define MESSAGE_COUNT(name, type)  + 1
+#define MESSAGE_WRITE(name, type)  w.key(#name); w.value(name);
+
+#define DEFINE_MESSAGE(Name, FIELDS)                                    \
+    struct Name {                                                       \
+        FIELDS(MESSAGE_MEMBER)                                          \
+        enum { field_count = 0 FIELDS(MESSAGE_COUNT) };                 \
+        void write(MessageWriter& w) const {                            \
+            w.begin_object(field_count);                                \
+            FIELDS(MESSAGE_WRITE)                                       \
+            w.end_object();                                             \
+        }                                                               \
+    };
+
+// 标准状态回执 {"state", "correlation_id"}
+#define STATE_ACK_FIELDS(F) \
+    F(state, const char*) F(correlation_id, const char*)
+DEFINE_MESSAGE(StateAck, STATE_ACK_FIELDS)
+
+// 传感器读数回执 {"state", "correlation_id", "value", "unit"}
+#define SENSOR_ACK_FIELDS(F) \
+    F(state, const char*) F(correlation_id, const char*) F(value, float) F(unit, const char*)
+DEFINE_MESSAGE(SensorAck, SENSOR_ACK_FIELDS)
+
+// 空调温度回执 {"state", "correlation_id", "temperature", "unit"}
+#define AC_ACK_FIELDS(F) \
+    F(state, const char*) F(correlation_id, const char*) F(temperature, int) F(unit, const char*)
+DEFINE_MESSAGE(AcAck, AC_ACK_FIELDS)
+
+// 错误回执 {"state": "ERROR", "correlation_id", "error_code", "error_message"}
+#define ERROR_ACK_FIELDS(F) \
+    F(state, const char*) F(correlation_id, const char*) F(error_code, const char*) F(error_message, const char*)
+DEFINE_MESSAGE(ErrorAck, ERROR_ACK_FIELDS)
+
+#undef MESSAGE_MEMBER
+#undef MESSAGE_COUNT
+#undef MESSAGE_WRITE
+
+// =================== 嵌套消息 ===================
+// 传感器数据的拷贝：publish_message()先统计长度再写入，两遍必须读到相同的数值。
+// 执行任务随时会更新rooms[]，浮点数在JSON中的长度随数值变化（"25.5"与"26"），
+// 因此回执只序列化发布前复制的这一份，不直接读取rooms[]
+struct SensorRooms {
+#if ENABLE_SENSOR_SIMULATOR
+    SensorData rooms[ROOM_COUNT];
+#endif
+
+    /**
+     * @brief 复制全部房间的当前数据（网络任务发布快照前调用一次）
+     */
+    void capture() {
+#if ENABLE_SENSOR_SIMULATOR
+        for (int i = 0; i < ROOM_COUNT; i++) {
+            rooms[i] = *getSensorDataPtr((RoomId)i);
+        }
+#endif
+    }
+};
+
+/**
+ * @brief 写入传感器快照的rooms对象，数组顺序固定为 [temperature, humidity, brightness, smoke, gas]
+ * @param w 写入器
+ * @param sensors 发布前复制的传感器数据
+ * @param room_index 房间索引，-1表示全部房间
+ */
+void write_sensor_rooms(MessageWriter& w, const SensorRooms& sensors, int room_index) {
+#if ENABLE_SENSOR_SIMULATOR
+    int first = room_index < 0 ? 0 : room_index;
+    int last = room_index < 0 ? ROOM_COUNT - 1 : room_index;
+    w.begin_object((uint8_t)(last - first + 1));
+    for (int i = first; i <= last; i++) {
+        const SensorData& data = sensors.rooms[i];
+        w.key(room_symbol_id(i));
+        w.begin_array(5);
+        w.value(data.temperature);
+        w.value(data.humidity);
+        w.value(data.brightness);
+        w.value(data.smoke_detected ? 1 : 0);
+        w.value(data.gas_leak ? 1 : 0);
+        w.end_array();
+    }
+    w.end_object();
+#else
+    (void)sensors;      // 未启用传感器模拟器时没有传感器数据
+    (void)room_index;
+    w.begin_object(0);
+    w.end_object();
+#endif
+}
+
+// 传感器快照回执 {"state": "READ_ALL", "correlation_id", "rooms"}
+struct SnapshotAck {
+    const char* correlation_id;
+    int room_index;     // -1表示全部房间
+    const SensorRooms& sensors;
+
+    void write(MessageWriter& w) const {
+        w.begin_object(3);
+        w.key("state"); w.value("READ_ALL");
+        w.key("correlation_id"); w.value(correlation_id);
+        w.key("rooms"); write_sensor_rooms(w, sensors, room_index);
+        w.end_object();
+    }
+};
+
+// 传感器遥测 {"state": "TELEMETRY", "reason", "rooms"}
+struct TelemetryMessage {
+    const char* reason;
+    int room_index;
+    const SensorRooms& sensors;
+
+    void write(MessageWriter& w) const {
+        w.begin_object(3);
+        w.key("state"); w.value("TELEMETRY");
+        w.key("reason"); w.value(reason);
+        w.key("rooms"); write_sensor_rooms(w, sensors, room_index);
+        w.end_object();
+    }
+};
+
+// 批量命令汇总回执 {"state": "BATCH", "correlation_id", "results": [...]}
+struct BatchAck {
+    const BatchContext& batch;
+    const SensorRooms& sensors;     // 快照条目的传感器数据
+
+    void write(MessageWriter& w) const {
+        w.begin_object(3);
+        w.key("state"); w.value("BATCH");
+        w.key("correlation_id"); w.value(batch.correlation_id);
+        w.key("results");
+        w.begin_array(batch.count);
+        for (int i = 0; i < batch.count; i++) {
+            write_entry(w, batch.entries[i], sensors);
+        }
+        w.end_array();
+        w.end_object();
+    }
+
+private:
+    static void write_entry(MessageWriter& w, const BatchEntry& entry, const SensorRooms& sensors) {
+        const CommandResult& result = entry.result;
+        uint8_t field_count = 3;
+        if (result.kind == ACK_SENSOR || result.kind == ACK_AC || result.kind == ACK_ERROR) {
+            field_count = 5;
+        } else if (result.kind == ACK_SNAPSHOT) {
+            field_count = 4;
+        }
+
+        w.begin_object(field_count);
+        w.key("room"); w.value(entry.room_id);
+        w.key("device"); w.value(entry.device_id);
+        w.key("state"); w.value(result.kind == ACK_ERROR ? "ERROR" : action_name(entry.action));
+        switch (result.kind) {
+            case ACK_SENSOR:
+                w.key("value"); w.value(result.value);
+                w.key("unit"); w.value(result.unit);
+                break;
+            case ACK_AC:
+                w.key("temperature"); w.value((int)result.value);
+                w.key("unit"); w.value("°C");
+                break;
+            case ACK_ERROR:
+                w.key("error_code"); w.value(result.error_code);
+                w.key("error_message"); w.value(result.error_message);
+                break;
+            case ACK_SNAPSHOT:
+                w.key("rooms"); write_sensor_rooms(w, sensors, (int)result.value);
+                break;
+            default:
+                break;
+        }
+        w.end_object();
+    }
+};
+
+// 运行指标 {"state": "METRICS", "uptime_s", "free_heap", "min_free_heap", "messages", "errors", "stages", "loops", "boot"}
+// stages中每个阶段为{"count", "max_us", "buckets"}，buckets的含义见core/Metrics.h；loops为网络任务和执行任务的轮次统计；
+// boot为{"device_table", "device_table_us", "setup_us"}，即设备表来源与启动耗时
+// 所有字段都应是发布前复制的值：publish_message()先统计长度再写入，两遍之间数值变化会使写入的字节数与声明的长度不符
+struct MetricsMessage {
+    const NodeMetrics& metrics;
+    uint32_t uptime_s;
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t log_dropped;
+    const LoopProfiler& network_loop;
+    const LoopProfiler& executor_loop;
+    const DeviceTable& table;
+    uint32_t setup_us;
+
+    void write(MessageWriter& w) const {
+        w.begin_object(9);
+        w.key("state"); w.value("METRICS");
+        w.key("uptime_s"); w.value((int)uptime_s);
+        w.key("free_heap"); w.value((int)free_heap);
+        w.key("min_free_heap"); w.value((int)min_free_heap);
+
+        w.key("messages");
+        w.begin_object(4);
+        w.key("received"); w.value((int)metrics.messages_received);
+        w.key("published"); w.value((int)metrics.messages_published);
+        w.key("publish_failed"); w.value((int)metrics.publish_failed);
+        w.key("log_dropped"); w.value((int)log_dropped);
+        w.end_object();
+
+        w.key("errors");
+        w.begin_object(metrics.error_code_count + 1);
+        for (uint8_t i = 0; i < metrics.error_code_count; i++) {
+            w.key(metrics.errors[i].code); w.value((int)metrics.errors[i].count);
+        }
+        w.key("other"); w.value((int)metrics.errors_other);
+        w.end_object();
+
+        w.key("stages");
+        w.begin_object(STAGE_COUNT);
+        for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+            const StageHistogram& histogram = metrics.stages[i];
+            w.key(metrics_stage_name(i));
+            w.begin_object(3);
+            w.key("count"); w.value((int)histogram.count);
+            w.key("max_us"); w.value((int)histogram.max_us);
+            w.key("buckets");
+            w.begin_array(METRICS_BUCKET_COUNT);
+            for (uint8_t b = 0; b < METRICS_BUCKET_COUNT; b++) {
+                w.value((int)histogram.buckets[b]);
+            }
+            w.end_array();
+            w.end_object();
+        }
+        w.end_object();
+
+        w.key("loops");
+        w.begin_object(2);
+        write_loop(w, network_loop);
+        write_loop(w, executor_loop);
+        w.end_object();
+
+        // 启动耗时：设备表来源（partition/builtin）及加载耗时、setup()总耗时
+        w.key("boot");
+        w.begin_object(3);
+        w.key("device_table"); w.value(table.mapped ? "partition" : "builtin");
+        w.key("device_table_us"); w.value((int)table.load_us);
+        w.key("setup_us"); w.value((int)setup_us);
+        w.end_object();
+        w.end_object();
+    }
+
+private:
+    // {"hz", "p50_us", "p99_us", "max_us", "stalls", "worst_section", "sections": {"<部分>": 单轮最长耗时}}
+    static void write_loop(MessageWriter& w, const LoopProfiler& profiler) {
+        LoopStats stats = profiler.stats();
+        w.key(profiler.name());
+        w.begin_object(7);
+        w.key("hz"); w.value((int)stats.hz);
+        w.key("p50_us"); w.value((int)profiler.percentile_us(50));
+        w.key("p99_us"); w.value((int)profiler.percentile_us(99));
+        w.key("max_us"); w.value((int)stats.worst_stall_us);
+        w.key("stalls"); w.value((int)profiler.stalls());
+        w.key("worst_section"); w.value(stats.worst_section);
+        w.key("sections");
+        w.begin_object(profiler.section_count());
+        for (uint8_t i = 0; i < profiler.section_count(); i++) {
+            w.key(profiler.section_name(i)); w.value((int)profiler.section_max_us(i));
+        }
+        w.end_object();
+        w.end_object();
+    }
+};
+
+// =================== 统一发布路径 ===================
+/**
+ * @brief 以流式方式发布回执：先统计编码后的长度，再直接写入MQTT连接
+ * 编码格式跟随payload_format（JSON或MessagePack）；日志始终以JSON输出
+ * @param client MQTT客户端
+ * @param topic 发布的Topic（通常为启动时预先生成的状态Topic）
+ * @param message 回执消息
+ * @param label 日志中的回执类型描述
+ * @return true表示发布成功
+ */
+template <typename Message>
+bool publish_message(PubSubClient& client, const char* topic, const Message& message, const char* label) {
+    bool msgpack = payload_format == PAYLOAD_MSGPACK;
+
+    unsigned long serialize_start = metrics_now();
+    ByteCounter counter;
+    MessageWriter measure(counter, msgpack);
+    message.write(measure);
+    uint32_t serialize_us = (uint32_t)(metrics_now() - serialize_start);
+
+    unsigned long publish_start = metrics_now();
+    bool ok = client.beginPublish(topic, counter.count, false);
+    if (ok) {
+        ChunkedPrint chunked(client);
+        MessageWriter writer(chunked, msgpack);
+        message.write(writer);
+        chunked.flush_chunk();
+        ok = client.endPublish() != 0;
+    }
+    // 序列化耗时在写入完成后才记录，两遍序列化之间不改动任何计数
+    metrics_record_duration(STAGE_SERIALIZE, serialize_us);
+    metrics_record(STAGE_PUBLISH, publish_start);
+    if (METRICS_ENABLED) {
+        if (ok) {
+            node_metrics().messages_published++;
+        } else {
+            node_metrics().publish_failed++;
+        }
+    }
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+    // 日志始终为JSON：长度已知后直接写入日志缓冲区，不经过格式化缓冲
+    size_t json_length = counter.count;
+    if (msgpack) {
+        ByteCounter json_counter;
+        MessageWriter json_measure(json_counter, false);
+        message.write(json_measure);
+        json_length = json_counter.count;
+    }
+    char prefix[LOG_LINE_MAX];
+    int prefix_length = snprintf(prefix, sizeof(prefix), "Published %s to %s: ", label, topic);
+    if (prefix_length >= (int)sizeof(prefix)) {
+        prefix_length = sizeof(prefix) - 1;
+    }
+    LogRecord record(prefix_length + json_length);
+    if (record) {
+        record.write((const uint8_t*)prefix, prefix_length);
+        MessageWriter log(record, false);
+        message.write(log);
+    }
+#endif
+    return ok;
+}
+
+#endif // ACK_MESSAGES_H
@@ -0,0 +1,250 @@
+// AsyncLog.h
+// 异步分级日志：日志先格式化到无锁环形缓冲区，再由低优先级任务写入串口，
+// 命令处理和回执发布等热路径不再等待115200波特率的串口发送
+// 低于LOG_LEVEL的日志在编译期移除；缓冲区已满时丢弃整条日志并计数，由输出任务在串口上报
+// 调用方的LOG_INFO耗时见主机构建的native/bench/trace_replay.cpp（bench_logging()）
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// =================== 日志级别 ===================
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+// 编译期日志级别：高于该级别的日志调用不产生任何代码
+// 发布版本通过构建参数覆盖，见platformio.ini中的[env:esp32dev_release]
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE  4096   // 环形缓冲区大小（字节，必须是2的幂）
+#endif
+#define LOG_LINE_MAX             160    // 单条格式化日志的最大长度，超出部分截断
+#define LOG_DRAIN_INTERVAL_MS    10     // 输出任务的轮询间隔
+#define LOG_TASK_STACK_SIZE      2048
+#define LOG_TASK_PRIORITY        1      // 低于网络任务，WiFi/MQTT协议栈任务优先级更高
+#define LOG_TASK_CORE            0      // 与执行任务所在的核心1分开
+
+#define LOG_ERROR(...) do { if (LOG_LEVEL >= LOG_LEVEL_ERROR) async_log_printf(__VA_ARGS__); } while (0)
+#define LOG_WARN(...)  do { if (LOG_LEVEL >= LOG_LEVEL_WARN)  async_log_printf(__VA_ARGS__); } while (0)
+#define LOG_INFO(...)  do { if (LOG_LEVEL >= LOG_LEVEL_INFO)  async_log_printf(__VA_ARGS__); } while (0)
+#define LOG_DEBUG(...) do { if (LOG_LEVEL >= LOG_LEVEL_DEBUG) async_log_printf(__VA_ARGS__); } while (0)
+
+/**
+ * @brief 多生产者、单消费者的无锁环形缓冲区
+ * 每条日志是一条记录：4字节头部（最高位为提交标志，低16位为长度）+ 按4字节对齐的正文，正文可跨越缓冲区末尾
+ * 生产者用CAS预留空间，写完正文后原子写入头部完成提交；消费者按顺序输出已提交的记录，
+ * 输出后将该区域清零，使未提交记录的头部始终读到0
+ */
+class AsyncLog {
+public:
+    AsyncLog() : head_(0), tail_(0), dropped_(0) {
+        memset(words_, 0, sizeof(words_));
+    }
+
+    /**
+     * @brief 预留一条记录
+     * @param length 正文长度
+     * @param position 输出记录起始位置
+     * @return false表示空间不足，该条日志被丢弃
+     */
+    bool reserve(size_t length, uint32_t* position) {
+        uint32_t total = record_size(length);
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+        do {
+            uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+            if (length > 0xFFFF || head - tail + total > LOG_BUFFER_SIZE) {
+                __atomic_fetch_add(&dropped_, 1, __ATOMIC_RELAXED);
+                return false;
+            }
+        } while (!__atomic_compare_exchange_n(&head_, &head, head + total, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+        *position = head;
+        return true;
+    }
+
+    /**
+     * @brief 向已预留的记录写入正文
+     * @param position 记录起始位置
+     * @param offset 正文内偏移
+     * @param data 数据
+     * @param length 数据长度
+     */
+    void write(uint32_t position, size_t offset, const uint8_t* data, size_t length) {
+        uint8_t* bytes = (uint8_t*)words_;
+        uint32_t start = (position + 4 + offset) & (LOG_BUFFER_SIZE - 1);
+        size_t first = LOG_BUFFER_SIZE - start;
+        if (first > length) {
+            first = length;
+        }
+        memcpy(bytes + start, data, first);
+        memcpy(bytes, data + first, length - first);
+    }
+
+    /**
+     * @brief 提交记录，之后消费者即可输出
+     * @param position 记录起始位置
+     * @param length 正文长度
+     */
+    void commit(uint32_t position, size_t length) {
+        __atomic_store_n(&words_[header_index(position)], COMMITTED | (uint32_t)length, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief 输出所有已提交的记录（仅由输出任务调用），每条记录后追加换行
+     * @param out 输出流
+     * @return 输出的记录条数
+     */
+    size_t drain(Print& out) {
+        const uint8_t* bytes = (const uint8_t*)words_;
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+        size_t records = 0;
+        while (tail != head) {
+            uint32_t header = __atomic_load_n(&words_[header_index(tail)], __ATOMIC_ACQUIRE);
+            if (header == 0) {
+                break;  // 记录已预留但尚未提交，保持顺序，下次再输出
+            }
+            size_t length = header & 0xFFFF;
+            uint32_t start = (tail + 4) & (LOG_BUFFER_SIZE - 1);
+            size_t first = LOG_BUFFER_SIZE - start;
+            if (first > length) {
+                first = length;
+            }
+            out.write(bytes + start, first);
+            out.write(bytes, length - first);
+            out.write((const uint8_t*)"\r\n", 2);
+
+            uint32_t total = record_size(length);
+            for (uint32_t i = 0; i < total; i += 4) {
+                words_[header_index(tail + i)] = 0;
+            }
+            tail += total;
+            __atomic_store_n(&tail_, tail, __ATOMIC_RELEASE);
+            records++;
+        }
+        return records;
+    }
+
+    uint32_t dropped() const {
+        return __atomic_load_n(&dropped_, __ATOMIC_RELAXED);
+    }
+
+private:
+    static const uint32_t COMMITTED = 0x80000000u;
+
+    uint32_t words_[LOG_BUFFER_SIZE / 4];
+    uint32_t head_;     // 已预留位置（生产者）
+    uint32_t tail_;     // 已输出位置（消费者）
+    uint32_t dropped_;  // 因空间不足丢弃的日志条数
+
+    static uint32_t record_size(size_t length) {
+        return 4 + (((uint32_t)length + 3) & ~3u);
+    }
+
+    static uint32_t header_index(uint32_t position) {
+        return (position & (LOG_BUFFER_SIZE - 1)) / 4;
+    }
+};
+
+inline AsyncLog& async_log() {
+    static AsyncLog log;
+    return log;
+}
+
+/**
+ * @brief 直接写入环形缓冲区的单条日志，用于长度已知、无需格式化的长日志（如回执内容）
+ * 构造时按总长度预留空间，析构时提交；预留失败时写入被忽略
+ */
+class LogRecord : public Print {
+public:
+    explicit LogRecord(size_t length) : length_(length), offset_(0) {
+        reserved_ = async_log().reserve(length, &position_);
+    }
+
+    ~LogRecord() {
+        if (reserved_) {
+            // 实际写入不足预留长度时以空格补齐，保证记录完整
+            while (offset_ < length_) {
+                write((uint8_t)' ');
+            }
+            async_log().commit(position_, length_);
+        }
+    }
+
+    explicit operator bool() const { return reserved_; }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        if (!reserved_) {
+            return 0;
+        }
+        if (size > length_ - offset_) {
+            size = length_ - offset_;
+        }
+        async_log().write(position_, offset_, data, size);
+        offset_ += size;
+        return size;
+    }
+
+private:
+    size_t length_;
+    size_t offset_;
+    uint32_t position_;
+    bool reserved_;
+};
+
+/**
+ * @brief 格式化一条日志并放入环形缓冲区（不等待串口），通常通过LOG_INFO等宏调用
+ * @param format printf格式字符串
+ */
+inline void async_log_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+inline void async_log_printf(const char* format, ...) {
+    char line[LOG_LINE_MAX];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n < 0) {
+        return;
+    }
+    size_t length = (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1;
+    uint32_t position;
+    if (async_log().reserve(length, &position)) {
+        async_log().write(position, 0, (const uint8_t*)line, length);
+        async_log().commit(position, length);
+    }
+}
+
+/**
+ * @brief 日志输出任务：周期性地把缓冲区内容写入串口，并上报新增的丢弃条数
+ */
+inline void async_log_task(void*) {
+    uint32_t reported = 0;
+    for (;;) {
+        async_log().drain(Serial);
+        uint32_t dropped = async_log().dropped();
+        if (dropped != reported) {
+            Serial.printf("[LOG] %u message(s) dropped, buffer full\r\n", (unsigned)(dropped - reported));
+            reported = dropped;
+        }
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+/**
+ * @brief 启动日志输出任务，应在Serial.begin()之后尽早调用；启动前产生的日志会暂存在缓冲区中
+ */
+inline void async_log_begin() {
+    xTaskCreatePinnedToCore(async_log_task, "log", LOG_TASK_STACK_SIZE, nullptr, LOG_TASK_PRIORITY, nullptr, LOG_TASK_CORE);
+}
+
+#endif // ASYNC_LOG_H
@@ -0,0 +1,200 @@
+// BatchCommand.h
+// 批量命令（场景）：一条消息携带多个设备命令，在执行任务的一轮中依次执行，并汇总为一条回执
+// 网络任务解析出BatchRequest后交给执行任务；汇总回执由网络任务发布，发布后调用batch_release()
+// 命令Topic: smarthome/{NODE_ID}/batch/command
+// 回执Topic: smarthome/{NODE_ID}/batch/state
+#ifndef BATCH_COMMAND_H
+#define BATCH_COMMAND_H
+
+#include <Arduino.h>
+
+#define BATCH_DEVICE_ID     "batch"   // 批量命令Topic中的设备段
+#define BATCH_MAX_ENTRIES   16        // 单条批量命令最多包含的设备命令数
+#define BATCH_NAME_MAX_LEN  32        // 回执中房间ID/设备ID的最大长度(含结束符)
+
+// 批量命令中的单个条目
+struct BatchEntry {
+    char room_id[BATCH_NAME_MAX_LEN];
+    char device_id[BATCH_NAME_MAX_LEN];
+    int8_t device;            // 设备下标（devices[]），不是本节点设备时为-1
+    CommandAction action;
+    CommandResult result;     // ACK_DEFERRED表示舵机仍在运动，结束后由batch_servo_done()更新
+};
+
+// 批量命令执行上下文，同一时间只处理一条批量命令
+struct BatchContext {
+    bool active;              // 批量命令是否尚未完成（等待舵机结束或汇总回执尚未发布），原子访问
+    uint8_t count;            // 条目数
+    uint8_t pending;          // 尚未结束的舵机条目数
+    char correlation_id[CORRELATION_ID_MAX_LEN];
+    BatchEntry entries[BATCH_MAX_ENTRIES];
+};
+
+BatchContext batch_context;
+
+// 网络任务解析出的批量命令条目，字段为空字符串表示命令中缺失该字段
+// 房间ID和设备ID由网络任务解析为设备下标和设备类型编号（batch_resolve_entry()），执行任务不再查找字符串
+struct BatchRequestEntry {
+    char room_id[BATCH_NAME_MAX_LEN];
+    char device_id[BATCH_NAME_MAX_LEN];
+    char action[BATCH_NAME_MAX_LEN];
+    int value;
+    int8_t device;            // 设备下标（devices[]），不是本节点设备时为-1
+    DeviceType type;          // 设备类型编号，用于区分未知设备类型与不在本节点的设备
+};
+
+// 网络任务与执行任务之间交接的批量命令，命令队列中只传递“有批量命令待执行”的通知
+struct BatchRequest {
+    bool pending;             // 网络任务写满后置位，执行任务执行完条目后清除，原子访问
+    uint8_t count;
+    char correlation_id[CORRELATION_ID_MAX_LEN];
+    BatchRequestEntry entries[BATCH_MAX_ENTRIES];
+};
+
+BatchRequest batch_request;
+
+/**
+ * @brief (网络任务) 获取批量命令交接缓冲区
+ * @return nullptr表示上一条批量命令尚未被执行任务取走
+ */
+BatchRequest* batch_request_acquire() {
+    if (__atomic_load_n(&batch_request.pending, __ATOMIC_ACQUIRE)) {
+        return nullptr;
+    }
+    batch_request.count = 0;
+    return &batch_request;
+}
+
+/**
+ * @brief (网络任务) 把条目的房间ID和设备ID解析为设备下标和设备类型编号，需在填写字符串字段后调用
+ */
+void batch_resolve_entry(BatchRequestEntry& entry) {
+    const DeviceRoute* route = find_device_route(entry.room_id, entry.device_id);
+    entry.device = route != nullptr ? (int8_t)(route->handle - device_handles) : -1;
+    entry.type = intern_device_type(entry.device_id);
+}
+
+/**
+ * @brief (网络任务) 批量命令填写完成，交给执行任务
+ */
+void batch_request_submit() {
+    __atomic_store_n(&batch_request.pending, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief (执行任务) 已执行完全部条目，交接缓冲区可被下一条批量命令使用
+ */
+void batch_request_done() {
+    __atomic_store_n(&batch_request.pending, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 开始一条新的批量命令
+ * @param correlation_id 批量命令的关联ID，所有条目共用
+ * @return true表示已开始，false表示上一条批量命令仍有舵机在运动或汇总回执尚未发布
+ */
+bool batch_begin(const char* correlation_id) {
+    if (__atomic_load_n(&batch_context.active, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    batch_context.active = true;
+    batch_context.count = 0;
+    batch_context.pending = 0;
+    strncpy(batch_context.correlation_id, correlation_id, CORRELATION_ID_MAX_LEN - 1);
+    batch_context.correlation_id[CORRELATION_ID_MAX_LEN - 1] = '\0';
+    return true;
+}
+
+/**
+ * @brief (私有辅助函数) 复制名称，超长时截断
+ */
+void batch_copy_name(char* dest, const char* src) {
+    strncpy(dest, src ? src : "", BATCH_NAME_MAX_LEN - 1);
+    dest[BATCH_NAME_MAX_LEN - 1] = '\0';
+}
+
+/**
+ * @brief 执行批量命令中的一个条目，复用单设备命令的路由表和处理函数
+ * @param request 网络任务解析出的条目（设备下标已由batch_resolve_entry()查好）
+ * @return 条目执行结果
+ */
+const CommandResult& batch_execute_entry(const BatchRequestEntry& request) {
+    BatchEntry& entry = batch_context.entries[batch_context.count++];
+    batch_copy_name(entry.room_id, request.room_id);
+    batch_copy_name(entry.device_id, request.device_id);
+    entry.device = request.device;
+    entry.action = request.action[0] ? parse_action(request.action) : ACTION_UNKNOWN;
+
+    if (!request.room_id[0] || !request.device_id[0] || !request.action[0]) {
+        entry.result = command_error("MISSING_REQUIRED_FIELDS", "Missing required fields: room, device or action");
+        return entry.result;
+    }
+
+    const DeviceRoute* route = device_route(request.device);
+    DeviceHandler handler = route != nullptr ? route->handler : lookup_device_handler(request.type);
+    if (handler == nullptr) {
+        entry.result = command_error("UNKNOWN_DEVICE_TYPE", "Device type not supported");
+    } else if (route == nullptr) {
+        entry.result = command_device_not_found();
+    } else {
+        // 舵机序列以批量命令的关联ID启动，多个舵机在同一轮中开始运动
+        entry.result = handler(*route->handle, entry.action, request.value, batch_context.correlation_id);
+        if (entry.result.kind == ACK_DEFERRED) {
+            batch_context.pending++;
+        }
+    }
+    return entry.result;
+}
+
+/**
+ * @brief 所有条目执行完毕后调用
+ * @return true表示可以发布汇总回执，false表示需等待舵机运动结束
+ */
+bool batch_end() {
+    return batch_context.pending == 0;
+}
+
+/**
+ * @brief 汇总回执发布后调用，之后才允许开始下一条批量命令，避免发布过程中batch_context被覆盖
+ */
+void batch_release() {
+    __atomic_store_n(&batch_context.active, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief (网络任务) batch_context是否仍保存着该批量命令已发布的汇总回执，用于重放重复的批量命令
+ * 执行任务只在网络任务提交下一条批量命令后才改写batch_context，因此网络任务检查后直接发布不会读到被覆盖的内容
+ * @param correlation_id 批量命令的关联ID
+ * @return true表示可以用batch_context重放汇总回执
+ */
+bool batch_replayable(const char* correlation_id) {
+    return !__atomic_load_n(&batch_request.pending, __ATOMIC_ACQUIRE) &&
+           !__atomic_load_n(&batch_context.active, __ATOMIC_ACQUIRE) &&
+           strcmp(batch_context.correlation_id, correlation_id) == 0;
+}
+
+/**
+ * @brief 舵机运动序列结束时调用，更新属于当前批量命令的条目
+ * @param device 设备下标（devices[]）
+ * @param correlation_id 序列启动时的关联ID
+ * @param batch_done 输出：该条目是否为最后一个未结束的条目
+ * @return true表示该舵机属于当前批量命令（不应再单独发布回执）
+ */
+bool batch_servo_done(int device, const char* correlation_id, bool* batch_done) {
+    *batch_done = false;
+    if (batch_context.pending == 0 || strcmp(correlation_id, batch_context.correlation_id) != 0) {
+        return false;
+    }
+    for (int i = 0; i < batch_context.count; i++) {
+        BatchEntry& entry = batch_context.entries[i];
+        if (entry.result.kind == ACK_DEFERRED && entry.device == device) {
+            entry.result = command_ok();
+            batch_context.pending--;
+            *batch_done = batch_end();
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // BATCH_COMMAND_H
@@ -0,0 +1,258 @@
+// CommandDispatch.h
+// 命令分发层：按设备类型编号索引的分发表与类型化的动作枚举
+// 设备类型在加载设备表时已转换为编号（core/Symbols.h），命令路径按编号直接跳转到处理函数
+#ifndef COMMAND_DISPATCH_H
+#define COMMAND_DISPATCH_H
+
+#include <Arduino.h>
+#include "Symbols.h"
+
+// =================== 动作枚举 ===================
+enum CommandAction : uint8_t {
+    ACTION_ON,
+    ACTION_OFF,
+    ACTION_SET_TEMP,
+    ACTION_READ,
+    ACTION_READ_ALL,
+    ACTION_UNKNOWN
+};
+
+/**
+ * @brief 将动作字符串转换为动作枚举
+ * @param action 动作字符串，如"ON"
+ * @return 动作枚举，无法识别时返回ACTION_UNKNOWN
+ */
+CommandAction parse_action(const char* action) {
+    switch (hash_string(action)) {
+        case fnv1a_hash("ON"):       return strcmp(action, "ON") == 0 ? ACTION_ON : ACTION_UNKNOWN;
+        case fnv1a_hash("OFF"):      return strcmp(action, "OFF") == 0 ? ACTION_OFF : ACTION_UNKNOWN;
+        case fnv1a_hash("SET_TEMP"): return strcmp(action, "SET_TEMP") == 0 ? ACTION_SET_TEMP : ACTION_UNKNOWN;
+        case fnv1a_hash("READ"):     return strcmp(action, "READ") == 0 ? ACTION_READ : ACTION_UNKNOWN;
+        case fnv1a_hash("READ_ALL"): return strcmp(action, "READ_ALL") == 0 ? ACTION_READ_ALL : ACTION_UNKNOWN;
+        default:                     return ACTION_UNKNOWN;
+    }
+}
+
+/**
+ * @brief 将动作枚举转换回动作字符串，用于回执中的state字段
+ * @param action 动作枚举
+ * @return 动作字符串，ACTION_UNKNOWN返回"UNKNOWN"
+ */
+const char* action_name(CommandAction action) {
+    switch (action) {
+        case ACTION_ON:       return "ON";
+        case ACTION_OFF:      return "OFF";
+        case ACTION_SET_TEMP: return "SET_TEMP";
+        case ACTION_READ:     return "READ";
+        case ACTION_READ_ALL: return "READ_ALL";
+        default:              return "UNKNOWN";
+    }
+}
+
+// =================== 处理结果 ===================
+// 回执类型，决定使用哪个publish_*函数发布回执
+enum AckKind : uint8_t {
+    ACK_STATE,      // 标准状态回执 publish_state()
+    ACK_SENSOR,     // 传感器读数回执 publish_sensor_state()
+    ACK_AC,         // 空调温度回执 publish_ac_state()
+    ACK_ERROR,      // 错误回执 publish_error_state()
+    ACK_SNAPSHOT,   // 传感器快照回执 publish_sensor_snapshot()
+    ACK_DEFERRED    // 回执延后，由舵机运动引擎在序列结束后发布
+};
+
+// 设备处理函数的执行结果
+struct CommandResult {
+    AckKind kind;
+    float value;                // 传感器读数、空调温度，或快照的房间索引（ACK_SNAPSHOT，-1表示全部房间）
+    const char* unit;           // 传感器单位
+    const char* error_code;     // 错误代码（仅ACK_ERROR）
+    const char* error_message;  // 错误描述（仅ACK_ERROR）
+};
+
+inline CommandResult command_ok()                                 { return { ACK_STATE, 0, nullptr, nullptr, nullptr }; }
+inline CommandResult command_deferred()                           { return { ACK_DEFERRED, 0, nullptr, nullptr, nullptr }; }
+inline CommandResult command_sensor(float value, const char* unit) { return { ACK_SENSOR, value, unit, nullptr, nullptr }; }
+inline CommandResult command_ac(int temperature)                  { return { ACK_AC, (float)temperature, nullptr, nullptr, nullptr }; }
+inline CommandResult command_snapshot(int room_index)             { return { ACK_SNAPSHOT, (float)room_index, nullptr, nullptr, nullptr }; }
+inline CommandResult command_error(const char* code, const char* message) { return { ACK_ERROR, 0, nullptr, code, message }; }
+
+inline CommandResult command_device_not_found() {
+    return command_error("DEVICE_NOT_FOUND", "Device not found in this node's configuration");
+}
+
+inline CommandResult command_unknown_action() {
+    return command_error("UNKNOWN_ACTION", "Unsupported action for this device type");
+}
+
+// 设备处理函数：执行命令并返回结果，回执由调用方统一发布
+typedef CommandResult (*DeviceHandler)(const DeviceHandle& handle, CommandAction action, int value, const char* correlation_id);
+
+// =================== 设备处理函数 ===================
+/**
+ * @brief (私有辅助函数) 开关类设备的通用处理：校验动作并调用对应的HAL函数
+ * @param control HAL控制函数
+ * @param handle 设备句柄
+ * @param action 动作
+ * @return 处理结果
+ */
+CommandResult handle_switch(bool (*control)(const DeviceHandle&, bool), const DeviceHandle& handle, CommandAction action) {
+    if (action != ACTION_ON && action != ACTION_OFF) {
+        return command_unknown_action();
+    }
+    return control(handle, action == ACTION_ON) ? command_ok() : command_device_not_found();
+}
+
+/**
+ * @brief (私有辅助函数) 将舵机命令结果转换为处理结果
+ * @param servo_result 舵机命令执行结果
+ * @return 处理结果
+ */
+CommandResult servo_command_result(ServoCommandResult servo_result) {
+    switch (servo_result) {
+        case SERVO_CMD_DONE:    return command_ok();
+        case SERVO_CMD_STARTED: return command_deferred();
+        case SERVO_CMD_BUSY:    return command_error("DEVICE_BUSY", "Servo is still executing the previous command");
+        default:                return command_device_not_found();
+    }
+}
+
+/**
+ * @brief (私有辅助函数) 将传感器读数转换为处理结果
+ * @param value 读数，-999.0表示读取失败
+ * @param unit 单位
+ * @param error_message 读取失败时的错误描述
+ * @return 处理结果
+ */
+CommandResult sensor_command_result(float value, const char* unit, const char* error_message) {
+    if (value == -999.0) {
+        return command_error("SENSOR_READ_ERROR", error_message);
+    }
+    return command_sensor(value, unit);
+}
+
+CommandResult handle_light(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    return handle_switch(control_light, handle, action);
+}
+
+CommandResult handle_bedside_light(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    return handle_switch(control_bedside_light, handle, action);
+}
+
+CommandResult handle_hood(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    return handle_switch(control_hood, handle, action);
+}
+
+CommandResult handle_fan(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    return handle_switch(control_fan, handle, action);
+}
+
+CommandResult handle_ac(const DeviceHandle& handle, CommandAction action, int value, const char* /*correlation_id*/) {
+    switch (action) {
+        case ACTION_SET_TEMP: {
+            // SET_TEMP操作：必须提供有效温度值
+            if (value < 0 || value > 40) {
+                return command_error("INVALID_TEMPERATURE", "Temperature value invalid. Valid range: 0-40°C");
+            }
+            if (!control_ac_set_temperature(handle, value)) {
+                return command_device_not_found();
+            }
+            // 空调温度设置操作需要特殊回执，包含温度信息
+            AirConditionerState* state = get_ac_state(handle.room_index);
+            return state != nullptr ? command_ac(state->target_temperature) : command_ok();
+        }
+        case ACTION_ON:
+            // ON操作：必须提供有效温度值
+            if (value < 0 || value > 40) {
+                return command_error("MISSING_OR_INVALID_VALUE", "ON operation requires valid temperature value (0-40°C)");
+            }
+            return control_ac(handle, true, value) ? command_ok() : command_device_not_found();
+        case ACTION_OFF:
+            // OFF操作：不需要温度值
+            return control_ac(handle, false, 0) ? command_ok() : command_device_not_found();
+        default:
+            return command_error("UNKNOWN_ACTION", "Unsupported action for AC device");
+    }
+}
+
+CommandResult handle_window(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* correlation_id) {
+    if (action != ACTION_ON && action != ACTION_OFF) {
+        return command_unknown_action();
+    }
+    return servo_command_result(control_window(handle, action == ACTION_ON, correlation_id));
+}
+
+CommandResult handle_curtain(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* correlation_id) {
+    if (action != ACTION_ON && action != ACTION_OFF) {
+        return command_unknown_action();
+    }
+    return servo_command_result(control_curtain(handle, action == ACTION_ON, correlation_id));
+}
+
+CommandResult handle_temp_sensor(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    if (action != ACTION_READ) {
+        return command_unknown_action();
+    }
+    return sensor_command_result(control_temperature_sensor(handle), "°C", "Temperature sensor read failed");
+}
+
+CommandResult handle_humidity_sensor(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    if (action != ACTION_READ) {
+        return command_unknown_action();
+    }
+    return sensor_command_result(control_humidity_sensor(handle), "%", "Humidity sensor read failed");
+}
+
+CommandResult handle_brightness_sensor(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    if (action != ACTION_READ) {
+        return command_unknown_action();
+    }
+    return sensor_command_result(control_brightness_sensor(handle), "%", "Brightness sensor read failed");
+}
+
+CommandResult handle_smoke_sensor(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    if (action != ACTION_READ) {
+        return command_unknown_action();
+    }
+    return sensor_command_result(control_smoke_sensor(handle), "", "Smoke sensor read failed");
+}
+
+CommandResult handle_gas_sensor(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    if (action != ACTION_READ) {
+        return command_unknown_action();
+    }
+    return sensor_command_result(control_gas_sensor(handle), "", "Gas sensor read failed");
+}
+
+CommandResult handle_sensors(const DeviceHandle& handle, CommandAction action, int /*value*/, const char* /*correlation_id*/) {
+    // 房间级传感器快照：一次返回该房间的全部传感器数据
+    if (action != ACTION_READ_ALL) {
+        return command_unknown_action();
+    }
+    if (handle.room_index == -1) {
+        return command_error("UNKNOWN_ROOM", "Unknown room for sensor snapshot");
+    }
+    return command_snapshot(handle.room_index);
+}
+
+// =================== 分发表 ===================
+// 分发表由节点配置中的NODE_DEVICE_TYPES(X)生成：每个设备类型展开为一个case，
+// 设备类型编号连续，该switch编译为按编号索引的跳转表
+#define DISPATCH_CASE(type) \
+    case DEVICE_TYPE_##type: return handle_##type;
+
+/**
+ * @brief 根据设备类型编号查找处理函数
+ * @param type 设备类型编号（intern_device_type()的结果）
+ * @return 处理函数，本节点不支持该类型时返回nullptr
+ */
+DeviceHandler lookup_device_handler(DeviceType type) {
+    switch (type) {
+        NODE_DEVICE_TYPES(DISPATCH_CASE)
+        default:
+            return nullptr;
+    }
+}
+
+#undef DISPATCH_CASE
+
+#endif // COMMAND_DISPATCH_H
@@ -0,0 +1,601 @@
+// CommandParser.h
+// 单设备命令的原地解析器：命令只读取action、value、correlation_id三个字段，
+// 直接在PubSubClient的payload缓冲区上分词，字符串原地补结束符后以视图返回，不复制、不分配内存
+// 支持JSON与MessagePack两种格式（按首字节识别），一次遍历同时完成格式校验
+// 与ArduinoJson反序列化的耗时对比见主机构建的native/bench/trace_replay.cpp（bench_parsers()，需以pio run -e native链接真实的ArduinoJson）
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <Arduino.h>
+
+#define COMMAND_MAX_NESTING  8     // JSON命令允许的最大嵌套层数（MessagePack按元素计数跳过，不递归）
+
+/**
+ * @brief 指向payload缓冲区内部的字符串视图，data已原地以'\0'结尾，可直接作为C字符串使用
+ */
+struct StringView {
+    const char* data;   // nullptr表示字段缺失或类型不是字符串
+    uint16_t length;
+};
+
+enum CommandParseStatus : uint8_t {
+    COMMAND_PARSE_OK = 0,
+    COMMAND_PARSE_MALFORMED,    // 格式错误（JSON/MessagePack语法错误、顶层不是对象、嵌套过深等）
+    COMMAND_PARSE_TOO_LARGE     // 超过COMMAND_MAX_PAYLOAD_LEN
+};
+
+/**
+ * @brief 解析结果。字段缺失不视为格式错误，由调用方据此回复MISSING_REQUIRED_FIELDS
+ */
+struct ParsedCommand {
+    StringView action;
+    StringView correlation_id;
+    int value;          // 缺失、null或非数值时为0，小数截断为整数（与原ArduinoJson路径的 doc["value"] | 0 一致）
+
+    bool has_required_fields() const {
+        return action.data != nullptr && correlation_id.data != nullptr;
+    }
+};
+
+class CommandParser {
+public:
+    CommandParser(byte* payload, unsigned int length) : p_(payload), end_(payload + length) {}
+
+    /**
+     * @brief 解析JSON命令
+     * @param command 输出结果
+     * @return true表示格式正确
+     */
+    bool parse_json(ParsedCommand& command) {
+        command_ = &command;
+        skip_whitespace();
+        if (p_ == end_ || *p_ != '{' || !json_object(0)) {
+            return false;
+        }
+        // 对象之后只允许空白（部分客户端会多发送一个'\0'）
+        while (p_ < end_ && (is_whitespace(*p_) || *p_ == '\0')) {
+            p_++;
+        }
+        return p_ == end_;
+    }
+
+    /**
+     * @brief 解析MessagePack命令
+     * @param command 输出结果
+     * @return true表示格式正确
+     */
+    bool parse_msgpack(ParsedCommand& command) {
+        command_ = &command;
+        MsgPackItem map;
+        if (!msgpack_read(map) || map.type != MSGPACK_MAP) {
+            return false;
+        }
+        for (uint32_t i = 0; i < map.count; i++) {
+            MsgPackItem key, item;
+            if (!msgpack_read(key)) {
+                return false;
+            }
+            CommandField field = key.type == MSGPACK_STR ? match_field((const char*)key.data, key.count) : FIELD_NONE;
+            if (!msgpack_read(item)) {
+                return false;
+            }
+            if (item.type == MSGPACK_MAP || item.type == MSGPACK_ARRAY) {
+                if (!msgpack_skip_children(item)) {
+                    return false;
+                }
+            } else if (field != FIELD_NONE) {
+                store_msgpack_field(field, item);
+            }
+        }
+        return p_ == end_;
+    }
+
+private:
+    enum CommandField : uint8_t { FIELD_NONE, FIELD_ACTION, FIELD_VALUE, FIELD_CORRELATION_ID };
+
+    enum MsgPackType : uint8_t {
+        MSGPACK_NIL, MSGPACK_BOOL, MSGPACK_INT, MSGPACK_UINT, MSGPACK_FLOAT,
+        MSGPACK_STR, MSGPACK_BIN, MSGPACK_ARRAY, MSGPACK_MAP
+    };
+
+    struct MsgPackItem {
+        MsgPackType type;
+        uint32_t count;     // 字符串/二进制长度，数组/映射元素个数
+        byte* header;       // 类型字节的位置（字符串原地结尾时使用）
+        byte* data;         // 字符串/二进制内容
+        int64_t i;
+        uint64_t u;
+        double f;
+    };
+
+    byte* p_;
+    byte* end_;
+    ParsedCommand* command_;
+
+    static bool is_whitespace(byte c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static CommandField match_field(const char* key, size_t length) {
+        if (length == 6 && memcmp(key, "action", 6) == 0) return FIELD_ACTION;
+        if (length == 5 && memcmp(key, "value", 5) == 0) return FIELD_VALUE;
+        if (length == 14 && memcmp(key, "correlation_id", 14) == 0) return FIELD_CORRELATION_ID;
+        return FIELD_NONE;
+    }
+
+    // 数值转换为int：超出int范围时为0，与ArduinoJson的as<int>()一致
+    static int number_to_int(double v) {
+        if (v != v || v < (double)INT32_MIN || v > (double)INT32_MAX) {
+            return 0;
+        }
+        return (int)v;
+    }
+
+    void store_string(CommandField field, char* data, size_t length) {
+        StringView view = { data, (uint16_t)length };
+        if (field == FIELD_ACTION) {
+            command_->action = view;
+        } else if (field == FIELD_CORRELATION_ID) {
+            command_->correlation_id = view;
+        }
+    }
+
+    // =================== JSON ===================
+    void skip_whitespace() {
+        while (p_ < end_ && is_whitespace(*p_)) {
+            p_++;
+        }
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (p_ < end_ && *p_ == c) {
+            p_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool json_literal(const char* literal, size_t length) {
+        if ((size_t)(end_ - p_) < length || memcmp(p_, literal, length) != 0) {
+            return false;
+        }
+        p_ += length;
+        return true;
+    }
+
+    bool json_value(uint8_t depth, CommandField field) {
+        skip_whitespace();
+        if (p_ == end_) {
+            return false;
+        }
+        switch (*p_) {
+            case '{':
+                return json_object(depth + 1);
+            case '[':
+                return json_array(depth + 1);
+            case '"': {
+                char* data;
+                size_t length;
+                if (!json_string(&data, &length)) {
+                    return false;
+                }
+                store_string(field, data, length);
+                return true;
+            }
+            case 't':
+                return json_literal("true", 4);
+            case 'f':
+                return json_literal("false", 5);
+            case 'n':
+                return json_literal("null", 4);
+            default: {
+                double number;
+                if (!json_number(&number)) {
+                    return false;
+                }
+                if (field == FIELD_VALUE) {
+                    command_->value = number_to_int(number);
+                }
+                return true;
+            }
+        }
+    }
+
+    // 当前位置为'{'，depth为0时是命令顶层对象
+    bool json_object(uint8_t depth) {
+        if (depth >= COMMAND_MAX_NESTING) {
+            return false;
+        }
+        p_++;
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            skip_whitespace();
+            char* key;
+            size_t key_length;
+            if (p_ == end_ || *p_ != '"' || !json_string(&key, &key_length) || !consume(':')) {
+                return false;
+            }
+            CommandField field = depth == 0 ? match_field(key, key_length) : FIELD_NONE;
+            if (!json_value(depth, field)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool json_array(uint8_t depth) {
+        if (depth >= COMMAND_MAX_NESTING) {
+            return false;
+        }
+        p_++;
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!json_value(depth, FIELD_NONE)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    static int hex_digit(byte c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool json_hex4(uint32_t* code) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) {
+            int d = hex_digit(p_[i]);
+            if (d < 0) {
+                return false;
+            }
+            v = (v << 4) | (uint32_t)d;
+        }
+        p_ += 4;
+        *code = v;
+        return true;
+    }
+
+    static byte* write_utf8(byte* out, uint32_t code) {
+        if (code < 0x80) {
+            *out++ = (byte)code;
+        } else if (code < 0x800) {
+            *out++ = (byte)(0xC0 | (code >> 6));
+            *out++ = (byte)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            *out++ = (byte)(0xE0 | (code >> 12));
+            *out++ = (byte)(0x80 | ((code >> 6) & 0x3F));
+            *out++ = (byte)(0x80 | (code & 0x3F));
+        } else {
+            *out++ = (byte)(0xF0 | (code >> 18));
+            *out++ = (byte)(0x80 | ((code >> 12) & 0x3F));
+            *out++ = (byte)(0x80 | ((code >> 6) & 0x3F));
+            *out++ = (byte)(0x80 | (code & 0x3F));
+        }
+        return out;
+    }
+
+    /**
+     * @brief 当前位置为'"'。转义序列原地还原（还原后不会比原文更长），
+     * 并用'\0'覆盖结束引号或其之前的字节，得到可直接使用的C字符串
+     */
+    bool json_string(char** data, size_t* length) {
+        byte* start = ++p_;
+        byte* out = start;
+        while (p_ < end_) {
+            byte c = *p_++;
+            if (c == '"') {
+                *out = '\0';
+                *data = (char*)start;
+                *length = out - start;
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                *out++ = c;
+                continue;
+            }
+            if (p_ == end_) {
+                return false;
+            }
+            c = *p_++;
+            switch (c) {
+                case '"': case '\\': case '/': *out++ = c; break;
+                case 'b': *out++ = '\b'; break;
+                case 'f': *out++ = '\f'; break;
+                case 'n': *out++ = '\n'; break;
+                case 'r': *out++ = '\r'; break;
+                case 't': *out++ = '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!json_hex4(&code)) {
+                        return false;
+                    }
+                    // UTF-16代理对（非BMP字符）由两个连续的转义序列组成
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        uint32_t low;
+                        if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                            return false;
+                        }
+                        p_ += 2;
+                        if (!json_hex4(&low) || low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (code >= 0xDC00 && code < 0xE000) {
+                        return false;
+                    }
+                    out = write_utf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool json_digits(double* v, int* count) {
+        *count = 0;
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+            *v = *v * 10 + (*p_ - '0');
+            p_++;
+            (*count)++;
+        }
+        return *count > 0;
+    }
+
+    // 严格按JSON数值语法解析：-?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool json_number(double* number) {
+        bool negative = p_ < end_ && *p_ == '-';
+        if (negative) {
+            p_++;
+        }
+        if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+            return false;
+        }
+        double v = 0;
+        int digits;
+        if (*p_ == '0') {
+            p_++;
+        } else {
+            json_digits(&v, &digits);
+        }
+        int exponent = 0;
+        if (p_ < end_ && *p_ == '.') {
+            p_++;
+            double fraction = 0;
+            if (!json_digits(&fraction, &digits)) {
+                return false;
+            }
+            v += fraction * pow(10, -digits);
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            p_++;
+            bool negative_exponent = false;
+            if (p_ < end_ && (*p_ == '+' || *p_ == '-')) {
+                negative_exponent = *p_ == '-';
+                p_++;
+            }
+            double e = 0;
+            if (!json_digits(&e, &digits)) {
+                return false;
+            }
+            exponent = e > 400 ? 400 : (int)e;
+            if (negative_exponent) {
+                exponent = -exponent;
+            }
+        }
+        if (exponent != 0) {
+            v *= pow(10, exponent);
+        }
+        *number = negative ? -v : v;
+        return true;
+    }
+
+    // =================== MessagePack ===================
+    bool msgpack_bytes(size_t n) {
+        return (size_t)(end_ - p_) >= n;
+    }
+
+    uint64_t msgpack_be(size_t n) {
+        uint64_t v = 0;
+        for (size_t i = 0; i < n; i++) {
+            v = (v << 8) | *p_++;
+        }
+        return v;
+    }
+
+    // 读取一个元素的类型头；标量和字符串连同内容一起跳过，数组/映射只读取头部
+    bool msgpack_read(MsgPackItem& item) {
+        if (p_ == end_) {
+            return false;
+        }
+        item.header = p_;
+        byte c = *p_++;
+        size_t length_size = 0;     // 字符串/二进制/扩展类型的长度字段字节数
+        size_t fixed_size = 0;      // 定长扩展类型的内容字节数
+
+        if (c <= 0x7F) {
+            item.type = MSGPACK_UINT; item.u = c; return true;
+        }
+        if (c >= 0xE0) {
+            item.type = MSGPACK_INT; item.i = (int8_t)c; return true;
+        }
+        if (c <= 0x8F) {
+            item.type = MSGPACK_MAP; item.count = c & 0x0F; return true;
+        }
+        if (c <= 0x9F) {
+            item.type = MSGPACK_ARRAY; item.count = c & 0x0F; return true;
+        }
+        if (c <= 0xBF) {
+            item.type = MSGPACK_STR; item.count = c & 0x1F;
+        } else {
+            switch (c) {
+                case 0xC0: item.type = MSGPACK_NIL; return true;
+                case 0xC2: case 0xC3: item.type = MSGPACK_BOOL; item.u = c & 1; return true;
+                case 0xC4: case 0xC5: case 0xC6:
+                    item.type = MSGPACK_BIN; length_size = 1 << (c - 0xC4); break;
+                case 0xC7: case 0xC8: case 0xC9:
+                    item.type = MSGPACK_BIN; length_size = 1 << (c - 0xC7); fixed_size = 1; break;
+                case 0xCA: case 0xCB: {
+                    size_t n = c == 0xCA ? 4 : 8;
+                    if (!msgpack_bytes(n)) return false;
+                    uint64_t bits = msgpack_be(n);
+                    item.type = MSGPACK_FLOAT;
+                    if (n == 4) {
+                        uint32_t bits32 = (uint32_t)bits;
+                        float f;
+                        memcpy(&f, &bits32, sizeof(f));
+                        item.f = f;
+                    } else {
+                        memcpy(&item.f, &bits, sizeof(item.f));
+                    }
+                    return true;
+                }
+                case 0xCC: case 0xCD: case 0xCE: case 0xCF: {
+                    size_t n = (size_t)1 << (c - 0xCC);
+                    if (!msgpack_bytes(n)) return false;
+                    item.type = MSGPACK_UINT; item.u = msgpack_be(n);
+                    return true;
+                }
+                case 0xD0: case 0xD1: case 0xD2: case 0xD3: {
+                    size_t n = (size_t)1 << (c - 0xD0);
+                    if (!msgpack_bytes(n)) return false;
+                    uint64_t raw = msgpack_be(n);
+                    // 按位宽做符号扩展
+                    int shift = 64 - (int)n * 8;
+                    item.type = MSGPACK_INT; item.i = (int64_t)(raw << shift) >> shift;
+                    return true;
+                }
+                case 0xD4: case 0xD5: case 0xD6: case 0xD7: case 0xD8:
+                    item.type = MSGPACK_BIN; fixed_size = 1 + ((size_t)1 << (c - 0xD4)); break;
+                case 0xD9: case 0xDA: case 0xDB:
+                    item.type = MSGPACK_STR; length_size = 1 << (c - 0xD9); break;
+                case 0xDC: case 0xDD: case 0xDE: case 0xDF: {
+                    size_t n = (c & 1) ? 4 : 2;
+                    if (!msgpack_bytes(n)) return false;
+                    item.type = c <= 0xDD ? MSGPACK_ARRAY : MSGPACK_MAP;
+                    item.count = (uint32_t)msgpack_be(n);
+                    return true;
+                }
+                default:
+                    return false;   // 0xC1未定义
+            }
+        }
+
+        if (length_size > 0) {
+            if (!msgpack_bytes(length_size)) return false;
+            item.count = (uint32_t)msgpack_be(length_size);
+        } else if (item.type == MSGPACK_BIN) {
+            item.count = 0;
+        }
+        size_t skip = item.count + fixed_size;
+        if (!msgpack_bytes(skip)) {
+            return false;
+        }
+        item.data = p_;
+        p_ += skip;
+        return true;
+    }
+
+    // 跳过数组/映射的全部子元素：用待读元素计数代替递归，每个元素至少占1字节，计数超过剩余字节即为格式错误
+    bool msgpack_skip_children(const MsgPackItem& container) {
+        uint64_t remaining = container.type == MSGPACK_MAP ? (uint64_t)container.count * 2 : container.count;
+        while (remaining > 0) {
+            if (remaining > (uint64_t)(end_ - p_)) {
+                return false;
+            }
+            MsgPackItem item;
+            if (!msgpack_read(item)) {
+                return false;
+            }
+            remaining--;
+            if (item.type == MSGPACK_MAP) {
+                remaining += (uint64_t)item.count * 2;
+            } else if (item.type == MSGPACK_ARRAY) {
+                remaining += item.count;
+            }
+        }
+        return true;
+    }
+
+    void store_msgpack_field(CommandField field, const MsgPackItem& item) {
+        if (field == FIELD_VALUE) {
+            if (item.type == MSGPACK_INT) {
+                command_->value = item.i < INT32_MIN || item.i > INT32_MAX ? 0 : (int)item.i;
+            } else if (item.type == MSGPACK_UINT) {
+                command_->value = item.u > INT32_MAX ? 0 : (int)item.u;
+            } else if (item.type == MSGPACK_FLOAT) {
+                command_->value = number_to_int(item.f);
+            }
+            return;
+        }
+        if (item.type != MSGPACK_STR) {
+            return;
+        }
+        // MessagePack字符串没有结束符：把内容前移到类型头的位置，空出的末字节写'\0'
+        char* data = (char*)item.header;
+        memmove(data, item.data, item.count);
+        data[item.count] = '\0';
+        store_string(field, data, item.count);
+    }
+};
+
+/**
+ * @brief 原地解析单设备命令，并将回执格式切换为命令所用的格式
+ * 解析过程中会修改payload缓冲区（字符串原地补结束符、还原转义）
+ * @param payload 消息内容（PubSubClient的接收缓冲区）
+ * @param length 消息长度
+ * @param command 输出结果，字符串视图指向payload内部，仅在本次回调内有效
+ * @return 解析状态
+ */
+CommandParseStatus parse_command(byte* payload, unsigned int length, ParsedCommand& command) {
+    command.action.data = nullptr;
+    command.action.length = 0;
+    command.correlation_id = command.action;
+    command.value = 0;
+
+    bool msgpack = is_msgpack_payload(payload, length);
+    payload_format = msgpack ? PAYLOAD_MSGPACK : PAYLOAD_JSON;
+    if (length > COMMAND_MAX_PAYLOAD_LEN) {
+        return COMMAND_PARSE_TOO_LARGE;
+    }
+
+    CommandParser parser(payload, length);
+    bool ok = msgpack ? parser.parse_msgpack(command) : parser.parse_json(command);
+    if (!ok) {
+        // 格式错误时不返回部分解析的字段
+        command.action.data = nullptr;
+        command.correlation_id.data = nullptr;
+        command.value = 0;
+        return COMMAND_PARSE_MALFORMED;
+    }
+    return COMMAND_PARSE_OK;
+}
+
+/**
+ * @brief 解析失败时的错误描述（错误代码仍为JSON_PARSE_ERROR，与上位机保持兼容）
+ * @param status 解析状态
+ * @return 错误描述
+ */
+const char* command_parse_error_message(CommandParseStatus status) {
+    if (status == COMMAND_PARSE_TOO_LARGE) {
+        return "Command payload too large";
+    }
+    return payload_format_error_message();
+}
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,151 @@
+// CommandScheduler.h
+// 命令调度：执行任务从命令队列取出的单设备命令先进入待执行表，按优先级执行，
+// 同一设备尚未执行的同类命令合并为最新的一条，被取代的命令回复SUPERSEDED；
+// 舵机仍在运动时，该设备的命令留在表中等待，而不是回复DEVICE_BUSY
+#ifndef COMMAND_SCHEDULER_H
+#define COMMAND_SCHEDULER_H
+
+#include <Arduino.h>
+
+// 命令队列中的消息类型
+enum CommandKind : uint8_t {
+    COMMAND_DEVICE,     // 单设备命令
+    COMMAND_BATCH       // 批量命令，条目在batch_request中
+};
+
+// 网络任务 -> 执行任务：已解析并通过路由表校验的命令
+struct CommandMessage {
+    CommandKind kind;
+    CommandAction action;
+    int value;
+    const DeviceRoute* route;       // 路由表启动后不再变化，可直接传递指针
+    unsigned long received_us;      // callback()收到命令的时间，用于统计排队与端到端延迟
+    char correlation_id[CORRELATION_ID_MAX_LEN];
+};
+
+// 优先级，数值越小越先执行
+enum CommandPriority : uint8_t {
+    PRIORITY_SAFETY,    // 安全动作：开启油烟机/排气扇（上位机在检测到烟雾或燃气时下发）
+    PRIORITY_CONTROL,   // 一般控制：开关、温度设置
+    PRIORITY_QUERY      // 查询：传感器读取、快照
+};
+
+/**
+ * @brief 根据设备类型和动作确定命令的优先级
+ * @param route 设备路由
+ * @param action 动作
+ * @return 优先级
+ */
+CommandPriority command_priority(const DeviceRoute& route, CommandAction action) {
+    if (action == ACTION_READ || action == ACTION_READ_ALL) {
+        return PRIORITY_QUERY;
+    }
+    if (action == ACTION_ON && (route.handler == handle_hood || route.handler == handle_fan)) {
+        return PRIORITY_SAFETY;
+    }
+    return PRIORITY_CONTROL;
+}
+
+/**
+ * @brief 两条命令是否设置同一目标状态，后者可取代前者
+ * 开关类动作（ON/OFF）互相取代，SET_TEMP只取代SET_TEMP；查询不合并，每条都需要读数回执
+ */
+bool command_supersedes(const CommandMessage& newer, const CommandMessage& older) {
+    if (newer.route != older.route) {
+        return false;
+    }
+    bool newer_switch = newer.action == ACTION_ON || newer.action == ACTION_OFF;
+    bool older_switch = older.action == ACTION_ON || older.action == ACTION_OFF;
+    if (newer_switch || older_switch) {
+        return newer_switch && older_switch;
+    }
+    return newer.action == ACTION_SET_TEMP && older.action == ACTION_SET_TEMP;
+}
+
+// 提交命令的结果
+enum ScheduleStatus : uint8_t {
+    SCHEDULE_QUEUED,        // 已加入待执行表
+    SCHEDULE_SUPERSEDED,    // 取代了同一设备尚未执行的旧命令
+    SCHEDULE_FULL           // 待执行表已满
+};
+
+/**
+ * @brief 待执行命令表（仅由执行任务访问）
+ * 表项很少（COMMAND_PENDING_MAX），按优先级和到达顺序线性扫描选出下一条命令
+ */
+class CommandScheduler {
+public:
+    CommandScheduler() : sequence_(0) {
+        memset(slots_, 0, sizeof(slots_));
+    }
+
+    /**
+     * @brief 提交一条单设备命令
+     * @param command 命令
+     * @param superseded 输出：被取代的旧命令（返回SCHEDULE_SUPERSEDED时有效）
+     * @return 提交结果
+     */
+    ScheduleStatus submit(const CommandMessage& command, CommandMessage* superseded) {
+        Slot* free_slot = nullptr;
+        for (int i = 0; i < COMMAND_PENDING_MAX; i++) {
+            Slot& slot = slots_[i];
+            if (!slot.used) {
+                if (free_slot == nullptr) {
+                    free_slot = &slot;
+                }
+            } else if (command_supersedes(command, slot.command)) {
+                // 保留原来的排队位置，只替换为最新的目标状态
+                *superseded = slot.command;
+                slot.command = command;
+                slot.priority = command_priority(*command.route, command.action);
+                return SCHEDULE_SUPERSEDED;
+            }
+        }
+        if (free_slot == nullptr) {
+            return SCHEDULE_FULL;
+        }
+        free_slot->command = command;
+        free_slot->priority = command_priority(*command.route, command.action);
+        free_slot->sequence = sequence_++;
+        free_slot->used = true;
+        return SCHEDULE_QUEUED;
+    }
+
+    /**
+     * @brief 取出下一条可执行的命令：优先级最高、到达最早，且设备不在运动中
+     * @param command 输出命令
+     * @return false表示没有可执行的命令
+     */
+    bool next(CommandMessage* command) {
+        Slot* best = nullptr;
+        for (int i = 0; i < COMMAND_PENDING_MAX; i++) {
+            Slot& slot = slots_[i];
+            if (!slot.used || is_device_busy(*slot.command.route->handle)) {
+                continue;
+            }
+            if (best == nullptr || slot.priority < best->priority ||
+                (slot.priority == best->priority && (int32_t)(slot.sequence - best->sequence) < 0)) {
+                best = &slot;
+            }
+        }
+        if (best == nullptr) {
+            return false;
+        }
+        *command = best->command;
+        best->used = false;
+        return true;
+    }
+
+private:
+    struct Slot {
+        CommandMessage command;
+        uint32_t sequence;      // 到达顺序
+        uint8_t priority;
+        bool used;
+    };
+
+    Slot slots_[COMMAND_PENDING_MAX];
+    uint32_t sequence_;
+};
+
+#endif // COMMAND_SCHEDULER_H
@@ -0,0 +1,136 @@
+// DedupeCache.h
+// 关联ID去重缓存：记录最近交给执行任务的单设备命令和批量命令及其回执，
+// MQTT重投或上位机重试导致同一correlation_id再次到达时，直接重放原回执，不再重复执行（如舵机动作）
+// 固定容量、不分配内存：表项按到达顺序循环复用（最早的先淘汰），另有哈希桶索引，查找为O(1)
+// 键为完整的关联ID，不截断：超过CORRELATION_ID_MAX_LEN - 1字节的关联ID由调用方先用fits()拒绝，
+// 否则前缀相同的两个ID会匹配到同一项、重放错误的回执
+// 只在网络任务中访问，无需加锁
+#ifndef DEDUPE_CACHE_H
+#define DEDUPE_CACHE_H
+
+#include <Arduino.h>
+
+#ifndef DEDUPE_CACHE_SIZE
+#define DEDUPE_CACHE_SIZE      32   // 缓存的关联ID个数（不超过127）
+#endif
+#define DEDUPE_BUCKET_COUNT    64   // 哈希桶个数（2的幂）
+
+// 缓存项
+struct DedupeEntry {
+    uint32_t hash;              // 关联ID的FNV-1a哈希
+    int8_t next;                // 同一哈希桶中的下一项，-1表示结束
+    bool used;
+    bool completed;             // false表示命令仍在执行（回执尚未发布）
+    const char* state_topic;    // 回执Topic（路由表中的静态字符串）
+    const char* state;          // 回执的state（静态字符串）
+    CommandResult result;       // 原回执内容
+    char correlation_id[CORRELATION_ID_MAX_LEN];
+};
+
+class DedupeCache {
+public:
+    DedupeCache() : oldest_(0) {
+        memset(buckets_, -1, sizeof(buckets_));
+        memset(entries_, 0, sizeof(entries_));
+    }
+
+    /**
+     * @brief 关联ID能否完整保存为缓存的键
+     * @param correlation_id 关联ID
+     * @return 长度不超过CORRELATION_ID_MAX_LEN - 1时返回true
+     */
+    static bool fits(const char* correlation_id) {
+        return strnlen(correlation_id, CORRELATION_ID_MAX_LEN) < CORRELATION_ID_MAX_LEN;
+    }
+
+    /**
+     * @brief 查找关联ID
+     * @param correlation_id 关联ID（fits()为true）
+     * @return 缓存项，未找到时返回nullptr
+     */
+    const DedupeEntry* find(const char* correlation_id) const {
+        int index = find_index(correlation_id, hash_string(correlation_id));
+        return index >= 0 ? &entries_[index] : nullptr;
+    }
+
+    /**
+     * @brief 记录一条已交给执行任务的命令，回执发布前处于执行中状态；缓存已满时淘汰最早的一项
+     * @param correlation_id 关联ID
+     * @param state_topic 回执Topic
+     */
+    void insert(const char* correlation_id, const char* state_topic) {
+        int index = oldest_;
+        oldest_ = (uint8_t)((oldest_ + 1) % DEDUPE_CACHE_SIZE);
+        if (entries_[index].used) {
+            unlink(index);
+        }
+
+        DedupeEntry& entry = entries_[index];
+        entry.hash = hash_string(correlation_id);
+        entry.used = true;
+        entry.completed = false;
+        entry.state_topic = state_topic;
+        entry.state = nullptr;
+        snprintf(entry.correlation_id, sizeof(entry.correlation_id), "%s", correlation_id);
+
+        int8_t& head = buckets_[entry.hash & (DEDUPE_BUCKET_COUNT - 1)];
+        entry.next = head;
+        head = (int8_t)index;
+    }
+
+    /**
+     * @brief 记录命令的回执，之后的重复命令直接重放该回执（批量命令的汇总回执保存在batch_context中，这里只标记完成）
+     * @param correlation_id 关联ID
+     * @param state 回执的state
+     * @param result 执行结果
+     */
+    void complete(const char* correlation_id, const char* state, const CommandResult& result) {
+        int index = find_index(correlation_id, hash_string(correlation_id));
+        if (index < 0) {
+            return;     // 执行期间已被淘汰，或不是经由缓存记录的命令
+        }
+        entries_[index].completed = true;
+        entries_[index].state = state;
+        entries_[index].result = result;
+    }
+
+    /**
+     * @brief 删除关联ID，用于不应重放的临时性结果（如NODE_BUSY），使重试能够重新执行
+     * @param correlation_id 关联ID
+     */
+    void remove(const char* correlation_id) {
+        int index = find_index(correlation_id, hash_string(correlation_id));
+        if (index >= 0) {
+            unlink(index);
+            entries_[index].used = false;
+        }
+    }
+
+private:
+    int8_t buckets_[DEDUPE_BUCKET_COUNT];       // 每个桶中第一项的下标，-1表示空
+    DedupeEntry entries_[DEDUPE_CACHE_SIZE];
+    uint8_t oldest_;                            // 下一个被复用的表项
+
+    int find_index(const char* correlation_id, uint32_t hash) const {
+        for (int8_t i = buckets_[hash & (DEDUPE_BUCKET_COUNT - 1)]; i >= 0; i = entries_[i].next) {
+            if (entries_[i].hash == hash && strcmp(entries_[i].correlation_id, correlation_id) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // 从所在哈希桶的链表中摘除表项
+    void unlink(int index) {
+        int8_t* link = &buckets_[entries_[index].hash & (DEDUPE_BUCKET_COUNT - 1)];
+        while (*link >= 0) {
+            if (*link == index) {
+                *link = entries_[index].next;
+                return;
+            }
+            link = &entries_[*link].next;
+        }
+    }
+};
+
+#endif // DEDUPE_CACHE_H
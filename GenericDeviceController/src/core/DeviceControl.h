@@ -5,6 +5,7 @@
 #define DEVICE_CONTROL_H
 
 #include <Arduino.h>
+#include "Symbols.h"
 
 // --- 伺服舵机配置参数 ---
 // 定义4个舵机的引脚和通道配置
@@ -16,31 +17,51 @@
 // 2.5ms (2500us) 脉宽: duty = (2500 / 1000000) * 50 * 1023 = 0.0025 * 50 * 1023 = 127.875 -> 128
 #define MAX_DUTY_VALUE    128  // 对应180度 (2.5ms脉宽 @50Hz, 10bit分辨率)
 
+#define SERVO_STOP_ANGLE      90        // 连续旋转舵机的停止角度
+#define SERVO_SETTLE_MS       2000      // 动作前后的停止保持时长(ms)
+#define SERVO_MAX_KEYFRAMES   4         // 单个运动序列的最大关键帧数
+#define CORRELATION_ID_MAX_LEN 64       // 延迟回执时缓存的correlation_id最大长度(含结束符)
+
+// 舵机运动关键帧：输出角度并保持指定时长
+struct ServoKeyframe {
+    uint8_t angle;         // 角度 (0-180)
+    uint16_t hold_ms;      // 保持时长(ms)
+};
+
+// 舵机命令执行结果
+enum ServoCommandResult {
+    SERVO_CMD_DONE,        // 已处于目标状态，可立即回执
+    SERVO_CMD_STARTED,     // 运动序列已启动，回执在序列结束后发布
+    SERVO_CMD_BUSY,        // 舵机正在执行上一个序列
+    SERVO_CMD_NOT_FOUND    // 本节点没有该舵机设备
+};
+
+// 运动序列结束回调：设备下标（devices[]）、"ON"/"OFF"状态与序列启动时的关联ID
+typedef void (*ServoMotionDoneCallback)(int device, const char* state, const char* correlation_id);
+
 // 舵机设备结构体
 struct ServoDevice {
     uint8_t pin;           // 舵机引脚
     uint8_t channel;       // PWM通道
     bool is_initialized;   // 是否已初始化
     bool current_status;   // 当前状态 (true=开, false=关)
-    const char* room_id;   // 房间ID
-    const char* device_id; // 设备ID
+    int8_t device;         // 设备下标（devices[]）
+
+    // 运动序列状态（由update_servo_motions()在执行任务中推进，不阻塞）
+    ServoKeyframe frames[SERVO_MAX_KEYFRAMES];
+    uint8_t frame_count;           // 序列关键帧数
+    uint8_t frame_index;           // 当前关键帧
+    unsigned long frame_start_ms;  // 当前关键帧开始时间
+    unsigned long sequence_start_us; // 序列开始时间，用于运行指标
+    bool is_moving;                // 是否正在执行序列
+    bool target_status;            // 序列结束后的状态
+    char correlation_id[CORRELATION_ID_MAX_LEN]; // 待发送回执的关联ID
 };
 
 // 舵机设备数组 - 最多支持4个舵机
 ServoDevice servo_devices[4];
 int servo_count = 0;  // 实际舵机数量
 
-// 获取舵机设备索引
-int get_servo_index(const char* room_id, const char* device_id) {
-    for (int i = 0; i < servo_count; i++) {
-        if (strcmp(servo_devices[i].room_id, room_id) == 0 && 
-            strcmp(servo_devices[i].device_id, device_id) == 0) {
-            return i;
-        }
-    }
-    return -1;  // 未找到舵机设备
-}
-
 //--- 伺服舵机函数 ---
 /**
  * @brief 设置指定舵机的角度
@@ -49,12 +70,12 @@ int get_servo_index(const char* room_id, const char* device_id) {
  */
 void set_servo_angle(int servo_index, uint8_t angle) {
     if (servo_index < 0 || servo_index >= servo_count) {
-        Serial.println("[HAL-ERROR] Invalid servo index");
+        LOG_ERROR("[HAL-ERROR] Invalid servo index");
         return;
     }
     
     if (!servo_devices[servo_index].is_initialized) {
-        Serial.println("[HAL-ERROR] Servo device not initialized");
+        LOG_ERROR("[HAL-ERROR] Servo device not initialized");
         return;
     }
     
@@ -70,52 +91,137 @@ void set_servo_angle(int servo_index, uint8_t angle) {
     ledcWrite(servo_devices[servo_index].channel, duty);
 }
 
+// 运动序列结束回调（由主程序注册，用于发布延迟回执）
+ServoMotionDoneCallback servo_motion_done_callback = nullptr;
+
+/**
+ * @brief 注册运动序列结束回调
+ * @param callback 回调函数，序列结束时以"ON"/"OFF"状态调用
+ */
+void set_servo_motion_callback(ServoMotionDoneCallback callback) {
+    servo_motion_done_callback = callback;
+}
+
+/**
+ * @brief 为指定舵机启动关键帧运动序列，立即输出第一帧，后续帧由update_servo_motions()推进
+ * @param servo_index 舵机索引
+ * @param frames 关键帧数组
+ * @param count 关键帧数量 (1-SERVO_MAX_KEYFRAMES)
+ * @param target_status 序列结束后的设备状态
+ * @param correlation_id 序列结束时回执使用的关联ID
+ * @return true表示已启动，false表示舵机忙或参数无效
+ */
+bool servo_start_sequence(int servo_index, const ServoKeyframe* frames, uint8_t count, bool target_status, const char* correlation_id) {
+    if (servo_index < 0 || servo_index >= servo_count || count == 0 || count > SERVO_MAX_KEYFRAMES) {
+        return false;
+    }
+
+    ServoDevice& servo = servo_devices[servo_index];
+    if (servo.is_moving) {
+        return false;
+    }
+
+    memcpy(servo.frames, frames, count * sizeof(ServoKeyframe));
+    servo.frame_count = count;
+    servo.frame_index = 0;
+    servo.target_status = target_status;
+    strncpy(servo.correlation_id, correlation_id ? correlation_id : "", CORRELATION_ID_MAX_LEN - 1);
+    servo.correlation_id[CORRELATION_ID_MAX_LEN - 1] = '\0';
+    servo.is_moving = true;
+    servo.sequence_start_us = metrics_now();
+
+    set_servo_angle(servo_index, servo.frames[0].angle);
+    servo.frame_start_ms = millis();
+    return true;
+}
+
+/**
+ * @brief 推进所有舵机的运动序列，需在执行任务中持续调用。多个舵机使用独立的PWM通道，可同时运动。
+ */
+void update_servo_motions() {
+    unsigned long now = millis();
+    for (int i = 0; i < servo_count; i++) {
+        ServoDevice& servo = servo_devices[i];
+        if (!servo.is_moving || now - servo.frame_start_ms < servo.frames[servo.frame_index].hold_ms) {
+            continue;
+        }
+
+        servo.frame_index++;
+        if (servo.frame_index < servo.frame_count) {
+            // 进入下一关键帧
+            set_servo_angle(i, servo.frames[servo.frame_index].angle);
+            servo.frame_start_ms = now;
+            continue;
+        }
+
+        // 序列结束，更新状态并发布延迟回执
+        servo.is_moving = false;
+        servo.current_status = servo.target_status;
+        metrics_record(STAGE_SERVO, servo.sequence_start_us);
+        LOG_INFO("[HAL] '%s/%s' (Pin %d, Channel %d) turned %s", devices[servo.device].room_id, devices[servo.device].device_id,
+                 servo.pin, servo.channel, servo.current_status ? "ON" : "OFF");
+        if (servo_motion_done_callback) {
+            servo_motion_done_callback(servo.device, servo.current_status ? "ON" : "OFF", servo.correlation_id);
+        }
+    }
+}
+
+/**
+ * @brief (私有辅助函数) 构造"停止-转动-停止"关键帧序列
+ * @param frames 输出关键帧数组，至少3个元素
+ * @param move_angle 转动角度
+ * @param move_ms 转动时长，0表示该房间无转动动作
+ * @return 关键帧数量
+ */
+uint8_t build_servo_sequence(ServoKeyframe* frames, uint8_t move_angle, uint16_t move_ms) {
+    uint8_t count = 0;
+    frames[count++] = { SERVO_STOP_ANGLE, SERVO_SETTLE_MS };
+    if (move_ms > 0) {
+        frames[count++] = { move_angle, move_ms };
+    }
+    frames[count++] = { SERVO_STOP_ANGLE, SERVO_SETTLE_MS };
+    return count;
+}
+
 // =================== 空调状态管理 ===================
 struct AirConditionerState {
     bool is_on;              // 空调是否开启
     int target_temperature;  // 目标温度
 };
 
-// 手动定义空调状态数组 - 按房间索引
-// 0: livingroom, 1: bedroom, 2: kitchen, 3: bathroom
-AirConditionerState ac_states[4] = {
+// 空调状态数组，按房间编号（Symbols.h中的RoomId）索引
+AirConditionerState ac_states[ROOM_COUNT] = {
     {false, 24},  // livingroom 空调：关闭，默认24度
     {false, 24},  // bedroom 空调：关闭，默认24度  
     {false, 26},  // kitchen 空调：关闭，默认26度（厨房稍热）
-    {false, 25}   // bathroom 空调：关闭，默认25度
+    {false, 25},  // bathroom 空调：关闭，默认25度
+    {false, 24}   // outdoor（没有空调，保留以便按房间编号直接索引）
 };
 
-// 获取房间对应的数组索引
-int get_room_index(const char* room_id) {
-    if (strcmp(room_id, "livingroom") == 0) return 0;
-    if (strcmp(room_id, "bedroom") == 0) return 1;
-    if (strcmp(room_id, "kitchen") == 0) return 2;
-    if (strcmp(room_id, "bathroom") == 0) return 3;
-    return -1;  // 未知房间
-}
-
 // 获取空调状态
-AirConditionerState* get_ac_state(const char* room_id) {
-    int index = get_room_index(room_id);
-    if (index >= 0 && index < 4) {
-        return &ac_states[index];
-    }
-    return nullptr;
+AirConditionerState* get_ac_state(RoomId room) {
+    return room >= 0 && room < ROOM_COUNT ? &ac_states[room] : nullptr;
 }
 
+// =================== 设备句柄 ===================
+// 设备句柄：启动时为每个设备解析一次引脚、舵机通道、房间编号和设备类型编号，命令路径直接使用，不再做字符串查找
+struct DeviceHandle {
+    const Device* device;   // 设备配置项（room_id, device_id, pin），字符串只用于日志
+    int8_t servo_index;     // 舵机索引，非舵机设备为-1
+    RoomId room_index;      // 房间编号，不在符号表中的房间为ROOM_NONE
+    DeviceType type;        // 设备类型编号，不在符号表中的类型为DEVICE_TYPE_NONE
+};
+
+// 设备句柄数组，与devices[]一一对应
+DeviceHandle device_handles[DEVICE_TABLE_MAX_DEVICES];
+
 /**
- * @brief (私有辅助函数) 在设备数组中根据room_id和device_id查找对应的引脚。room_id和device_id定义在Node1Config.h
- * @param room_id 要查找的房间ID。
- * @param device_id 要查找的设备ID。
- * @return 找到则返回引脚号，未找到则返回-1。
+ * @brief 设备是否正在执行运动序列（只有舵机设备可能为true），命令调度器据此推迟该设备的后续命令
+ * @param handle 设备句柄
+ * @return true表示设备忙
  */
- int find_pin(const char* room_id, const char* device_id) {
-    for (int i = 0; i < DEVICE_COUNT; i++) {
-        if (strcmp(devices[i].room_id, room_id) == 0 && strcmp(devices[i].device_id, device_id) == 0) {
-            return devices[i].pin;
-        }
-    }
-    return -1;
+bool is_device_busy(const DeviceHandle& handle) {
+    return handle.servo_index >= 0 && servo_devices[handle.servo_index].is_moving;
 }
 
 
@@ -124,29 +230,31 @@ AirConditionerState* get_ac_state(const char* room_id) {
  * @brief 初始化设备引脚，设置为输出模式并关闭。
  */
  void setup_devices() {
-    Serial.println("[HAL] Initializing all configured devices...");
+    LOG_INFO("[HAL] Initializing all configured devices...");
     
-    // 动态初始化舵机设备
-    for (int i = 0; i < DEVICE_COUNT; i++) {
+    // 为每个设备建立句柄，房间和设备类型取设备表加载时驻留的编号；舵机设备同时分配舵机通道
+    servo_count = 0;
+    for (int i = 0; i < device_count; i++) {
+        DeviceHandle& handle = device_handles[i];
+        handle.device = &devices[i];
+        handle.servo_index = -1;
+        handle.room_index = device_table_room_symbol(i);
+        handle.type = device_table_type_symbol(i);
         if (!devices[i].is_virtual) {
             // 检查是否为舵机设备
-            if (strcmp(devices[i].device_id, "window") == 0 || strcmp(devices[i].device_id, "curtain") == 0) {
+            if (handle.type == DEVICE_TYPE_window || handle.type == DEVICE_TYPE_curtain) {
                 if (servo_count < 4) {
+                    handle.servo_index = servo_count;
                     servo_devices[servo_count].pin = devices[i].pin;
                     servo_devices[servo_count].channel = servo_count;  // 使用索引作为通道号
                     servo_devices[servo_count].is_initialized = false; // 稍后初始化
                     servo_devices[servo_count].current_status = false; // 初始状态为关闭
-                    servo_devices[servo_count].room_id = devices[i].room_id;
-                    servo_devices[servo_count].device_id = devices[i].device_id;
+                    servo_devices[servo_count].is_moving = false;
+                    servo_devices[servo_count].device = i;
                     servo_count++;
-                    Serial.print("[HAL] Servo device found: "); Serial.print(devices[i].room_id);
-                    Serial.print("/"); Serial.print(devices[i].device_id);
-                    Serial.print(" (Pin "); Serial.print(devices[i].pin);
-                    Serial.print(", Channel "); Serial.print(servo_count-1);
-                    Serial.println(")");
+                    LOG_INFO("[HAL] Servo device found: %s/%s (Pin %d, Channel %d)", devices[i].room_id, devices[i].device_id, devices[i].pin, servo_count-1);
                 } else {
-                    Serial.print("[HAL-ERROR] Max servo count reached (4). Cannot initialize: ");
-                    Serial.print(devices[i].room_id); Serial.print("/"); Serial.println(devices[i].device_id);
+                    LOG_ERROR("[HAL-ERROR] Max servo count reached (4). Cannot initialize: %s/%s", devices[i].room_id, devices[i].device_id);
                 }
             } else {
                 // 非舵机设备，按普通GPIO处理
@@ -161,76 +269,65 @@ AirConditionerState* get_ac_state(const char* room_id) {
         ledcSetup(servo_devices[i].channel, SERVO_FREQ_HZ, SERVO_RESOLUTION_BITS);
         ledcAttachPin(servo_devices[i].pin, servo_devices[i].channel);
         servo_devices[i].is_initialized = true;
-        Serial.print("[HAL] Servo initialized: "); Serial.print(servo_devices[i].room_id);
-        Serial.print("/"); Serial.print(servo_devices[i].device_id);
-        Serial.print(" (Pin "); Serial.print(servo_devices[i].pin);
-        Serial.print(", Channel "); Serial.print(servo_devices[i].channel);
-        Serial.println(")");
+        const Device& device = devices[servo_devices[i].device];
+        LOG_INFO("[HAL] Servo initialized: %s/%s (Pin %d, Channel %d)", device.room_id, device.device_id, servo_devices[i].pin, servo_devices[i].channel);
     }
-    Serial.println("[HAL] All physical devices initialized and turned OFF.");
+    LOG_INFO("[HAL] All physical devices initialized and turned OFF.");
 }
 
 /**
- * @brief 控制指定房间的灯的开关。
- * @param room_id 灯所在的房间ID。
+ * @brief (私有辅助函数) 开关类设备的通用控制：写GPIO电平并输出日志。
+ * @param handle 设备句柄。
  * @param is_on true为开，false为关。
  * @return true表示成功，false表示失败
  */
- bool control_light(const char* room_id, bool is_on) {
-    int pin = find_pin(room_id, "light");
-    if (pin != -1) {
-        digitalWrite(pin, is_on ? HIGH : LOW);
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/light' (Pin "); Serial.print(pin);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
-    } else {
-        Serial.print("[HAL-ERROR] Device 'light' not found in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
+bool control_switch(const DeviceHandle& handle, bool is_on) {
+    if (handle.device == nullptr || handle.device->is_virtual) {
+        LOG_ERROR("[HAL-ERROR] Invalid switch device handle");
         return false;
     }
+    digitalWrite(handle.device->pin, is_on ? HIGH : LOW);
+    LOG_INFO("[HAL] '%s/%s' (Pin %d) turned %s", handle.device->room_id, handle.device->device_id, handle.device->pin, is_on ? "ON" : "OFF");
+    return true;
 }
 
 /**
- * @brief 控制指定房间的灯的开关。
- * @param room_id 灯所在的房间ID。
+ * @brief 控制灯的开关。
+ * @param handle 灯的设备句柄。
  * @param is_on true为开，false为关。
  * @return true表示成功，false表示失败
  */
- bool control_bedside_light(const char* room_id, bool is_on) {
-    int pin = find_pin(room_id, "bedside_light");
-    if (pin != -1) {
-        digitalWrite(pin, is_on ? HIGH : LOW);
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/light' (Pin "); Serial.print(pin);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
-    } else {
-        Serial.print("[HAL-ERROR] Device 'light' not found in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
-        return false;
-    }
+bool control_light(const DeviceHandle& handle, bool is_on) {
+    return control_switch(handle, is_on);
+}
+
+/**
+ * @brief 控制床头灯的开关。
+ * @param handle 床头灯的设备句柄。
+ * @param is_on true为开，false为关。
+ * @return true表示成功，false表示失败
+ */
+bool control_bedside_light(const DeviceHandle& handle, bool is_on) {
+    return control_switch(handle, is_on);
 }
 
 /**
  * @brief 专门处理空调温度设置。
- * @param room_id 空调所在的房间ID。
+ * @param handle 空调的设备句柄。
  * @param temperature 目标温度。
  * @return true表示成功，false表示失败
  */
-bool control_ac_set_temperature(const char* room_id, int temperature) {
+bool control_ac_set_temperature(const DeviceHandle& handle, int temperature) {
     // 温度范围检查
     if (temperature < 0 || temperature > 40) {
-        Serial.print("[HAL-ERROR] Invalid temperature: "); Serial.print(temperature);
-        Serial.println(". Valid range: 0-40°C");
+        LOG_ERROR("[HAL-ERROR] Invalid temperature: %d. Valid range: 0-40°C", temperature);
         return false;
     }
     
     // 获取空调状态
-    AirConditionerState* state = get_ac_state(room_id);
+    AirConditionerState* state = get_ac_state(handle.room_index);
     if (state == nullptr) {
-        Serial.print("[HAL-ERROR] Room '"); Serial.print(room_id);
-        Serial.println("' not found for AC temperature setting");
+        LOG_ERROR("[HAL-ERROR] Room '%s' not found for AC temperature setting", handle.device->room_id);
         return false;
     }
     
@@ -238,163 +335,115 @@ bool control_ac_set_temperature(const char* room_id, int temperature) {
     state->target_temperature = temperature;
     
     // 这里可以添加实际的硬件控制逻辑（如红外发射、串口通信等）
-    Serial.print("[HAL] AC in "); Serial.print(room_id);
-    Serial.print(" temperature set to: "); Serial.print(temperature);
-    Serial.println("°C");
+    LOG_INFO("[HAL] AC in %s temperature set to: %d°C", handle.device->room_id, temperature);
     
     return true;
 }
 
 /**
- * @brief 控制指定房间的空调开关。
- * @param room_id 空调所在的房间ID。
+ * @brief 控制空调开关。
+ * @param handle 空调的设备句柄。
  * @param is_on true为开，false为关。
  * @param temperature 设定温度（用于ON操作时更新目标温度）。
  * @return true表示成功，false表示失败
  */
- bool control_ac(const char* room_id, bool is_on, int temperature) {
-    int pin = find_pin(room_id, "ac"); // 硬编码device_id为"ac"
-    if (pin != -1) {
-        digitalWrite(pin, is_on ? HIGH : LOW);
-        
-        // 更新状态
-        AirConditionerState* state = get_ac_state(room_id);
-        if (state != nullptr) {
-            state->is_on = is_on;
-            if (is_on && temperature >= 0 && temperature <= 40) {
-                // ON操作时必须设置提供的温度值
-                state->target_temperature = temperature;
-            } else if (!is_on) {
-                // OFF操作时保持当前温度设置
-            }
-        }
-        
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/ac' (Pin "); Serial.print(pin);
-        Serial.print(") turned "); Serial.print(is_on ? "ON" : "OFF");
-        if (is_on && state != nullptr) {
-            Serial.print(", temp: "); Serial.print(state->target_temperature); Serial.print("°C");
-        }
-        Serial.println();
-        return true;
-    } else {
-        Serial.print("[HAL-ERROR] Device 'ac' not found in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
+bool control_ac(const DeviceHandle& handle, bool is_on, int temperature) {
+    if (!control_switch(handle, is_on)) {
         return false;
     }
+
+    // 更新状态
+    AirConditionerState* state = get_ac_state(handle.room_index);
+    if (state != nullptr) {
+        state->is_on = is_on;
+        if (is_on && temperature >= 0 && temperature <= 40) {
+            // ON操作时必须设置提供的温度值
+            state->target_temperature = temperature;
+            LOG_INFO("[HAL] AC temp: %d°C", state->target_temperature);
+        }
+        // OFF操作时保持当前温度设置
+    }
+    return true;
 }
 
 /**
- * @brief 控制指定房间的油烟机开关。
- * @param room_id 油烟机所在的房间ID。
+ * @brief 控制油烟机开关。
+ * @param handle 油烟机的设备句柄。
  * @param is_on true为开，false为关。
  * @return true表示成功，false表示失败
  */
-bool control_hood(const char* room_id, bool is_on) {
-    int pin = find_pin(room_id, "hood"); // 硬编码device_id为"hood"
-    if (pin != -1) {
-        digitalWrite(pin, is_on ? HIGH : LOW);
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/hood' (Pin "); Serial.print(pin);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
-    } else {
-        Serial.print("[HAL-ERROR] Device 'hood' not found in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
-        return false;
-    }
+bool control_hood(const DeviceHandle& handle, bool is_on) {
+    return control_switch(handle, is_on);
 }
 
 /**
- * @brief 控制指定房间的排气扇开关。
- * @param room_id 排气扇所在的房间ID。
+ * @brief 控制排气扇开关。
+ * @param handle 排气扇的设备句柄。
  * @param is_on true为开，false为关。
  * @return true表示成功，false表示失败
  */
-bool control_fan(const char* room_id, bool is_on) {
-    int pin = find_pin(room_id, "fan"); // 硬编码device_id为"fan"
-    if (pin != -1) {
-        digitalWrite(pin, is_on ? HIGH : LOW);
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/fan' (Pin "); Serial.print(pin);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
-    } else {
-        Serial.print("[HAL-ERROR] Device 'fan' not found in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
-        return false;
-    }
+bool control_fan(const DeviceHandle& handle, bool is_on) {
+    return control_switch(handle, is_on);
 }
 
 
 
 /**
- * @brief 控制指定房间的窗户开关。
- * @param room_id 窗户所在的房间ID。
+ * @brief 控制窗户开关。启动非阻塞运动序列，回执在序列结束后发布。
+ * @param handle 窗户的设备句柄。
  * @param is_on true为开，false为关。
- * @return true表示成功，false表示失败
+ * @param correlation_id 关联ID，序列结束时用于回执。
+ * @return 舵机命令执行结果
  */
-bool control_window(const char* room_id, bool is_on) {
-    int servo_index = get_servo_index(room_id, "window");
+ServoCommandResult control_window(const DeviceHandle& handle, bool is_on, const char* correlation_id) {
+    int servo_index = handle.servo_index;
+    const char* room_id = handle.device->room_id;
     if (servo_index != -1) {
         // 检查状态是否已经符合要求
-        if (is_on == servo_devices[servo_index].current_status) {
-            return true;
+        if (is_on == servo_devices[servo_index].current_status && !servo_devices[servo_index].is_moving) {
+            return SERVO_CMD_DONE;
         }
-        
+        if (servo_devices[servo_index].is_moving) {
+            LOG_ERROR("[HAL-ERROR] '%s/window' is busy", room_id);
+            return SERVO_CMD_BUSY;
+        }
+
+        // 根据房间调整角度和转动时长
+        uint8_t move_angle = SERVO_STOP_ANGLE;
+        uint16_t move_ms = 0;
         if (is_on == true) {
             // 开窗操作
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            
-            // 根据房间调整角度和延迟时间
-            if (strcmp(room_id, "livingroom") == 0) {
-                // 客厅窗户：开窗180度，延迟450ms
-                set_servo_angle(servo_index, 130);
-                delay(750);
-            } else if (strcmp(room_id, "bedroom") == 0) {
-                // 卧室窗户：开窗0度，延迟500ms（可能需要更长时间）
-                set_servo_angle(servo_index, 50);
-                delay(750);
+            if (handle.room_index == ROOM_LIVINGROOM) {
+                // 客厅窗户：开窗130度，转动750ms
+                move_angle = 130; move_ms = 750;
+            } else if (handle.room_index == ROOM_BEDROOM) {
+                // 卧室窗户：开窗50度，转动750ms
+                move_angle = 50; move_ms = 750;
             }
-
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            servo_devices[servo_index].current_status = true;
         }
         else {
             // 关窗操作
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            
-            // 根据房间调整角度和延迟时间
-            if (strcmp(room_id, "livingroom") == 0) {
-                // 客厅窗户：关窗0度，延迟450ms
-                set_servo_angle(servo_index, 50);
-                delay(700);
-            } else if (strcmp(room_id, "bedroom") == 0) {
-                // 卧室窗户：关窗180度，延迟500ms（可能需要更长时间）
-                set_servo_angle(servo_index, 130);
-                delay(750);
+            if (handle.room_index == ROOM_LIVINGROOM) {
+                // 客厅窗户：关窗50度，转动700ms
+                move_angle = 50; move_ms = 700;
+            } else if (handle.room_index == ROOM_BEDROOM) {
+                // 卧室窗户：关窗130度，转动750ms
+                move_angle = 130; move_ms = 750;
             }
-
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            servo_devices[servo_index].current_status = false;
         }
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/window' (Pin "); Serial.print(servo_devices[servo_index].pin);
-        Serial.print(", Channel "); Serial.print(servo_devices[servo_index].channel);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
+
+        ServoKeyframe frames[SERVO_MAX_KEYFRAMES];
+        uint8_t count = build_servo_sequence(frames, move_angle, move_ms);
+        servo_start_sequence(servo_index, frames, count, is_on, correlation_id);
+        LOG_INFO("[HAL] '%s/window' motion started, target %s", room_id, is_on ? "ON" : "OFF");
+        return SERVO_CMD_STARTED;
     } else {
-        Serial.print("[HAL-ERROR] Window device not found or not valid in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
-        return false;
+        LOG_ERROR("[HAL-ERROR] Window device not found or not valid in room '%s' for this node's config!", room_id);
+        return SERVO_CMD_NOT_FOUND;
     }
 }
 
-/*
+#if 0
 // 门设备控制功能已禁用
 /**
  * @brief 控制指定房间的门开关。
@@ -416,69 +465,61 @@ bool control_window(const char* room_id, bool is_on) {
 //         return false;
 //     }
 // }
+#endif
 
 
 /**
- * @brief 控制指定房间的窗帘开关。
- * @param room_id 窗帘所在的房间ID。
+ * @brief 控制窗帘开关。启动非阻塞运动序列，回执在序列结束后发布。
+ * @param handle 窗帘的设备句柄。
  * @param is_on true为开，false为关。
- * @return true表示成功，false表示失败
+ * @param correlation_id 关联ID，序列结束时用于回执。
+ * @return 舵机命令执行结果
  */
-bool control_curtain(const char* room_id, bool is_on) {
-    int servo_index = get_servo_index(room_id, "curtain");
+ServoCommandResult control_curtain(const DeviceHandle& handle, bool is_on, const char* correlation_id) {
+    int servo_index = handle.servo_index;
+    const char* room_id = handle.device->room_id;
     if (servo_index != -1) {
         // 检查状态是否已经符合要求
-        if (is_on == servo_devices[servo_index].current_status) {
-            return true;
+        if (is_on == servo_devices[servo_index].current_status && !servo_devices[servo_index].is_moving) {
+            return SERVO_CMD_DONE;
         }
-        
+        if (servo_devices[servo_index].is_moving) {
+            LOG_ERROR("[HAL-ERROR] '%s/curtain' is busy", room_id);
+            return SERVO_CMD_BUSY;
+        }
+
+        // 根据房间调整角度和转动时长
+        uint8_t move_angle = SERVO_STOP_ANGLE;
+        uint16_t move_ms = 0;
         if (is_on == true) {
             // 开窗帘操作
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            
-            // 根据房间调整角度和延迟时间
-            if (strcmp(room_id, "livingroom") == 0) {
-                // 客厅窗帘：开窗帘130度，延迟750ms
-                set_servo_angle(servo_index, 130);
-                delay(1760);
-            } else if (strcmp(room_id, "bedroom") == 0) {
-                // 卧室窗帘：开窗帘50度，延迟800ms（可能需要更长时间）
-                set_servo_angle(servo_index, 50);
-                delay(1760);
+            if (handle.room_index == ROOM_LIVINGROOM) {
+                // 客厅窗帘：开窗帘130度，转动1760ms
+                move_angle = 130; move_ms = 1760;
+            } else if (handle.room_index == ROOM_BEDROOM) {
+                // 卧室窗帘：开窗帘50度，转动1760ms
+                move_angle = 50; move_ms = 1760;
             }
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            servo_devices[servo_index].current_status = true;
         }
         else {
             // 关窗帘操作
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            
-            // 根据房间调整角度和延迟时间
-            if (strcmp(room_id, "livingroom") == 0) {
-                // 客厅窗帘：关窗帘30度，延迟750ms
-                set_servo_angle(servo_index, 50);
-                delay(1720);
-            } else if (strcmp(room_id, "bedroom") == 0) {
-                // 卧室窗帘：关窗帘150度，延迟800ms（可能需要更长时间）
-                set_servo_angle(servo_index, 130);
-                delay(1740);
+            if (handle.room_index == ROOM_LIVINGROOM) {
+                // 客厅窗帘：关窗帘50度，转动1720ms
+                move_angle = 50; move_ms = 1720;
+            } else if (handle.room_index == ROOM_BEDROOM) {
+                // 卧室窗帘：关窗帘130度，转动1740ms
+                move_angle = 130; move_ms = 1740;
             }
-            set_servo_angle(servo_index, 90);
-            delay(2000);
-            servo_devices[servo_index].current_status = false;
         }
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/curtain' (Pin "); Serial.print(servo_devices[servo_index].pin);
-        Serial.print(", Channel "); Serial.print(servo_devices[servo_index].channel);
-        Serial.print(") turned "); Serial.println(is_on ? "ON" : "OFF");
-        return true;
+
+        ServoKeyframe frames[SERVO_MAX_KEYFRAMES];
+        uint8_t count = build_servo_sequence(frames, move_angle, move_ms);
+        servo_start_sequence(servo_index, frames, count, is_on, correlation_id);
+        LOG_INFO("[HAL] '%s/curtain' motion started, target %s", room_id, is_on ? "ON" : "OFF");
+        return SERVO_CMD_STARTED;
     } else {
-        Serial.print("[HAL-ERROR] Curtain device not found or not valid in room '");
-        Serial.print(room_id); Serial.println("' for this node's config!");
-        return false;
+        LOG_ERROR("[HAL-ERROR] Curtain device not found or not valid in room '%s' for this node's config!", room_id);
+        return SERVO_CMD_NOT_FOUND;
     }
 }
 
@@ -490,105 +531,105 @@ bool control_curtain(const char* room_id, bool is_on) {
 
     /**
      * @brief 控制温度传感器读取
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 温度值，-999.0表示读取失败
      */
-    float control_temperature_sensor(const char* room_id) {
-        int room_index = getRoomIndex(room_id);
-        if (room_index == -1) {
-            Serial.print("[HAL-ERROR] Unknown room for temp sensor: "); Serial.println(room_id);
+    float control_temperature_sensor(const DeviceHandle& handle) {
+        RoomId room_index = handle.room_index;
+        const char* room_id = handle.device->room_id;
+        if (room_index == ROOM_NONE) {
+            LOG_ERROR("[HAL-ERROR] Unknown room for temp sensor: %s", room_id);
             return -999.0;
         }
         
-        SensorData sensor_data = getSensorData((RoomIndex)room_index);
-        float temp_value = sensor_data.temperature;
+        const SensorData* sensor_data = getSensorDataPtr(room_index);
+        float temp_value = sensor_data->temperature;
         
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/temp_sensor' read: "); Serial.print(temp_value); Serial.println("°C");
+        LOG_INFO("[HAL] '%s/temp_sensor' read: %.2f°C", room_id, temp_value);
         
         return temp_value;
     }
 
     /**
      * @brief 控制湿度传感器读取
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 湿度值，-999.0表示读取失败
      */
-    float control_humidity_sensor(const char* room_id) {
-        int room_index = getRoomIndex(room_id);
-        if (room_index == -1) {
-            Serial.print("[HAL-ERROR] Unknown room for humidity sensor: "); Serial.println(room_id);
+    float control_humidity_sensor(const DeviceHandle& handle) {
+        RoomId room_index = handle.room_index;
+        const char* room_id = handle.device->room_id;
+        if (room_index == ROOM_NONE) {
+            LOG_ERROR("[HAL-ERROR] Unknown room for humidity sensor: %s", room_id);
             return -999.0;
         }
         
-        SensorData sensor_data = getSensorData((RoomIndex)room_index);
-        float humidity_value = sensor_data.humidity;
+        const SensorData* sensor_data = getSensorDataPtr(room_index);
+        float humidity_value = sensor_data->humidity;
         
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/humidity_sensor' read: "); Serial.print(humidity_value); Serial.println("%");
+        LOG_INFO("[HAL] '%s/humidity_sensor' read: %.2f%%", room_id, humidity_value);
         
         return humidity_value;
     }
 
     /**
      * @brief 控制亮度传感器读取
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 亮度值，-999.0表示读取失败
      */
-    float control_brightness_sensor(const char* room_id) {
-        int room_index = getRoomIndex(room_id);
-        if (room_index == -1) {
-            Serial.print("[HAL-ERROR] Unknown room for brightness sensor: "); Serial.println(room_id);
+    float control_brightness_sensor(const DeviceHandle& handle) {
+        RoomId room_index = handle.room_index;
+        const char* room_id = handle.device->room_id;
+        if (room_index == ROOM_NONE) {
+            LOG_ERROR("[HAL-ERROR] Unknown room for brightness sensor: %s", room_id);
             return -999.0;
         }
         
-        SensorData sensor_data = getSensorData((RoomIndex)room_index);
-        float brightness_value = sensor_data.brightness;
+        const SensorData* sensor_data = getSensorDataPtr(room_index);
+        float brightness_value = sensor_data->brightness;
         
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/brightness_sensor' read: "); Serial.print(brightness_value); Serial.println("%");
+        LOG_INFO("[HAL] '%s/brightness_sensor' read: %.2f%%", room_id, brightness_value);
         
         return brightness_value;
     }
 
     /**
      * @brief 控制烟雾传感器读取
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 烟雾检测状态，-999.0表示读取失败
      */
-    float control_smoke_sensor(const char* room_id) {
-        int room_index = getRoomIndex(room_id);
-        if (room_index == -1) {
-            Serial.print("[HAL-ERROR] Unknown room for smoke sensor: "); Serial.println(room_id);
+    float control_smoke_sensor(const DeviceHandle& handle) {
+        RoomId room_index = handle.room_index;
+        const char* room_id = handle.device->room_id;
+        if (room_index == ROOM_NONE) {
+            LOG_ERROR("[HAL-ERROR] Unknown room for smoke sensor: %s", room_id);
             return -999.0;
         }
         
-        SensorData sensor_data = getSensorData((RoomIndex)room_index);
-        float smoke_value = sensor_data.smoke_detected ? 1.0 : 0.0;
+        const SensorData* sensor_data = getSensorDataPtr(room_index);
+        float smoke_value = sensor_data->smoke_detected ? 1.0 : 0.0;
         
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/smoke_sensor' read: "); Serial.print(smoke_value); Serial.println(" (0=正常, 1=检测到烟雾)");
+        LOG_INFO("[HAL] '%s/smoke_sensor' read: %.2f (0=正常, 1=检测到烟雾)", room_id, smoke_value);
         
         return smoke_value;
     }
 
     /**
      * @brief 控制燃气泄漏传感器读取
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 燃气泄漏状态，-999.0表示读取失败
      */
-    float control_gas_sensor(const char* room_id) {
-        int room_index = getRoomIndex(room_id);
-        if (room_index == -1) {
-            Serial.print("[HAL-ERROR] Unknown room for gas sensor: "); Serial.println(room_id);
+    float control_gas_sensor(const DeviceHandle& handle) {
+        RoomId room_index = handle.room_index;
+        const char* room_id = handle.device->room_id;
+        if (room_index == ROOM_NONE) {
+            LOG_ERROR("[HAL-ERROR] Unknown room for gas sensor: %s", room_id);
             return -999.0;
         }
         
-        SensorData sensor_data = getSensorData((RoomIndex)room_index);
-        float gas_value = sensor_data.gas_leak ? 1.0 : 0.0;
+        const SensorData* sensor_data = getSensorDataPtr(room_index);
+        float gas_value = sensor_data->gas_leak ? 1.0 : 0.0;
         
-        Serial.print("[HAL] '"); Serial.print(room_id);
-        Serial.print("/gas_sensor' read: "); Serial.print(gas_value); Serial.println(" (0=正常, 1=检测到泄漏)");
+        LOG_INFO("[HAL] '%s/gas_sensor' read: %.2f (0=正常, 1=检测到泄漏)", room_id, gas_value);
         
         return gas_value;
     }
@@ -597,51 +638,51 @@ bool control_curtain(const char* room_id, bool is_on) {
     // 无传感器支持的存根实现
     /**
      * @brief 温度传感器存根实现（无传感器支持时）
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 始终返回-999.0表示不支持
      */
-    float control_temperature_sensor(const char* room_id) {
-        Serial.println("[HAL-ERROR] Temperature sensor not supported on this node");
+    float control_temperature_sensor(const DeviceHandle& /*handle*/) {
+        LOG_ERROR("[HAL-ERROR] Temperature sensor not supported on this node");
         return -999.0;
     }
 
     /**
      * @brief 湿度传感器存根实现（无传感器支持时）
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 始终返回-999.0表示不支持
      */
-    float control_humidity_sensor(const char* room_id) {
-        Serial.println("[HAL-ERROR] Humidity sensor not supported on this node");
+    float control_humidity_sensor(const DeviceHandle& /*handle*/) {
+        LOG_ERROR("[HAL-ERROR] Humidity sensor not supported on this node");
         return -999.0;
     }
 
     /**
      * @brief 亮度传感器存根实现（无传感器支持时）
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 始终返回-999.0表示不支持
      */
-    float control_brightness_sensor(const char* room_id) {
-        Serial.println("[HAL-ERROR] Brightness sensor not supported on this node");
+    float control_brightness_sensor(const DeviceHandle& /*handle*/) {
+        LOG_ERROR("[HAL-ERROR] Brightness sensor not supported on this node");
         return -999.0;
     }
 
     /**
      * @brief 烟雾传感器存根实现（无传感器支持时）
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 始终返回-999.0表示不支持
      */
-    float control_smoke_sensor(const char* room_id) {
-        Serial.println("[HAL-ERROR] Smoke sensor not supported on this node");
+    float control_smoke_sensor(const DeviceHandle& /*handle*/) {
+        LOG_ERROR("[HAL-ERROR] Smoke sensor not supported on this node");
         return -999.0;
     }
 
     /**
      * @brief 燃气泄漏传感器存根实现（无传感器支持时）
-     * @param room_id 房间ID
+     * @param handle 传感器的设备句柄
      * @return 始终返回-999.0表示不支持
      */
-    float control_gas_sensor(const char* room_id) {
-        Serial.println("[HAL-ERROR] Gas sensor not supported on this node");
+    float control_gas_sensor(const DeviceHandle& /*handle*/) {
+        LOG_ERROR("[HAL-ERROR] Gas sensor not supported on this node");
         return -999.0;
     }
 #endif
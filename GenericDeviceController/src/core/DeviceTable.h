@@ -0,0 +1,364 @@
+// DeviceTable.h
+// 运行时设备表：设备列表以紧凑的二进制格式写入专用flash分区（partitions_devtable.csv中的devtable），
+// 启动时把分区映射到地址空间后原地使用，只校验头部、偏移和CRC，不做任何文本解析。
+// 重新接线、或让一个节点接管其他节点的设备时，用tools/device_table.py生成新的设备表写入该分区即可，无需重新编译固件；
+// 分区不存在或内容无效时，把NodeXConfig.h中的内置设备列表按同一格式编译到内存中，之后的代码只有一条路径。
+// 设备表按(房间, 设备名)建立二维下标，按编号查找设备为O(1)
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "Symbols.h"
+
+#define DEVICE_TABLE_PARTITION_LABEL    "devtable"
+#define DEVICE_TABLE_PARTITION_SUBTYPE  ((esp_partition_subtype_t)0x40)    // 自定义数据分区子类型
+#define DEVICE_TABLE_MAGIC              0x4C425444u     // "DTBL"
+#define DEVICE_TABLE_VERSION            1
+#define DEVICE_TABLE_MAX_DEVICES        32
+#define DEVICE_TABLE_MAX_ROOMS          8
+#define DEVICE_TABLE_MAX_NAMES          24
+#define DEVICE_TABLE_MAX_SIZE           1536            // 内置设备列表编译到内存时的缓冲区大小
+#define DEVICE_TABLE_NODE_ID_LEN        24
+#define DEVICE_TABLE_NONE               0xFF
+#define DEVICE_TABLE_FLAG_VIRTUAL       0x01
+
+// 设备表头部。各段的偏移均相对设备表起始位置，多字节字段为小端序；布局与tools/device_table.py一致
+struct DeviceTableHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                              // 设备表总字节数
+    uint32_t crc32;                             // 头部之后全部字节的CRC32
+    char node_id[DEVICE_TABLE_NODE_ID_LEN];     // 节点ID（MQTT客户端ID），空字符串表示沿用编译时的NODE_ID
+    uint8_t device_count;
+    uint8_t room_count;
+    uint8_t name_count;                         // 不同设备名的个数
+    uint8_t reserved;
+    uint16_t rooms_offset;                      // uint16_t[room_count]：房间ID字符串的偏移
+    uint16_t names_offset;                      // uint16_t[name_count]：设备名字符串的偏移
+    uint16_t entries_offset;                    // DeviceTableEntry[device_count]
+    uint16_t index_offset;                      // uint8_t[room_count][name_count]：设备下标，DEVICE_TABLE_NONE表示没有该设备
+};
+
+// 设备表项
+struct DeviceTableEntry {
+    uint8_t room;       // 房间编号（房间ID表中的下标）
+    uint8_t name;       // 设备名编号（设备名表中的下标）
+    uint8_t pin;
+    uint8_t flags;      // DEVICE_TABLE_FLAG_*
+};
+
+static_assert(sizeof(DeviceTableHeader) == 48, "DeviceTableHeader layout is shared with tools/device_table.py");
+static_assert(sizeof(DeviceTableEntry) == 4, "DeviceTableEntry layout is shared with tools/device_table.py");
+
+// 已加载的设备表（各指针指向映射的flash或device_table_ram）
+struct DeviceTable {
+    const uint8_t* base;
+    const DeviceTableHeader* header;
+    const uint16_t* rooms;
+    const uint16_t* names;
+    const DeviceTableEntry* entries;
+    const uint8_t* index;
+    bool mapped;            // true：来自flash分区；false：由内置设备列表编译
+    uint32_t load_us;       // 加载耗时（映射或编译、校验、建立设备项）
+    RoomId room_symbols[DEVICE_TABLE_MAX_ROOMS];        // 设备表中各房间对应的房间编号（Symbols.h）
+    DeviceType type_symbols[DEVICE_TABLE_MAX_NAMES];    // 设备表中各设备名对应的设备类型编号
+};
+
+DeviceTable device_table;
+uint8_t device_table_ram[DEVICE_TABLE_MAX_SIZE];    // 分区不可用时存放由内置设备列表编译的设备表
+
+// 本节点的设备，由设备表生成，房间ID和设备ID指向设备表中的字符串
+Device devices[DEVICE_TABLE_MAX_DEVICES];
+int device_count = 0;
+
+/**
+ * @brief CRC32（与zlib.crc32相同），只在启动时对不足1KB的设备表计算一次，逐位计算即可
+ */
+uint32_t device_table_crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief (私有辅助函数) 字符串偏移是否落在设备表内且以'\0'结尾
+ */
+bool device_table_string_valid(const uint8_t* data, uint16_t size, uint16_t offset) {
+    return offset < size && memchr(data + offset, '\0', size - offset) != nullptr;
+}
+
+/**
+ * @brief 校验设备表并设为当前设备表
+ * @param data 设备表起始地址（映射的flash或内存），需4字节对齐
+ * @param capacity data处可读的字节数
+ * @param mapped 是否来自flash分区
+ * @return false表示内容无效，当前设备表不变
+ */
+bool device_table_attach(const uint8_t* data, size_t capacity, bool mapped) {
+    const DeviceTableHeader* header = (const DeviceTableHeader*)data;
+    if (capacity < sizeof(DeviceTableHeader) || header->magic != DEVICE_TABLE_MAGIC ||
+        header->version != DEVICE_TABLE_VERSION || header->size < sizeof(DeviceTableHeader) || header->size > capacity) {
+        return false;
+    }
+    uint16_t size = header->size;
+    if (device_table_crc32(data + sizeof(DeviceTableHeader), size - sizeof(DeviceTableHeader)) != header->crc32 ||
+        memchr(header->node_id, '\0', sizeof(header->node_id)) == nullptr) {
+        return false;
+    }
+    if (header->device_count > DEVICE_TABLE_MAX_DEVICES || header->room_count > DEVICE_TABLE_MAX_ROOMS ||
+        header->name_count > DEVICE_TABLE_MAX_NAMES ||
+        header->rooms_offset % 2 != 0 || header->rooms_offset + header->room_count * 2 > size ||
+        header->names_offset % 2 != 0 || header->names_offset + header->name_count * 2 > size ||
+        header->entries_offset % 4 != 0 || header->entries_offset + header->device_count * sizeof(DeviceTableEntry) > size ||
+        header->index_offset + header->room_count * header->name_count > size) {
+        return false;
+    }
+
+    const uint16_t* rooms = (const uint16_t*)(data + header->rooms_offset);
+    const uint16_t* names = (const uint16_t*)(data + header->names_offset);
+    const DeviceTableEntry* entries = (const DeviceTableEntry*)(data + header->entries_offset);
+    const uint8_t* index = data + header->index_offset;
+    for (int i = 0; i < header->room_count; i++) {
+        if (!device_table_string_valid(data, size, rooms[i])) return false;
+    }
+    for (int i = 0; i < header->name_count; i++) {
+        if (!device_table_string_valid(data, size, names[i])) return false;
+    }
+    for (int i = 0; i < header->device_count; i++) {
+        if (entries[i].room >= header->room_count || entries[i].name >= header->name_count ||
+            index[entries[i].room * header->name_count + entries[i].name] != i) {
+            return false;
+        }
+    }
+
+    device_table.base = data;
+    device_table.header = header;
+    device_table.rooms = rooms;
+    device_table.names = names;
+    device_table.entries = entries;
+    device_table.index = index;
+    device_table.mapped = mapped;
+    return true;
+}
+
+/**
+ * @brief 把设备列表编译为设备表（与tools/device_table.py的输出逐字节相同）
+ * @param list 设备列表
+ * @param count 设备数
+ * @param node_id 节点ID
+ * @param out 输出缓冲区，需4字节对齐
+ * @param capacity 缓冲区大小
+ * @return 设备表字节数，超出容量或有重复设备时返回0
+ */
+size_t device_table_compile(const Device* list, int count, const char* node_id, uint8_t* out, size_t capacity) {
+    const char* rooms[DEVICE_TABLE_MAX_ROOMS];
+    const char* names[DEVICE_TABLE_MAX_NAMES];
+    uint8_t room_of[DEVICE_TABLE_MAX_DEVICES];
+    uint8_t name_of[DEVICE_TABLE_MAX_DEVICES];
+    int room_count = 0;
+    int name_count = 0;
+    if (count > DEVICE_TABLE_MAX_DEVICES) {
+        return 0;
+    }
+
+    // 房间和设备名按首次出现的顺序编号
+    for (int i = 0; i < count; i++) {
+        int r = 0;
+        while (r < room_count && strcmp(rooms[r], list[i].room_id) != 0) r++;
+        if (r == room_count) {
+            if (room_count == DEVICE_TABLE_MAX_ROOMS) return 0;
+            rooms[room_count++] = list[i].room_id;
+        }
+        int n = 0;
+        while (n < name_count && strcmp(names[n], list[i].device_id) != 0) n++;
+        if (n == name_count) {
+            if (name_count == DEVICE_TABLE_MAX_NAMES) return 0;
+            names[name_count++] = list[i].device_id;
+        }
+        room_of[i] = r;
+        name_of[i] = n;
+    }
+
+    // 布局：头部 | 房间偏移 | 设备名偏移 | 设备项（4字节对齐） | 下标 | 字符串
+    size_t rooms_offset = sizeof(DeviceTableHeader);
+    size_t names_offset = rooms_offset + room_count * 2;
+    size_t entries_offset = (names_offset + name_count * 2 + 3) & ~(size_t)3;
+    size_t index_offset = entries_offset + count * sizeof(DeviceTableEntry);
+    size_t size = index_offset + room_count * name_count;
+    for (int r = 0; r < room_count; r++) size += strlen(rooms[r]) + 1;
+    for (int n = 0; n < name_count; n++) size += strlen(names[n]) + 1;
+    if (size > capacity || size > 0xFFFF) {
+        return 0;
+    }
+    memset(out, 0, size);
+
+    size_t strings = index_offset + room_count * name_count;
+    uint16_t* room_offsets = (uint16_t*)(out + rooms_offset);
+    for (int r = 0; r < room_count; r++) {
+        room_offsets[r] = (uint16_t)strings;
+        strcpy((char*)out + strings, rooms[r]);
+        strings += strlen(rooms[r]) + 1;
+    }
+    uint16_t* name_offsets = (uint16_t*)(out + names_offset);
+    for (int n = 0; n < name_count; n++) {
+        name_offsets[n] = (uint16_t)strings;
+        strcpy((char*)out + strings, names[n]);
+        strings += strlen(names[n]) + 1;
+    }
+
+    DeviceTableEntry* entries = (DeviceTableEntry*)(out + entries_offset);
+    uint8_t* index = out + index_offset;
+    memset(index, DEVICE_TABLE_NONE, room_count * name_count);
+    for (int i = 0; i < count; i++) {
+        uint8_t& slot = index[room_of[i] * name_count + name_of[i]];
+        if (slot != DEVICE_TABLE_NONE) {
+            return 0;   // 同一房间的设备名重复
+        }
+        slot = (uint8_t)i;
+        entries[i].room = room_of[i];
+        entries[i].name = name_of[i];
+        entries[i].pin = list[i].pin;
+        entries[i].flags = list[i].is_virtual ? DEVICE_TABLE_FLAG_VIRTUAL : 0;
+    }
+
+    DeviceTableHeader* header = (DeviceTableHeader*)out;
+    header->magic = DEVICE_TABLE_MAGIC;
+    header->version = DEVICE_TABLE_VERSION;
+    header->size = (uint16_t)size;
+    strncpy(header->node_id, node_id, sizeof(header->node_id) - 1);
+    header->device_count = (uint8_t)count;
+    header->room_count = (uint8_t)room_count;
+    header->name_count = (uint8_t)name_count;
+    header->rooms_offset = (uint16_t)rooms_offset;
+    header->names_offset = (uint16_t)names_offset;
+    header->entries_offset = (uint16_t)entries_offset;
+    header->index_offset = (uint16_t)index_offset;
+    header->crc32 = device_table_crc32(out + sizeof(DeviceTableHeader), size - sizeof(DeviceTableHeader));
+    return size;
+}
+
+/**
+ * @brief 映射devtable分区并校验其中的设备表
+ * @return false表示分区不存在或内容无效（例如尚未写入，全为0xFF）
+ */
+bool device_table_map_partition() {
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, DEVICE_TABLE_PARTITION_SUBTYPE,
+                                                                DEVICE_TABLE_PARTITION_LABEL);
+    if (partition == nullptr) {
+        return false;
+    }
+    const void* data = nullptr;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &data, &handle) != ESP_OK) {
+        return false;
+    }
+    // 设备表在运行期间一直使用，映射不释放
+    if (!device_table_attach((const uint8_t*)data, partition->size, true)) {
+        spi_flash_munmap(handle);
+        LOG_WARN("[DevTable] Partition '%s' holds no valid device table", DEVICE_TABLE_PARTITION_LABEL);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 加载设备表并生成devices[]，需在setup_devices()之前调用一次
+ * @return false表示没有可用的设备表（内置设备列表也无法编译），本节点不控制任何设备
+ */
+bool load_device_table() {
+    uint32_t start = micros();
+    if (!device_table_map_partition()) {
+        size_t size = device_table_compile(builtin_devices, BUILTIN_DEVICE_COUNT, NODE_ID, device_table_ram, sizeof(device_table_ram));
+        if (size == 0 || !device_table_attach(device_table_ram, size, false)) {
+            LOG_ERROR("[DevTable-ERROR] Built-in device list does not fit the device table");
+            device_count = 0;
+            return false;
+        }
+    }
+
+    // 设备表中每个不同的房间ID和设备名只驻留一次，设备句柄直接取用编号
+    const DeviceTableHeader* header = device_table.header;
+    for (int i = 0; i < header->room_count; i++) {
+        device_table.room_symbols[i] = intern_room((const char*)device_table.base + device_table.rooms[i]);
+    }
+    for (int i = 0; i < header->name_count; i++) {
+        device_table.type_symbols[i] = intern_device_type((const char*)device_table.base + device_table.names[i]);
+    }
+
+    // 设备项只是把设备表中的编号换成字符串指针，字符串只用于Topic和日志
+    device_count = header->device_count;
+    for (int i = 0; i < device_count; i++) {
+        const DeviceTableEntry& entry = device_table.entries[i];
+        devices[i].room_id = (const char*)device_table.base + device_table.rooms[entry.room];
+        devices[i].device_id = (const char*)device_table.base + device_table.names[entry.name];
+        devices[i].pin = entry.pin;
+        devices[i].is_virtual = (entry.flags & DEVICE_TABLE_FLAG_VIRTUAL) != 0;
+    }
+    if (header->node_id[0] != '\0') {
+        NODE_ID = header->node_id;
+    }
+    device_table.load_us = micros() - start;
+    LOG_INFO("[DevTable] %s: %d device(s) in %d room(s), node %s, loaded in %lu us",
+             device_table.mapped ? "Mapped partition '" DEVICE_TABLE_PARTITION_LABEL "'" : "Built-in device list",
+             device_count, header->room_count, NODE_ID, (unsigned long)device_table.load_us);
+    return true;
+}
+
+/**
+ * @brief 设备所在房间的房间编号
+ * @param device 设备下标（devices[]）
+ */
+inline RoomId device_table_room_symbol(int device) {
+    return device_table.room_symbols[device_table.entries[device].room];
+}
+
+/**
+ * @brief 设备的设备类型编号
+ * @param device 设备下标（devices[]）
+ */
+inline DeviceType device_table_type_symbol(int device) {
+    return device_table.type_symbols[device_table.entries[device].name];
+}
+
+/**
+ * @brief 按房间编号和设备名编号查找设备（O(1)）
+ * @return 设备下标（devices[]），没有该设备时返回-1
+ */
+int device_table_find(int room, int name) {
+    const DeviceTableHeader* header = device_table.header;
+    if (header == nullptr || room < 0 || room >= header->room_count || name < 0 || name >= header->name_count) {
+        return -1;
+    }
+    uint8_t device = device_table.index[room * header->name_count + name];
+    return device == DEVICE_TABLE_NONE ? -1 : device;
+}
+
+/**
+ * @brief 房间ID对应的房间编号（逐个比较，只在启动或测试时使用）
+ * @return 设备表中没有该房间时返回-1
+ */
+int device_table_room(const char* room_id) {
+    for (int i = 0; device_table.header != nullptr && i < device_table.header->room_count; i++) {
+        if (strcmp((const char*)device_table.base + device_table.rooms[i], room_id) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief 设备ID对应的设备名编号（逐个比较，只在启动或测试时使用）
+ * @return 设备表中没有该设备名时返回-1
+ */
+int device_table_name(const char* device_id) {
+    for (int i = 0; device_table.header != nullptr && i < device_table.header->name_count; i++) {
+        if (strcmp((const char*)device_table.base + device_table.names[i], device_id) == 0) return i;
+    }
+    return -1;
+}
+
+#endif // DEVICE_TABLE_H
@@ -0,0 +1,192 @@
+// LoopProfiler.h
+// 任务轮次剖析：记录网络任务和执行任务每一轮的耗时及轮内各部分的耗时，
+// 统计轮次频率、耗时分布（与运行指标相同的2的幂分桶）和最长卡顿；单轮超过阈值时输出卡顿报告，指出耗时最长的部分
+// 每个剖析器只由所属任务写入，其他任务（UI、指标发布）只读取单个32位字段，不需要加锁
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "AsyncLog.h"
+#include "Metrics.h"
+
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+#define LOOP_PROFILER_MAX_SECTIONS  4
+#define LOOP_PROFILER_WINDOW_US     1000000     // 轮次频率的统计窗口
+
+// 供UI显示的摘要
+struct LoopStats {
+    uint32_t hz;                    // 最近一个统计窗口内每秒的轮数
+    uint32_t window_max_us;         // 最近一个统计窗口内最长的一轮
+    uint32_t worst_stall_us;        // 启动以来最长的一轮
+    const char* worst_section;      // 最长一轮中耗时最长的部分
+};
+
+class LoopProfiler {
+public:
+    /**
+     * @param name 任务名称（日志中使用）
+     * @param section_names 各部分名称，顺序与end_section()的参数一致
+     * @param section_count 部分数量（不超过LOOP_PROFILER_MAX_SECTIONS）
+     * @param stall_threshold_us 单轮超过该时长时输出卡顿报告
+     */
+    LoopProfiler(const char* name, const char* const* section_names, uint8_t section_count, uint32_t stall_threshold_us)
+        : name_(name), section_names_(section_names),
+          section_count_(section_count < LOOP_PROFILER_MAX_SECTIONS ? section_count : LOOP_PROFILER_MAX_SECTIONS),
+          stall_threshold_us_(stall_threshold_us), iteration_start_(0), mark_(0), window_start_(0),
+          window_iterations_(0), window_max_us_(0), hz_(0), last_window_max_us_(0), iterations_(0), stalls_(0),
+          worst_stall_us_(0), worst_section_("-") {
+        memset(section_us_, 0, sizeof(section_us_));
+        memset(section_max_us_, 0, sizeof(section_max_us_));
+        memset(buckets_, 0, sizeof(buckets_));
+    }
+
+    /**
+     * @brief 一轮开始
+     */
+    void begin_iteration() {
+        if (!LOOP_PROFILER_ENABLED) {
+            return;
+        }
+        iteration_start_ = micros();
+        mark_ = iteration_start_;
+    }
+
+    /**
+     * @brief 一部分结束：从上一部分结束（或本轮开始）到现在的耗时计入该部分
+     * @param section 部分序号
+     */
+    void end_section(uint8_t section) {
+        if (!LOOP_PROFILER_ENABLED) {
+            return;
+        }
+        unsigned long now = micros();
+        if (section < section_count_) {
+            section_us_[section] += (uint32_t)(now - mark_);
+        }
+        mark_ = now;
+    }
+
+    /**
+     * @brief 一轮结束：更新统计，超过阈值时输出卡顿报告
+     */
+    void end_iteration() {
+        if (!LOOP_PROFILER_ENABLED) {
+            return;
+        }
+        unsigned long now = micros();
+        uint32_t duration = (uint32_t)(now - iteration_start_);
+        buckets_[metrics_bucket(duration)]++;
+        iterations_++;
+
+        uint8_t slowest = 0;
+        for (uint8_t i = 0; i < section_count_; i++) {
+            if (section_us_[i] > section_max_us_[i]) {
+                section_max_us_[i] = section_us_[i];
+            }
+            if (section_us_[i] > section_us_[slowest]) {
+                slowest = i;
+            }
+        }
+        if (duration > worst_stall_us_) {
+            worst_stall_us_ = duration;
+            worst_section_ = section_count_ > 0 ? section_names_[slowest] : "-";
+        }
+        if (duration >= stall_threshold_us_) {
+            stalls_++;
+            report_stall(duration, slowest);
+        }
+
+        if (duration > window_max_us_) {
+            window_max_us_ = duration;
+        }
+        window_iterations_++;
+        if (now - window_start_ >= LOOP_PROFILER_WINDOW_US) {
+            hz_ = (uint32_t)((uint64_t)window_iterations_ * 1000000 / (uint32_t)(now - window_start_));
+            last_window_max_us_ = window_max_us_;
+            window_start_ = now;
+            window_iterations_ = 0;
+            window_max_us_ = 0;
+        }
+        memset(section_us_, 0, sizeof(section_us_));
+    }
+
+    /**
+     * @brief 单轮耗时的分位数（所在桶的上界，单位微秒）
+     * @param percent 百分位，如50、99
+     */
+    uint32_t percentile_us(uint8_t percent) const {
+        uint32_t total = iterations_;
+        if (total == 0) {
+            return 0;
+        }
+        uint32_t target = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < METRICS_BUCKET_COUNT; i++) {
+            seen += buckets_[i];
+            if (seen >= target) {
+                return i == 0 ? 0 : (i == METRICS_BUCKET_COUNT - 1 ? worst_stall_us_ : (1u << i) - 1);
+            }
+        }
+        return worst_stall_us_;
+    }
+
+    LoopStats stats() const {
+        LoopStats stats = { hz_, last_window_max_us_, worst_stall_us_, worst_section_ };
+        return stats;
+    }
+
+    const char* name() const { return name_; }
+    uint32_t iterations() const { return iterations_; }
+    uint32_t stalls() const { return stalls_; }
+    uint8_t section_count() const { return section_count_; }
+    const char* section_name(uint8_t section) const { return section_names_[section]; }
+    uint32_t section_max_us(uint8_t section) const { return section_max_us_[section]; }
+
+private:
+    const char* name_;
+    const char* const* section_names_;
+    uint8_t section_count_;
+    uint32_t stall_threshold_us_;
+
+    unsigned long iteration_start_;
+    unsigned long mark_;
+    uint32_t section_us_[LOOP_PROFILER_MAX_SECTIONS];       // 本轮各部分耗时
+    uint32_t section_max_us_[LOOP_PROFILER_MAX_SECTIONS];   // 启动以来各部分单轮最长耗时
+
+    unsigned long window_start_;
+    uint32_t window_iterations_;
+    uint32_t window_max_us_;
+    uint32_t hz_;
+    uint32_t last_window_max_us_;
+
+    uint32_t iterations_;
+    uint32_t stalls_;
+    uint32_t buckets_[METRICS_BUCKET_COUNT];
+    uint32_t worst_stall_us_;
+    const char* worst_section_;
+
+    /**
+     * @brief 卡顿报告：本轮总耗时、耗时最长的部分以及各部分耗时
+     * 例：[Profiler] executor stall 212.4 ms, slowest: ui (commands 0.1, servo 0.0, ui 212.2, telemetry 0.1 ms)
+     */
+    void report_stall(uint32_t duration, uint8_t slowest) {
+        char sections[LOG_LINE_MAX / 2];
+        size_t length = 0;
+        for (uint8_t i = 0; i < section_count_ && length < sizeof(sections); i++) {
+            int n = snprintf(sections + length, sizeof(sections) - length, "%s%s %.1f", i ? ", " : "",
+                             section_names_[i], section_us_[i] / 1000.0f);
+            if (n < 0) {
+                break;
+            }
+            length += n;
+        }
+        sections[sizeof(sections) - 1] = '\0';
+        LOG_WARN("[Profiler] %s stall %.1f ms, slowest: %s (%s ms)", name_, duration / 1000.0f,
+                 section_count_ > 0 ? section_names_[slowest] : "-", sections);
+    }
+};
+
+#endif // LOOP_PROFILER_H
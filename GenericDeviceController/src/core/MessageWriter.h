@@ -0,0 +1,280 @@
+// MessageWriter.h
+// 流式消息写入器：不构建JSON文档，直接把字段按JSON或MessagePack编码写入任意Print流
+// 同一段序列化代码先写入ByteCounter得到长度，再写入PubSubClient的beginPublish()/write()/endPublish()流
+#ifndef MESSAGE_WRITER_H
+#define MESSAGE_WRITER_H
+
+#include <Arduino.h>
+
+#define MESSAGE_WRITER_MAX_DEPTH  8     // 对象/数组最大嵌套层数
+#define MESSAGE_CHUNK_SIZE        64    // 写入网络流前的合并缓冲区大小
+
+/**
+ * @brief 只统计字节数的Print，用于在beginPublish()前计算消息长度
+ */
+class ByteCounter : public Print {
+public:
+    size_t count = 0;
+    size_t write(uint8_t) override { count++; return 1; }
+    size_t write(const uint8_t*, size_t size) override { count += size; return size; }
+};
+
+/**
+ * @brief 固定大小的合并缓冲区：把零散的小段写入合并成较大的块再交给下游流，
+ * 避免PubSubClient::write()逐字节调用WiFiClient发送
+ */
+class ChunkedPrint : public Print {
+public:
+    explicit ChunkedPrint(Print& target) : target_(target), used_(0) {}
+
+    size_t write(uint8_t c) override {
+        if (used_ == MESSAGE_CHUNK_SIZE) {
+            flush_chunk();
+        }
+        chunk_[used_++] = c;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        size_t remaining = size;
+        while (remaining > 0) {
+            if (used_ == MESSAGE_CHUNK_SIZE) {
+                flush_chunk();
+            }
+            size_t n = MESSAGE_CHUNK_SIZE - used_;
+            if (n > remaining) {
+                n = remaining;
+            }
+            memcpy(chunk_ + used_, data, n);
+            used_ += n;
+            data += n;
+            remaining -= n;
+        }
+        return size;
+    }
+
+    /**
+     * @brief 把缓冲区中剩余的数据写入下游流
+     */
+    void flush_chunk() {
+        if (used_ > 0) {
+            target_.write(chunk_, used_);
+            used_ = 0;
+        }
+    }
+
+private:
+    Print& target_;
+    uint8_t chunk_[MESSAGE_CHUNK_SIZE];
+    size_t used_;
+};
+
+/**
+ * @brief 流式消息写入器，支持JSON和MessagePack两种编码
+ * MessagePack的map/array头需要预先知道元素个数，因此begin_object()/begin_array()需传入个数；JSON编码忽略该参数
+ */
+class MessageWriter {
+public:
+    MessageWriter(Print& out, bool msgpack) : out_(out), msgpack_(msgpack), depth_(0), has_element_(0), after_key_(false) {}
+
+    void begin_object(uint8_t field_count) {
+        begin_value();
+        if (msgpack_) {
+            write_container_header(0x80, 0xDE, field_count);
+        } else {
+            out_.write('{');
+        }
+        push();
+    }
+
+    void end_object() {
+        pop();
+        if (!msgpack_) {
+            out_.write('}');
+        }
+    }
+
+    void begin_array(uint8_t element_count) {
+        begin_value();
+        if (msgpack_) {
+            write_container_header(0x90, 0xDC, element_count);
+        } else {
+            out_.write('[');
+        }
+        push();
+    }
+
+    void end_array() {
+        pop();
+        if (!msgpack_) {
+            out_.write(']');
+        }
+    }
+
+    void key(const char* name) {
+        if (!msgpack_ && (has_element_ & depth_bit())) {
+            out_.write(',');
+        }
+        has_element_ |= depth_bit();
+        write_string(name);
+        if (!msgpack_) {
+            out_.write(':');
+        }
+        after_key_ = true;
+    }
+
+    void value(const char* s) {
+        begin_value();
+        if (s == nullptr) {
+            write_null();
+        } else {
+            write_string(s);
+        }
+    }
+
+    void value(int v) {
+        begin_value();
+        if (msgpack_) {
+            write_msgpack_int(v);
+        } else {
+            char buf[12];
+            int n = snprintf(buf, sizeof(buf), "%d", v);
+            out_.write((const uint8_t*)buf, n);
+        }
+    }
+
+    void value(float v) {
+        begin_value();
+        if (!isfinite(v)) {
+            // NaN和±inf在两种格式中都输出为null（JSON没有inf，"%.2f"会输出无效的inf）
+            write_null();
+        } else if (msgpack_) {
+            uint32_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            uint8_t buf[5] = { 0xCA, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits };
+            out_.write(buf, sizeof(buf));
+        } else {
+            // 保留两位小数并去掉末尾的0，如26.10 -> 26.1，70.00 -> 70
+            char buf[24];
+            int n = snprintf(buf, sizeof(buf), "%.2f", v);
+            while (n > 0 && buf[n - 1] == '0') n--;
+            if (n > 0 && buf[n - 1] == '.') n--;
+            out_.write((const uint8_t*)buf, n);
+        }
+    }
+
+    void value(bool v) {
+        begin_value();
+        if (msgpack_) {
+            out_.write((uint8_t)(v ? 0xC3 : 0xC2));
+        } else {
+            out_.print(v ? "true" : "false");
+        }
+    }
+
+private:
+    Print& out_;
+    bool msgpack_;
+    uint8_t depth_;
+    uint8_t has_element_;   // 每层一位：该层是否已写入元素（JSON逗号）
+    bool after_key_;        // 刚写完对象的键，下一个值不需要逗号
+
+    uint8_t depth_bit() const { return (uint8_t)(1u << depth_); }
+
+    void push() {
+        if (depth_ < MESSAGE_WRITER_MAX_DEPTH - 1) {
+            depth_++;
+        }
+        has_element_ &= (uint8_t)~depth_bit();
+    }
+
+    void pop() {
+        if (depth_ > 0) {
+            depth_--;
+        }
+    }
+
+    // 对象中的值紧跟在键之后；数组中的值需要在元素之间加逗号
+    void begin_value() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (depth_ > 0) {
+            if (!msgpack_ && (has_element_ & depth_bit())) {
+                out_.write(',');
+            }
+            has_element_ |= depth_bit();
+        }
+    }
+
+    void write_null() {
+        if (msgpack_) {
+            out_.write((uint8_t)0xC0);
+        } else {
+            out_.print("null");
+        }
+    }
+
+    void write_container_header(uint8_t fix_type, uint8_t type16, uint8_t count) {
+        if (count < 16) {
+            out_.write((uint8_t)(fix_type | count));
+        } else {
+            uint8_t buf[3] = { type16, 0, count };
+            out_.write(buf, sizeof(buf));
+        }
+    }
+
+    void write_msgpack_int(int v) {
+        if (v >= 0 && v < 128) {
+            out_.write((uint8_t)v);
+        } else if (v < 0 && v >= -32) {
+            out_.write((uint8_t)(int8_t)v);
+        } else {
+            uint32_t u = (uint32_t)v;
+            uint8_t buf[5] = { 0xD2, (uint8_t)(u >> 24), (uint8_t)(u >> 16), (uint8_t)(u >> 8), (uint8_t)u };
+            out_.write(buf, sizeof(buf));
+        }
+    }
+
+    void write_string(const char* s) {
+        size_t len = strlen(s);
+        if (msgpack_) {
+            if (len < 32) {
+                out_.write((uint8_t)(0xA0 | len));
+            } else if (len < 256) {
+                uint8_t buf[2] = { 0xD9, (uint8_t)len };
+                out_.write(buf, sizeof(buf));
+            } else {
+                uint8_t buf[3] = { 0xDA, (uint8_t)(len >> 8), (uint8_t)len };
+                out_.write(buf, sizeof(buf));
+            }
+            out_.write((const uint8_t*)s, len);
+            return;
+        }
+
+        // JSON：整段写入无需转义的字符，遇到需要转义的字符再单独处理
+        out_.write('"');
+        const char* run = s;
+        for (const char* p = s; *p; p++) {
+            uint8_t c = (uint8_t)*p;
+            if (c != '"' && c != '\\' && c >= 0x20) {
+                continue;
+            }
+            out_.write((const uint8_t*)run, p - run);
+            if (c == '"' || c == '\\') {
+                out_.write('\\');
+                out_.write(c);
+            } else {
+                char esc[7];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out_.write((const uint8_t*)esc, 6);
+            }
+            run = p + 1;
+        }
+        out_.write((const uint8_t*)run, s + len - run);
+        out_.write('"');
+    }
+};
+
+#endif // MESSAGE_WRITER_H
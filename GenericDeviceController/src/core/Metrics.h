@@ -0,0 +1,133 @@
+// Metrics.h
+// 运行指标：命令处理各阶段的延迟直方图、消息计数、错误码计数，由网络任务定期发布到smarthome/<NODE_ID>/metrics
+// 直方图按2的幂分桶（单位微秒），记录一次只需一次micros()、一次前导零计数和两次加法，可在正式固件中保持开启；
+// 每个阶段和计数只由一个任务写入，且只增不减（累计值），发布时直接读取，不需要加锁，由接收方对相邻两次取差值
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+// 桶0为0us，桶i（1 <= i < METRICS_BUCKET_COUNT-1）为[2^(i-1), 2^i)us，最后一个桶为2^24us（约16.8秒）及以上
+#define METRICS_BUCKET_COUNT    26
+#define METRICS_ERROR_CODE_MAX  16      // 分别计数的错误码种类，超出的计入other
+
+// 命令处理的各阶段
+enum MetricsStage : uint8_t {
+    STAGE_ROUTE,        // (网络任务) Topic查路由表
+    STAGE_PARSE,        // (网络任务) 命令解析（单设备命令原地解析，批量命令JSON/MessagePack解码）
+    STAGE_QUEUE,        // (执行任务) 收到命令到开始执行：队列、调度等待，含等待同一舵机结束
+    STAGE_HANDLER,      // (执行任务) 设备处理函数，含GPIO/LEDC写入
+    STAGE_SERVO,        // (执行任务) 舵机运动序列
+    STAGE_SERIALIZE,    // (网络任务) 回执编码（统计长度的一遍）
+    STAGE_PUBLISH,      // (网络任务) beginPublish()到endPublish()，含流式编码与写入连接
+    STAGE_ACK,          // (网络任务) 收到命令到回执发布完成，只统计立即完成的单设备命令
+    STAGE_COUNT
+};
+
+/**
+ * @brief 阶段名称，用作指标消息中的键名
+ */
+inline const char* metrics_stage_name(uint8_t stage) {
+    static const char* const NAMES[STAGE_COUNT] = {
+        "route", "parse", "queue", "handler", "servo", "serialize", "publish", "ack"
+    };
+    return stage < STAGE_COUNT ? NAMES[stage] : "unknown";
+}
+
+struct StageHistogram {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t buckets[METRICS_BUCKET_COUNT];
+};
+
+struct ErrorCodeCount {
+    const char* code;   // 错误码均为静态字符串
+    uint32_t count;
+};
+
+struct NodeMetrics {
+    StageHistogram stages[STAGE_COUNT];
+    uint32_t messages_received;     // (网络任务) callback()收到的消息
+    uint32_t messages_published;    // (网络任务) 发布成功的消息（回执、遥测、指标）
+    uint32_t publish_failed;        // (网络任务) 发布失败的消息
+    ErrorCodeCount errors[METRICS_ERROR_CODE_MAX];  // (网络任务) 错误回执按错误码计数
+    uint8_t error_code_count;
+    uint32_t errors_other;
+};
+
+inline NodeMetrics& node_metrics() {
+    static NodeMetrics metrics;
+    return metrics;
+}
+
+/**
+ * @brief 阶段计时起点；关闭指标时返回0，不调用micros()
+ */
+inline unsigned long metrics_now() {
+    return METRICS_ENABLED ? micros() : 0;
+}
+
+/**
+ * @brief 耗时对应的直方图桶
+ */
+inline uint8_t metrics_bucket(uint32_t us) {
+    uint8_t bucket = us == 0 ? 0 : (uint8_t)(32 - __builtin_clz(us));
+    return bucket < METRICS_BUCKET_COUNT ? bucket : METRICS_BUCKET_COUNT - 1;
+}
+
+/**
+ * @brief 记录一次阶段耗时
+ * @param stage 阶段
+ * @param duration_us 耗时（微秒）
+ */
+inline void metrics_record_duration(MetricsStage stage, uint32_t duration_us) {
+    if (!METRICS_ENABLED) {
+        return;
+    }
+    StageHistogram& histogram = node_metrics().stages[stage];
+    histogram.buckets[metrics_bucket(duration_us)]++;
+    histogram.count++;
+    if (duration_us > histogram.max_us) {
+        histogram.max_us = duration_us;
+    }
+}
+
+/**
+ * @brief 记录从start_us（metrics_now()的返回值）到现在的阶段耗时
+ */
+inline void metrics_record(MetricsStage stage, unsigned long start_us) {
+    if (!METRICS_ENABLED) {
+        return;
+    }
+    metrics_record_duration(stage, (uint32_t)(micros() - start_us));
+}
+
+/**
+ * @brief (网络任务) 错误回执计数
+ * @param error_code 错误码
+ */
+inline void metrics_count_error(const char* error_code) {
+    if (!METRICS_ENABLED) {
+        return;
+    }
+    NodeMetrics& metrics = node_metrics();
+    for (uint8_t i = 0; i < metrics.error_code_count; i++) {
+        if (metrics.errors[i].code == error_code || strcmp(metrics.errors[i].code, error_code) == 0) {
+            metrics.errors[i].count++;
+            return;
+        }
+    }
+    if (metrics.error_code_count < METRICS_ERROR_CODE_MAX) {
+        metrics.errors[metrics.error_code_count].code = error_code;
+        metrics.errors[metrics.error_code_count].count = 1;
+        metrics.error_code_count++;
+    } else {
+        metrics.errors_other++;
+    }
+}
+
+#endif // METRICS_H
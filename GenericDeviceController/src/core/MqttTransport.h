@@ -0,0 +1,210 @@
+// MqttTransport.h
+// MQTT连接的非阻塞建立：TCP连接和CONNECT/CONNACK握手都由网络任务分步轮询，每一步只做一次零超时的select()或非阻塞读取，
+// Broker宕机或无响应时不会阻塞网络任务。握手完成后再调用PubSubClient::connect()：
+// 传输层已连接时PubSubClient跳过TCP连接，它发出的CONNECT被丢弃，等待CONNACK时直接读到已收到的CONNACK，立即返回
+#ifndef MQTT_TRANSPORT_H
+#define MQTT_TRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <errno.h>
+#include <lwip/sockets.h>
+
+// 分步操作的结果
+enum TransportStatus : uint8_t {
+    TRANSPORT_PENDING,  // 尚未完成，下一轮继续轮询
+    TRANSPORT_DONE,     // 已完成
+    TRANSPORT_FAILED    // 失败，连接已关闭
+};
+
+#define MQTT_CONNACK_LEN        4
+#define MQTT_CONNACK_INVALID    0xFF    // 连接被关闭或收到的不是CONNACK
+
+/**
+ * @brief PubSubClient使用的传输层：在WiFiClient之上增加非阻塞连接和握手
+ * 只允许经begin_connect()/poll_connect()建立连接，PubSubClient自身发起的阻塞连接直接失败
+ */
+class MqttTransport : public WiFiClient {
+public:
+    MqttTransport() : pending_fd_(-1), primed_len_(0), primed_pos_(0), discard_write_(false) {}
+
+    /**
+     * @brief 发起非阻塞TCP连接
+     * @param ip Broker地址
+     * @param port Broker端口
+     * @return false表示无法创建套接字或连接立即失败
+     */
+    bool begin_connect(const IPAddress& ip, uint16_t port) {
+        stop();
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = (uint32_t)ip;
+        addr.sin_port = htons(port);
+        if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+            close(fd);
+            return false;
+        }
+        pending_fd_ = fd;
+        return true;
+    }
+
+    /**
+     * @brief 轮询TCP连接是否建立（零超时）
+     * @return 连接建立后套接字交给WiFiClient管理
+     */
+    TransportStatus poll_connect() {
+        if (pending_fd_ < 0) {
+            return TRANSPORT_FAILED;
+        }
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(pending_fd_, &writable);
+        struct timeval no_wait = {0, 0};
+        int ready = select(pending_fd_ + 1, nullptr, &writable, nullptr, &no_wait);
+        if (ready == 0) {
+            return TRANSPORT_PENDING;
+        }
+
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+        if (ready < 0 || getsockopt(pending_fd_, SOL_SOCKET, SO_ERROR, &error, &error_len) < 0 || error != 0) {
+            close(pending_fd_);
+            pending_fd_ = -1;
+            return TRANSPORT_FAILED;
+        }
+        // 与WiFiClient::connect()一致，连接建立后恢复阻塞模式，收发行为与原来相同
+        fcntl(pending_fd_, F_SETFL, fcntl(pending_fd_, F_GETFL, 0) & ~O_NONBLOCK);
+        WiFiClient::operator=(WiFiClient(pending_fd_));
+        pending_fd_ = -1;
+        return TRANSPORT_DONE;
+    }
+
+    /**
+     * @brief 发送CONNECT（MQTT 3.1.1，无用户名、密码和遗嘱），与PubSubClient::connect()生成的报文一致
+     * @param client_id 客户端ID（不超过23字节）
+     * @param clean_session 是否清除会话
+     * @param keep_alive 心跳间隔（秒），须与PubSubClient的设置一致
+     * @return false表示发送失败
+     */
+    bool send_connect(const char* client_id, bool clean_session, uint16_t keep_alive) {
+        uint8_t packet[40];
+        size_t id_len = strlen(client_id);
+        size_t remaining = 10 + 2 + id_len;
+        if (2 + remaining > sizeof(packet)) {
+            return false;
+        }
+        size_t n = 0;
+        packet[n++] = 0x10;                     // CONNECT
+        packet[n++] = (uint8_t)remaining;
+        packet[n++] = 0x00;
+        packet[n++] = 0x04;
+        memcpy(&packet[n], "MQTT", 4);
+        n += 4;
+        packet[n++] = 0x04;                     // 协议级别：3.1.1
+        packet[n++] = clean_session ? 0x02 : 0x00;
+        packet[n++] = (uint8_t)(keep_alive >> 8);
+        packet[n++] = (uint8_t)(keep_alive & 0xFF);
+        packet[n++] = (uint8_t)(id_len >> 8);
+        packet[n++] = (uint8_t)(id_len & 0xFF);
+        memcpy(&packet[n], client_id, id_len);
+        n += id_len;
+        return WiFiClient::write(packet, n) == n;
+    }
+
+    /**
+     * @brief 轮询CONNACK（不阻塞）。收到后暂存，供随后的PubSubClient::connect()读取
+     * @param session_present 输出：Broker是否保留了之前的会话
+     * @param return_code 输出：CONNACK返回码，0表示接受；连接关闭或报文错误时为MQTT_CONNACK_INVALID
+     * @return 返回码非0时为TRANSPORT_FAILED
+     */
+    TransportStatus poll_connack(bool* session_present, uint8_t* return_code) {
+        *return_code = MQTT_CONNACK_INVALID;
+        if (WiFiClient::available() < MQTT_CONNACK_LEN) {
+            if (!WiFiClient::connected()) {
+                stop();
+                return TRANSPORT_FAILED;
+            }
+            return TRANSPORT_PENDING;
+        }
+        if (WiFiClient::read(primed_, MQTT_CONNACK_LEN) != MQTT_CONNACK_LEN || primed_[0] != 0x20 || primed_[1] != 0x02) {
+            stop();
+            return TRANSPORT_FAILED;
+        }
+        *session_present = (primed_[2] & 0x01) != 0;
+        *return_code = primed_[3];
+        if (*return_code != 0) {
+            stop();
+            return TRANSPORT_FAILED;
+        }
+        primed_len_ = MQTT_CONNACK_LEN;
+        primed_pos_ = 0;
+        discard_write_ = true;
+        return TRANSPORT_DONE;
+    }
+
+    // PubSubClient自身发起的阻塞连接一律失败，连接只能经begin_connect()建立
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override { return 0; }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (discard_write_) {
+            // 握手已完成，PubSubClient::connect()发出的CONNECT不再发送
+            discard_write_ = false;
+            return size;
+        }
+        return WiFiClient::write(buf, size);
+    }
+
+    int available() override {
+        return (primed_len_ - primed_pos_) + WiFiClient::available();
+    }
+
+    int read() override {
+        if (primed_pos_ < primed_len_) {
+            return primed_[primed_pos_++];
+        }
+        return WiFiClient::read();
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        size_t n = 0;
+        while (n < size && primed_pos_ < primed_len_) {
+            buf[n++] = primed_[primed_pos_++];
+        }
+        if (n == size) {
+            return n;
+        }
+        int rest = WiFiClient::read(buf + n, size - n);
+        if (rest <= 0) {
+            return n > 0 ? (int)n : rest;
+        }
+        return (int)n + rest;
+    }
+
+    void stop() override {
+        if (pending_fd_ >= 0) {
+            close(pending_fd_);
+            pending_fd_ = -1;
+        }
+        primed_len_ = 0;
+        primed_pos_ = 0;
+        discard_write_ = false;
+        WiFiClient::stop();
+    }
+
+private:
+    int pending_fd_;                        // 正在连接的套接字，-1表示没有
+    uint8_t primed_[MQTT_CONNACK_LEN];      // 已收到、尚未被PubSubClient读取的CONNACK
+    uint8_t primed_len_;
+    uint8_t primed_pos_;
+    bool discard_write_;                    // 丢弃下一次写入（PubSubClient::connect()的CONNECT）
+};
+
+#endif // MQTT_TRANSPORT_H
@@ -0,0 +1,57 @@
+// PayloadCodec.h
+// 消息编码层：命令和回执支持JSON与MessagePack两种格式
+// 节点按收到命令的首字节自动识别格式，并以相同格式发布后续回执，实现与上位机的逐节点协商
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+enum PayloadFormat : uint8_t {
+    PAYLOAD_JSON = 0,
+    PAYLOAD_MSGPACK = 1
+};
+
+// 当前回执格式：启动时为Config.h中的默认值，之后跟随最近一条命令的格式
+PayloadFormat payload_format = (PayloadFormat)MQTT_PAYLOAD_FORMAT;
+
+/**
+ * @brief 判断消息是否为MessagePack编码
+ * 命令负载顶层必须是对象：JSON以'{'开头，MessagePack以map类型字节(0x80-0x8F, 0xDE, 0xDF)开头
+ * @param payload 消息内容
+ * @param length 消息长度
+ * @return true表示MessagePack
+ */
+inline bool is_msgpack_payload(const byte* payload, unsigned int length) {
+    if (length == 0) {
+        return false;
+    }
+    byte first = payload[0];
+    return (first & 0xF0) == 0x80 || first == 0xDE || first == 0xDF;
+}
+
+/**
+ * @brief 解码命令负载，并将回执格式切换为命令所用的格式
+ * @param doc 输出文档
+ * @param payload 消息内容
+ * @param length 消息长度
+ * @return 解析结果
+ */
+DeserializationError decode_payload(JsonDocument& doc, byte* payload, unsigned int length) {
+    if (is_msgpack_payload(payload, length)) {
+        payload_format = PAYLOAD_MSGPACK;
+        return deserializeMsgPack(doc, payload, length);
+    }
+    payload_format = PAYLOAD_JSON;
+    return deserializeJson(doc, payload, length);
+}
+
+/**
+ * @brief 解码失败时的错误描述（错误代码仍为JSON_PARSE_ERROR，与上位机保持兼容）
+ * @return 错误描述
+ */
+const char* payload_format_error_message() {
+    return payload_format == PAYLOAD_MSGPACK ? "Invalid MessagePack format" : "Invalid JSON format";
+}
+
+#endif // PAYLOAD_CODEC_H
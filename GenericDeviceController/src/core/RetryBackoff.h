@@ -0,0 +1,45 @@
+// RetryBackoff.h
+// 带上限和随机抖动的指数退避：连续失败时重试间隔按2倍增长，直到上限；
+// 每次间隔在[上限值/2, 上限值]之间随机取值，Broker或路由器重启后各节点不会同时重连
+#ifndef RETRY_BACKOFF_H
+#define RETRY_BACKOFF_H
+
+#include <Arduino.h>
+
+class RetryBackoff {
+public:
+    /**
+     * @param base_ms 第一次重试的间隔上限
+     * @param max_ms 重试间隔的上限
+     */
+    RetryBackoff(uint32_t base_ms, uint32_t max_ms) : base_ms_(base_ms), max_ms_(max_ms), attempts_(0) {}
+
+    /**
+     * @brief 计算下一次重试的间隔，并累计失败次数
+     * @return 间隔（毫秒）
+     */
+    uint32_t next_delay_ms() {
+        uint32_t ceiling = base_ms_ << attempts_;
+        if (ceiling >= max_ms_) {
+            ceiling = max_ms_;
+        } else {
+            attempts_++;
+        }
+        // 随机数来自ESP32硬件随机数发生器，同时上电的节点也会得到不同的间隔
+        return ceiling / 2 + (uint32_t)random((long)(ceiling / 2 + 1));
+    }
+
+    /**
+     * @brief 连接成功后复位，下次断线从base_ms重新开始
+     */
+    void reset() {
+        attempts_ = 0;
+    }
+
+private:
+    uint32_t base_ms_;
+    uint32_t max_ms_;
+    uint8_t attempts_;      // 连续失败次数（间隔到达上限后不再增加，移位不会溢出）
+};
+
+#endif // RETRY_BACKOFF_H
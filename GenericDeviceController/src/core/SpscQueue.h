@@ -0,0 +1,68 @@
+// SpscQueue.h
+// 单生产者、单消费者的无锁队列：网络任务与执行任务之间传递命令和回执
+// 元素按值复制进固定大小的数组，不分配内存；生产者只写head_，消费者只写tail_，无需加锁或关中断
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 固定容量的环形队列
+ * @tparam T 元素类型（按值复制，应为不含指针所有权的平凡结构体）
+ * @tparam Capacity 容量（必须是2的幂）
+ */
+template <typename T, uint32_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    /**
+     * @brief 放入一个元素（仅由生产者任务调用）
+     * @param item 元素
+     * @return false表示队列已满，元素未放入
+     */
+    bool push(const T& item) {
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+        if (head - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE) == Capacity) {
+            return false;
+        }
+        items_[head & (Capacity - 1)] = item;
+        __atomic_store_n(&head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief 取出一个元素（仅由消费者任务调用）
+     * @param item 输出元素
+     * @return false表示队列为空
+     */
+    bool pop(T& item) {
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&head_, __ATOMIC_ACQUIRE) == tail) {
+            return false;
+        }
+        item = items_[tail & (Capacity - 1)];
+        __atomic_store_n(&tail_, tail + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief 队列中的元素数（另一任务同时操作时只是近似值）
+     */
+    uint32_t size() const {
+        return __atomic_load_n(&head_, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    }
+
+    bool full() const {
+        return __atomic_load_n(&head_, __ATOMIC_RELAXED) - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE) == Capacity;
+    }
+
+private:
+    T items_[Capacity];
+    uint32_t head_;     // 已放入的元素数（生产者）
+    uint32_t tail_;     // 已取出的元素数（消费者）
+};
+
+#endif // SPSC_QUEUE_H
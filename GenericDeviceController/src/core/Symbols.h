@@ -0,0 +1,118 @@
+// Symbols.h
+// 房间与设备类型的符号表：房间ID和设备ID只在网络边界（加载设备表、解析批量命令、未命中路由表的Topic）各转换一次为小整数编号，
+// 之后的HAL、命令分发、传感器数据和UI都以编号直接索引数组，不再比较字符串。
+// 本文件只有枚举、constexpr和inline函数，可同时被core/中的头文件与sensorsimulator/中的.cpp包含
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <Arduino.h>
+
+// =================== 字符串哈希 ===================
+#define FNV_OFFSET_BASIS    2166136261u
+#define FNV_PRIME           16777619u
+
+/**
+ * @brief FNV-1a哈希（C++11 constexpr递归形式，可在编译期求值）
+ * @param s 以'\0'结尾的字符串
+ * @param h 初始哈希值
+ * @return 32位哈希值
+ */
+constexpr uint32_t fnv1a_hash(const char* s, uint32_t h = FNV_OFFSET_BASIS) {
+    return *s ? fnv1a_hash(s + 1, (h ^ (uint8_t)*s) * FNV_PRIME) : h;
+}
+
+/**
+ * @brief FNV-1a哈希的运行时迭代版本，结果与fnv1a_hash()一致
+ * @param s 以'\0'结尾的字符串
+ * @param h 初始哈希值
+ * @return 32位哈希值
+ */
+inline uint32_t hash_string(const char* s, uint32_t h = FNV_OFFSET_BASIS) {
+    while (*s) {
+        h = (h ^ (uint8_t)*s++) * FNV_PRIME;
+    }
+    return h;
+}
+
+// =================== 房间 ===================
+// X(枚举名, 房间ID, 界面显示名)，顺序即房间编号；房间ID必须与上位机device_registry.py一致
+#define ROOM_SYMBOLS(X) \
+    X(LIVINGROOM, "livingroom", "客厅") \
+    X(BEDROOM,    "bedroom",    "卧室") \
+    X(KITCHEN,    "kitchen",    "厨房") \
+    X(BATHROOM,   "bathroom",   "浴室") \
+    X(OUTDOOR,    "outdoor",    "室外")
+
+#define ROOM_SYMBOL_ENUM(name, id, label) ROOM_##name,
+enum RoomId : int8_t {
+    ROOM_NONE = -1,     // 不在符号表中的房间（设备表中可以有，但没有传感器数据和空调状态）
+    ROOM_SYMBOLS(ROOM_SYMBOL_ENUM)
+    ROOM_COUNT
+};
+#undef ROOM_SYMBOL_ENUM
+
+/**
+ * @brief 房间ID转换为房间编号（一次哈希和一次确认比较）
+ * @return 不在符号表中时返回ROOM_NONE
+ */
+inline RoomId intern_room(const char* room_id) {
+    #define ROOM_SYMBOL_CASE(name, id, label) \
+        case fnv1a_hash(id): return strcmp(room_id, id) == 0 ? ROOM_##name : ROOM_NONE;
+    switch (hash_string(room_id)) {
+        ROOM_SYMBOLS(ROOM_SYMBOL_CASE)
+        default: return ROOM_NONE;
+    }
+    #undef ROOM_SYMBOL_CASE
+}
+
+/**
+ * @brief 房间编号对应的房间ID
+ * @return 编号无效时返回nullptr
+ */
+inline const char* room_symbol_id(int room) {
+    #define ROOM_SYMBOL_ID(name, id, label) id,
+    static const char* const IDS[ROOM_COUNT] = { ROOM_SYMBOLS(ROOM_SYMBOL_ID) };
+    #undef ROOM_SYMBOL_ID
+    return room >= 0 && room < ROOM_COUNT ? IDS[room] : nullptr;
+}
+
+/**
+ * @brief 房间编号对应的界面显示名
+ * @return 编号无效时返回"未知"
+ */
+inline const char* room_symbol_label(int room) {
+    #define ROOM_SYMBOL_LABEL(name, id, label) label,
+    static const char* const LABELS[ROOM_COUNT] = { ROOM_SYMBOLS(ROOM_SYMBOL_LABEL) };
+    #undef ROOM_SYMBOL_LABEL
+    return room >= 0 && room < ROOM_COUNT ? LABELS[room] : "未知";
+}
+
+// =================== 设备类型 ===================
+// 设备ID即设备类型；节点配置中NODE_DEVICE_TYPES登记的类型必须出现在这里
+#define DEVICE_TYPE_SYMBOLS(X) \
+    X(light) X(bedside_light) X(ac) X(window) X(curtain) X(door) X(hood) X(fan) X(oven) \
+    X(temp_sensor) X(humidity_sensor) X(brightness_sensor) X(smoke_sensor) X(gas_sensor) X(sensors)
+
+#define DEVICE_TYPE_SYMBOL_ENUM(type) DEVICE_TYPE_##type,
+enum DeviceType : int8_t {
+    DEVICE_TYPE_NONE = -1,
+    DEVICE_TYPE_SYMBOLS(DEVICE_TYPE_SYMBOL_ENUM)
+    DEVICE_TYPE_COUNT
+};
+#undef DEVICE_TYPE_SYMBOL_ENUM
+
+/**
+ * @brief 设备ID转换为设备类型编号（一次哈希和一次确认比较）
+ * @return 不在符号表中时返回DEVICE_TYPE_NONE
+ */
+inline DeviceType intern_device_type(const char* device_id) {
+    #define DEVICE_TYPE_SYMBOL_CASE(type) \
+        case fnv1a_hash(#type): return strcmp(device_id, #type) == 0 ? DEVICE_TYPE_##type : DEVICE_TYPE_NONE;
+    switch (hash_string(device_id)) {
+        DEVICE_TYPE_SYMBOLS(DEVICE_TYPE_SYMBOL_CASE)
+        default: return DEVICE_TYPE_NONE;
+    }
+    #undef DEVICE_TYPE_SYMBOL_CASE
+}
+
+#endif // SYMBOLS_H
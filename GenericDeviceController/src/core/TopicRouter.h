@@ -0,0 +1,155 @@
+// TopicRouter.h
+// 命令Topic路由表：启动时为每个设备预先生成命令Topic和状态Topic，并按命令Topic哈希排序，
+// 收到消息时对Topic做一次哈希+二分查找即可得到设备句柄和处理函数，无需sscanf和逐项字符串比较
+#ifndef TOPIC_ROUTER_H
+#define TOPIC_ROUTER_H
+
+#include <Arduino.h>
+
+#define TOPIC_MAX_LEN 64    // 命令Topic最大长度(含结束符)
+
+// 路由表项
+struct DeviceRoute {
+    uint32_t topic_hash;                // 命令Topic的FNV-1a哈希
+    uint8_t topic_len;                  // 命令Topic长度
+    const DeviceHandle* handle;         // 设备句柄（引脚、舵机通道、房间索引）
+    DeviceHandler handler;              // 设备类型处理函数，本节点不支持该类型时为nullptr
+    char command_topic[TOPIC_MAX_LEN];  // 命令Topic，订阅时直接使用
+    char state_topic[TOPIC_MAX_LEN];    // 状态Topic，发布回执时直接使用
+};
+
+// 路由表，按topic_hash升序排列
+DeviceRoute device_routes[DEVICE_TABLE_MAX_DEVICES];
+int route_count = 0;
+int8_t device_route_index[DEVICE_TABLE_MAX_DEVICES];   // 设备下标对应的路由表项下标，-1表示没有路由
+
+/**
+ * @brief 同时计算字符串的FNV-1a哈希和长度（单次遍历）
+ * @param s 以'\0'结尾的字符串
+ * @param len 输出字符串长度
+ * @return 32位哈希值
+ */
+inline uint32_t hash_string_len(const char* s, size_t* len) {
+    uint32_t h = FNV_OFFSET_BASIS;
+    const char* p = s;
+    while (*p) {
+        h = (h ^ (uint8_t)*p++) * FNV_PRIME;
+    }
+    *len = p - s;
+    return h;
+}
+
+/**
+ * @brief 根据设备句柄建立路由表，需在setup_devices()之后调用一次
+ */
+void build_device_routes() {
+    route_count = 0;
+    for (int i = 0; i < device_count; i++) {
+        DeviceRoute& route = device_routes[route_count];
+        int n = snprintf(route.command_topic, sizeof(route.command_topic), "smarthome/%s/%s/command",
+                         devices[i].room_id, devices[i].device_id);
+        int m = snprintf(route.state_topic, sizeof(route.state_topic), "smarthome/%s/%s/state",
+                         devices[i].room_id, devices[i].device_id);
+        if (n <= 0 || n >= (int)sizeof(route.command_topic) || m <= 0 || m >= (int)sizeof(route.state_topic)) {
+            LOG_ERROR("[Router-ERROR] Topic too long for %s/%s", devices[i].room_id, devices[i].device_id);
+            continue;
+        }
+
+        size_t len;
+        route.topic_hash = hash_string_len(route.command_topic, &len);
+        route.topic_len = (uint8_t)len;
+        route.handle = &device_handles[i];
+        route.handler = lookup_device_handler(device_handles[i].type);
+
+        // 插入排序，保持按哈希升序
+        DeviceRoute inserted = route;
+        int j = route_count;
+        while (j > 0 && device_routes[j - 1].topic_hash > inserted.topic_hash) {
+            device_routes[j] = device_routes[j - 1];
+            j--;
+        }
+        device_routes[j] = inserted;
+        route_count++;
+    }
+
+    for (int i = 0; i < device_count; i++) {
+        device_route_index[i] = -1;
+    }
+    for (int i = 0; i < route_count; i++) {
+        device_route_index[device_routes[i].handle - device_handles] = (int8_t)i;
+    }
+    LOG_INFO("[Router] %d command routes built", route_count);
+}
+
+/**
+ * @brief (私有辅助函数) 二分查找第一个哈希不小于h的路由表项
+ * @param h Topic哈希
+ * @return 表项下标
+ */
+int route_lower_bound(uint32_t h) {
+    int lo = 0, hi = route_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (device_routes[mid].topic_hash < h) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief 根据命令Topic查找路由
+ * @param topic 收到消息的Topic
+ * @return 路由表项，不是本节点设备的Topic时返回nullptr
+ */
+const DeviceRoute* find_route(const char* topic) {
+    size_t len;
+    uint32_t h = hash_string_len(topic, &len);
+
+    // 哈希相同的表项再确认一次完整Topic，排除哈希冲突
+    for (int i = route_lower_bound(h); i < route_count && device_routes[i].topic_hash == h; i++) {
+        if (device_routes[i].topic_len == len && memcmp(device_routes[i].command_topic, topic, len) == 0) {
+            return &device_routes[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 设备下标对应的路由（舵机运动结束等已知设备的场合，直接索引）
+ * @param device 设备下标（devices[]）
+ * @return 路由表项，该设备没有路由（Topic过长）时返回nullptr
+ */
+const DeviceRoute* device_route(int device) {
+    if (device < 0 || device >= device_count || device_route_index[device] < 0) {
+        return nullptr;
+    }
+    return &device_routes[device_route_index[device]];
+}
+
+/**
+ * @brief 根据房间ID和设备ID查找路由（网络任务解析批量命令时调用，无需拼接Topic字符串）
+ * @param room_id 房间ID
+ * @param device_id 设备ID
+ * @return 路由表项，不是本节点设备时返回nullptr
+ */
+const DeviceRoute* find_device_route(const char* room_id, const char* device_id) {
+    // 分段哈希，结果与对"smarthome/{room}/{device}/command"整体哈希一致
+    uint32_t h = hash_string("smarthome/");
+    h = hash_string(room_id, h);
+    h = hash_string("/", h);
+    h = hash_string(device_id, h);
+    h = hash_string("/command", h);
+
+    for (int i = route_lower_bound(h); i < route_count && device_routes[i].topic_hash == h; i++) {
+        const Device* device = device_routes[i].handle->device;
+        if (strcmp(device->room_id, room_id) == 0 && strcmp(device->device_id, device_id) == 0) {
+            return &device_routes[i];
+        }
+    }
+    return nullptr;
+}
+
+#endif // TOPIC_ROUTER_H
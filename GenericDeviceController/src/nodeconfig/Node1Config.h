@@ -16,7 +16,7 @@ const int MQTT_PORT = 1883;
 const char* NODE_ID = "ESP32_Node_1";
 
 // 1. 定义这个节点控制的设备总数（仅物理设备）
-#define DEVICE_COUNT 11
+#define BUILTIN_DEVICE_COUNT 11
 
 // 2. 定义设备结构体，包含room_id，用于支持多个房间
 struct Device {
@@ -26,12 +26,13 @@ struct Device {
     bool is_virtual;  // 标记是否为虚拟设备（如传感器）
 };
 
-// 3. 初始化此节点控制的所有设备列表
+// 3. 初始化此节点控制的所有设备列表（内置设备表）
+// 启动时优先使用devtable分区中的设备表（tools/device_table.py由本文件生成），分区为空或无效时使用这里的列表
 // 需要将GPIO引脚号修改为你实际连接的引脚
 // 虚拟设备（传感器）的pin设为0，is_virtual设为true
 // ⚠️ 重要：设备ID必须与上位机device_registry.py保持完全一致！
-// 系统使用字符串比较来匹配设备，任何不一致都会导致控制失败
-Device devices[DEVICE_COUNT] = {
+// 命令Topic中的房间ID和设备ID按字符串匹配，任何不一致都会导致控制失败
+const Device builtin_devices[BUILTIN_DEVICE_COUNT] = {
     // --- 客厅设备 ---
     { "livingroom", "light", 25, false }, // 客厅灯
     // { "livingroom", "ac",    23, false }, // 客厅空调
@@ -57,6 +58,11 @@ Device devices[DEVICE_COUNT] = {
     { "bathroom", "fan",   32, false }, // 卫生间排气扇
     // { "bathroom", "door", 12, false } // 卫生间门 - 已禁用
 };
+
+// 4. 本节点支持的设备类型，用于在编译期生成命令分发表（core/CommandDispatch.h）
+// 新增设备类型时在此和core/Symbols.h的DEVICE_TYPE_SYMBOLS中登记，并在CommandDispatch.h中实现对应的handle_<类型>()函数
+#define NODE_DEVICE_TYPES(X) \
+    X(light) X(bedside_light) X(window) X(curtain) X(hood) X(fan)
 // ===============================================
 
 #endif // NODE_1_CONFIG_H
\ No newline at end of file
@@ -16,7 +16,7 @@ const int MQTT_PORT = 1883;
 const char* NODE_ID = "ESP32_Node_2";
 
 // 1. 定义这个节点控制的设备总数（主要是虚拟传感器）
-#define DEVICE_COUNT 17
+#define BUILTIN_DEVICE_COUNT 22
 
 // 2. 定义设备结构体，包含room_id，用于支持多个房间
 struct Device {
@@ -26,12 +26,13 @@ struct Device {
     bool is_virtual;  // 标记是否为虚拟设备（如传感器）
 };
 
-// 3. 初始化此节点控制的所有设备列表
+// 3. 初始化此节点控制的所有设备列表（内置设备表）
+// 启动时优先使用devtable分区中的设备表（tools/device_table.py由本文件生成），分区为空或无效时使用这里的列表
 // 需要将GPIO引脚号修改为你实际连接的引脚
 // 传感器是虚拟设备，pin设为0，is_virtual设为true
 // ⚠️ 重要：设备ID必须与上位机device_registry.py保持完全一致！
-// 系统使用字符串比较来匹配设备，任何不一致都会导致控制失败
-Device devices[DEVICE_COUNT] = {
+// 命令Topic中的房间ID和设备ID按字符串匹配，任何不一致都会导致控制失败
+const Device builtin_devices[BUILTIN_DEVICE_COUNT] = {
     // --- 各房间传感器 ---
     { "livingroom", "temp_sensor", 0, true }, // 客厅温度传感器（虚拟）
     { "livingroom", "humidity_sensor", 0, true }, // 客厅湿度传感器（虚拟）
@@ -53,9 +54,21 @@ Device devices[DEVICE_COUNT] = {
     { "outdoor", "humidity_sensor", 0, true }, // 室外湿度传感器（虚拟）
     { "outdoor", "brightness_sensor", 0, true }, // 室外亮度传感器（虚拟）
     { "kitchen", "smoke_sensor", 0, true }, // 厨房烟雾传感器（虚拟）
-    { "kitchen", "gas_sensor", 0, true } // 厨房燃气泄漏传感器（虚拟）
+    { "kitchen", "gas_sensor", 0, true }, // 厨房燃气泄漏传感器（虚拟）
+
+    // --- 各房间传感器快照（READ_ALL一次返回该房间全部传感器数据） ---
+    { "livingroom", "sensors", 0, true },
+    { "bedroom", "sensors", 0, true },
+    { "kitchen", "sensors", 0, true },
+    { "bathroom", "sensors", 0, true },
+    { "outdoor", "sensors", 0, true }
     // 注意：此节点专注于UI显示和传感器数据，不控制物理设备
 };
+
+// 4. 本节点支持的设备类型，用于在编译期生成命令分发表（core/CommandDispatch.h）
+// 新增设备类型时在此和core/Symbols.h的DEVICE_TYPE_SYMBOLS中登记，并在CommandDispatch.h中实现对应的handle_<类型>()函数
+#define NODE_DEVICE_TYPES(X) \
+    X(temp_sensor) X(humidity_sensor) X(brightness_sensor) X(smoke_sensor) X(gas_sensor) X(ac) X(sensors)
 // ===============================================
 
 #endif // NODE_2_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "FrameCanvas.h"
+#include <driver/gpio.h>
+
+// ST7735命令
+static const uint8_t ST7735_CMD_CASET = 0x2A;   // 列地址窗口
+static const uint8_t ST7735_CMD_RASET = 0x2B;   // 行地址窗口
+static const uint8_t ST7735_CMD_RAMWR = 0x2C;   // 写显存
+
+// DC引脚由SPI驱动在每个事务开始前设置（中断上下文），事务的user字段为DC电平：0=命令，1=数据
+static int8_t frameCanvasDcPin = -1;
+
+static void IRAM_ATTR frameCanvasPreTransfer(spi_transaction_t* transaction) {
+    gpio_set_level((gpio_num_t)frameCanvasDcPin, (uint32_t)(intptr_t)transaction->user);
+}
+
+FrameCanvas::FrameCanvas(uint16_t width, uint16_t height)
+    : GFXcanvas16(width, height),
+      device_(nullptr),
+      queued_(0),
+      flushCount_(0),
+      flushedRows_(0) {
+    memset(transactions_, 0, sizeof(transactions_));
+    memset(dirtyRows_, 0, sizeof(dirtyRows_));
+}
+
+bool FrameCanvas::begin(int8_t sclk, int8_t mosi, int8_t cs, int8_t dc, int clock_hz) {
+    if (getBuffer() == nullptr) {
+        return false;
+    }
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = mosi;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = sclk;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = width() * height() * sizeof(uint16_t);
+    if (spi_bus_initialize(FRAME_CANVAS_SPI_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+        return false;
+    }
+
+    spi_device_interface_config_t device = {};
+    device.mode = 0;
+    device.clock_speed_hz = clock_hz;
+    device.spics_io_num = cs;
+    device.queue_size = FRAME_CANVAS_TRANSACTIONS;
+    device.pre_cb = frameCanvasPreTransfer;
+    if (spi_bus_add_device(FRAME_CANVAS_SPI_HOST, &device, &device_) != ESP_OK) {
+        device_ = nullptr;
+        spi_bus_free(FRAME_CANVAS_SPI_HOST);
+        return false;
+    }
+    frameCanvasDcPin = dc;
+
+    // 屏幕上仍是直接绘制的内容，第一次刷新发送整帧
+    markDirty(0, height() - 1);
+    return true;
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    GFXcanvas16::drawPixel(x, y, panelColor(color));
+    markDirty(y, y);
+}
+
+void FrameCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    GFXcanvas16::drawFastVLine(x, y, h, panelColor(color));
+    markDirty(y, y + h - 1);
+}
+
+void FrameCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    GFXcanvas16::drawFastHLine(x, y, w, panelColor(color));
+    markDirty(y, y);
+}
+
+void FrameCanvas::fillScreen(uint16_t color) {
+    GFXcanvas16::fillScreen(panelColor(color));
+    markDirty(0, height() - 1);
+}
+
+void FrameCanvas::drawGlyph(int16_t x, int16_t y, const uint8_t* bitmap, uint8_t w, uint8_t h, uint16_t panel_color) {
+    uint16_t* buffer = getBuffer();
+    if (buffer == nullptr || x >= width() || y >= height() || x + w <= 0 || y + h <= 0) {
+        return;
+    }
+    uint8_t rowBytes = (w + 7) / 8;
+    for (uint8_t row = 0; row < h; row++, bitmap += rowBytes) {
+        int16_t py = y + row;
+        if (py < 0 || py >= height()) {
+            continue;
+        }
+        uint16_t* line = buffer + py * width();
+        for (uint8_t col = 0; col < w; col++) {
+            int16_t px = x + col;
+            if ((bitmap[col >> 3] & (0x80 >> (col & 7))) && px >= 0 && px < width()) {
+                line[px] = panel_color;
+            }
+        }
+    }
+    markDirty(y, y + h - 1);
+}
+
+uint16_t FrameCanvas::pixel(int16_t x, int16_t y) const {
+    return panelColor(getPixel(x, y));   // 高低字节互换，转换是对称的
+}
+
+void FrameCanvas::markDirty(int16_t top, int16_t bottom) {
+    if (top < 0) top = 0;
+    if (bottom >= height()) bottom = height() - 1;
+    if (bottom >= FRAME_CANVAS_MAX_ROWS) bottom = FRAME_CANVAS_MAX_ROWS - 1;
+    for (int16_t row = top; row <= bottom; row++) {
+        dirtyRows_[row >> 5] |= 1u << (row & 31);
+    }
+}
+
+void FrameCanvas::flush(bool dirty_rows_only) {
+    if (device_ == nullptr) {
+        return;
+    }
+    int16_t rows = height() < FRAME_CANVAS_MAX_ROWS ? height() : FRAME_CANVAS_MAX_ROWS;
+    int16_t first = 0;
+    while (first < rows && !rowDirty(first)) {
+        first++;
+    }
+    if (first == rows) {
+        return;
+    }
+    waitFlush();
+
+    if (!dirty_rows_only) {
+        queueBand(0, height() - 1);
+    } else {
+        uint8_t bands = 0;
+        int16_t row = first;
+        while (row < rows) {
+            if (!rowDirty(row)) {
+                row++;
+                continue;
+            }
+            // 向后合并间隔较小的改动行；段数用尽时剩余的改动全部并入当前段
+            int16_t top = row;
+            int16_t bottom = row;
+            for (int16_t next = row + 1; next < rows; next++) {
+                if (!rowDirty(next)) {
+                    continue;
+                }
+                if (next - bottom > FRAME_CANVAS_MERGE_GAP && bands < FRAME_CANVAS_MAX_BANDS - 1) {
+                    break;
+                }
+                bottom = next;
+            }
+            queueBand(top, bottom);
+            bands++;
+            row = bottom + 1;
+        }
+    }
+
+    flushCount_++;
+    memset(dirtyRows_, 0, sizeof(dirtyRows_));
+}
+
+void FrameCanvas::queueBand(int16_t top, int16_t bottom) {
+    int16_t right = width() - 1;
+    const uint8_t columns[4] = {0, 0, (uint8_t)(right >> 8), (uint8_t)right};
+    const uint8_t rows[4] = {(uint8_t)(top >> 8), (uint8_t)top, (uint8_t)(bottom >> 8), (uint8_t)bottom};
+
+    // 地址窗口为整行宽度，这些行在画布中连续存放，像素数据用一个DMA事务发送
+    queueCommand(ST7735_CMD_CASET, columns, sizeof(columns));
+    queueCommand(ST7735_CMD_RASET, rows, sizeof(rows));
+    queueCommand(ST7735_CMD_RAMWR, nullptr, 0);
+    queueData(getBuffer() + top * width(), (size_t)(bottom - top + 1) * width() * sizeof(uint16_t), false);
+    flushedRows_ += bottom - top + 1;
+}
+
+void FrameCanvas::waitFlush() {
+    while (queued_ > 0) {
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result(device_, &done, portMAX_DELAY) != ESP_OK) {
+            break;
+        }
+        queued_--;
+    }
+    queued_ = 0;
+}
+
+void FrameCanvas::queueCommand(uint8_t command, const uint8_t* args, uint8_t argCount) {
+    spi_transaction_t& transaction = transactions_[queued_];
+    memset(&transaction, 0, sizeof(transaction));
+    transaction.flags = SPI_TRANS_USE_TXDATA;
+    transaction.length = 8;
+    transaction.tx_data[0] = command;
+    transaction.user = (void*)0;
+    if (spi_device_queue_trans(device_, &transaction, portMAX_DELAY) == ESP_OK) {
+        queued_++;
+    }
+    if (argCount > 0) {
+        queueData(args, argCount, true);
+    }
+}
+
+void FrameCanvas::queueData(const void* data, size_t length, bool inline_data) {
+    spi_transaction_t& transaction = transactions_[queued_];
+    memset(&transaction, 0, sizeof(transaction));
+    transaction.length = length * 8;
+    transaction.user = (void*)1;
+    if (inline_data) {
+        // 参数不超过4字节，随事务描述符一起发送，调用方的缓冲区可以立即释放
+        transaction.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(transaction.tx_data, data, length);
+    } else {
+        transaction.tx_buffer = data;
+    }
+    if (spi_device_queue_trans(device_, &transaction, portMAX_DELAY) == ESP_OK) {
+        queued_++;
+    }
+}
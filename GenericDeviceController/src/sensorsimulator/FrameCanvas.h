@@ -0,0 +1,83 @@
+#ifndef FRAME_CANVAS_H
+#define FRAME_CANVAS_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <driver/spi_master.h>
+
+// 离屏帧缓冲：界面先绘制到内存中的16位画布（128×160，40KB），再由SPI DMA在后台写入ST7735，
+// 传输期间CPU继续执行命令和处理MQTT。画布按屏幕的字节序（高字节在前）保存像素，DMA直接发送画布内存，无需逐像素转换；
+// 绘制时按行记录改动，刷新时可以只发送改动过的行：相邻的改动行合并为一段，每段设置一次地址窗口后用一个DMA事务发送
+
+#define FRAME_CANVAS_SPI_HOST       VSPI_HOST   // 与TFT引脚（VSPI原生引脚）一致
+#define FRAME_CANVAS_MAX_ROWS       160
+#define FRAME_CANVAS_MAX_BANDS      3           // 一次刷新最多发送的段数，超出的改动并入最后一段
+#define FRAME_CANVAS_MERGE_GAP      8           // 间隔不超过该行数的两段合并（少一组地址窗口命令比少发几行更划算）
+#define FRAME_CANVAS_BAND_TRANSACTIONS 6        // 每段：CASET、RASET各含命令和参数两个事务，RAMWR命令，像素数据
+#define FRAME_CANVAS_TRANSACTIONS   (FRAME_CANVAS_MAX_BANDS * FRAME_CANVAS_BAND_TRANSACTIONS)
+
+class FrameCanvas : public GFXcanvas16 {
+public:
+    FrameCanvas(uint16_t width, uint16_t height);
+
+    /**
+     * @brief 在屏幕所在的SPI总线上建立DMA传输通道（屏幕已由Adafruit_ST7735完成初始化，且Arduino SPI已释放总线）
+     * @param sclk/mosi/cs/dc 屏幕引脚
+     * @param clock_hz SPI时钟
+     * @return false表示画布内存分配失败或SPI总线初始化失败，调用方应继续直接绘制到屏幕
+     */
+    bool begin(int8_t sclk, int8_t mosi, int8_t cs, int8_t dc, int clock_hz);
+
+    // 绘制：颜色转为屏幕字节序后写入画布，并记录改动的行
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    /**
+     * @brief 透明背景绘制1位点阵字形（GlyphAtlas格式），点阵中的像素直接写入画布，整个字形只记录一次改动行
+     * @param panel_color 已转换为屏幕字节序的颜色（panelColor()），同一字符串的各字形只需转换一次
+     */
+    void drawGlyph(int16_t x, int16_t y, const uint8_t* bitmap, uint8_t w, uint8_t h, uint16_t panel_color);
+
+    /**
+     * @brief 常规字节序转为屏幕字节序（高字节在前）
+     */
+    static uint16_t panelColor(uint16_t color) { return (uint16_t)((color << 8) | (color >> 8)); }
+
+    /**
+     * @brief 启动一次刷新，把画布送往屏幕后立即返回，传输由DMA在后台完成
+     * @param dirty_rows_only true时只发送上次刷新以来改动过的行，false时发送整帧
+     */
+    void flush(bool dirty_rows_only);
+
+    /**
+     * @brief 等待上一次刷新完成；再次绘制前必须调用，否则正在发送的行可能被改写
+     */
+    void waitFlush();
+
+    /**
+     * @brief 画布中的像素（常规字节序），供主机测试检查帧内容
+     */
+    uint16_t pixel(int16_t x, int16_t y) const;
+
+    bool ready() const { return device_ != nullptr; }
+    uint32_t flushCount() const { return flushCount_; }
+    uint32_t flushedRows() const { return flushedRows_; }   // 启动以来发送的行数
+
+private:
+    spi_device_handle_t device_;
+    spi_transaction_t transactions_[FRAME_CANVAS_TRANSACTIONS];
+    uint8_t queued_;            // 已送入队列、尚未取回结果的事务数
+    uint32_t dirtyRows_[(FRAME_CANVAS_MAX_ROWS + 31) / 32];  // 上次刷新以来改动过的行
+    uint32_t flushCount_;
+    uint32_t flushedRows_;
+
+    void markDirty(int16_t top, int16_t bottom);
+    bool rowDirty(int16_t row) const { return dirtyRows_[row >> 5] & (1u << (row & 31)); }
+    void queueBand(int16_t top, int16_t bottom);
+    void queueCommand(uint8_t command, const uint8_t* args, uint8_t argCount);
+    void queueData(const void* data, size_t length, bool inline_data);
+};
+
+#endif // FRAME_CANVAS_H
@@ -0,0 +1,75 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <Arduino.h>
+
+// UI字形图集：只包含界面实际用到的字符（编译前由tools/glyph_atlas.py扫描UIController.cpp中的界面字符串，
+// 从U8g2的wqy12字体中提取），代替整套GB2312字体。按码点经完美哈希直接定位字形，无需逐个查找字体中的字符表；
+// 位图为1位点阵（逐行、每行按字节补齐、高位在前），与Adafruit_GFX的drawBitmap()格式相同
+
+/**
+ * @brief 字形度量与位图位置
+ */
+struct GlyphInfo {
+    uint16_t codepoint;
+    uint8_t width;
+    uint8_t height;
+    int8_t left;        // 位图左边相对光标的偏移
+    int8_t top;         // 位图顶部相对基线的偏移（基线以上为负）
+    uint8_t advance;    // 绘制后光标前进的宽度
+    uint16_t offset;    // 位图在GLYPH_ATLAS_BITMAPS中的起始字节
+};
+
+#include "GlyphAtlasData.h"
+
+#define GLYPH_ATLAS_EMPTY_SLOT      0xFF
+#define GLYPH_ATLAS_FALLBACK_WIDE   12      // 图集中没有的字符按空白跳过的宽度
+#define GLYPH_ATLAS_FALLBACK_NARROW 6
+
+/**
+ * @brief 查找字形
+ * @return 图集中没有该字符时返回nullptr
+ */
+inline const GlyphInfo* glyph_atlas_find(uint32_t codepoint) {
+    uint8_t index = GLYPH_ATLAS_SLOTS[(uint32_t)(codepoint * GLYPH_ATLAS_HASH_MULTIPLIER) >> (32 - GLYPH_ATLAS_HASH_BITS)];
+    if (index == GLYPH_ATLAS_EMPTY_SLOT || GLYPH_ATLAS_GLYPHS[index].codepoint != codepoint) {
+        return nullptr;
+    }
+    return &GLYPH_ATLAS_GLYPHS[index];
+}
+
+inline const uint8_t* glyph_atlas_bitmap(const GlyphInfo& glyph) {
+    return GLYPH_ATLAS_BITMAPS + glyph.offset;
+}
+
+/**
+ * @brief 读取一个UTF-8字符并前移指针；遇到不完整的序列时只跳过首字节
+ */
+inline uint32_t utf8_next(const char*& text) {
+    uint8_t lead = (uint8_t)*text++;
+    uint8_t extra = lead < 0x80 ? 0 : (lead & 0xE0) == 0xC0 ? 1 : (lead & 0xF0) == 0xE0 ? 2 : (lead & 0xF8) == 0xF0 ? 3 : 0;
+    uint32_t codepoint = extra == 0 ? lead : lead & (0x3F >> extra);
+    for (uint8_t i = 0; i < extra; i++) {
+        if (((uint8_t)text[i] & 0xC0) != 0x80) {
+            return lead;
+        }
+        codepoint = (codepoint << 6) | ((uint8_t)text[i] & 0x3F);
+    }
+    text += extra;
+    return codepoint;
+}
+
+/**
+ * @brief 字符串的显示宽度（像素）
+ */
+inline int glyph_atlas_text_width(const char* text) {
+    int width = 0;
+    while (*text) {
+        uint32_t codepoint = utf8_next(text);
+        const GlyphInfo* glyph = glyph_atlas_find(codepoint);
+        width += glyph ? glyph->advance : (codepoint < 0x80 ? GLYPH_ATLAS_FALLBACK_NARROW : GLYPH_ATLAS_FALLBACK_WIDE);
+    }
+    return width;
+}
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,81 @@
+#include "RotaryEncoder.h"
+#include "../Config.h"
+
+RotaryEncoder::RotaryEncoder()
+    : ready_(false),
+      lastCount_(0),
+      pending_(0),
+      lastActivity_(0) {
+}
+
+bool RotaryEncoder::begin(int pin_a, int pin_b, uint16_t glitch_filter) {
+    // 顺时针时A相领先：A下降沿时B为高、A上升沿时B为低，B下降沿时A为低、B上升沿时A为高，四种边沿都加1；
+    // 逆时针时各边沿对应的控制电平相反，计数减1
+    pcnt_config_t config = {};
+    config.unit = ROTARY_ENCODER_PCNT_UNIT;
+    config.counter_h_lim = ROTARY_ENCODER_COUNT_LIMIT;
+    config.counter_l_lim = -ROTARY_ENCODER_COUNT_LIMIT;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = pin_a;
+    config.ctrl_gpio_num = pin_b;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = pin_b;
+    config.ctrl_gpio_num = pin_a;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+
+    if (glitch_filter > 0) {
+        pcnt_set_filter_value(ROTARY_ENCODER_PCNT_UNIT, glitch_filter);
+        pcnt_filter_enable(ROTARY_ENCODER_PCNT_UNIT);
+    }
+    pcnt_counter_pause(ROTARY_ENCODER_PCNT_UNIT);
+    pcnt_counter_clear(ROTARY_ENCODER_PCNT_UNIT);
+    pcnt_counter_resume(ROTARY_ENCODER_PCNT_UNIT);
+
+    lastCount_ = 0;
+    pending_ = 0;
+    ready_ = true;
+    return true;
+}
+
+int32_t RotaryEncoder::takeSteps(unsigned long now_ms) {
+    if (!ready_) {
+        return 0;
+    }
+    int16_t count = 0;
+    if (pcnt_get_counter_value(ROTARY_ENCODER_PCNT_UNIT, &count) != ESP_OK) {
+        return 0;
+    }
+
+    // 计数器在±ROTARY_ENCODER_COUNT_LIMIT处归零，两次读取之间转过的计数远小于半个量程
+    int32_t delta = (int32_t)count - lastCount_;
+    if (delta > ROTARY_ENCODER_COUNT_LIMIT / 2) {
+        delta -= ROTARY_ENCODER_COUNT_LIMIT;
+    } else if (delta < -ROTARY_ENCODER_COUNT_LIMIT / 2) {
+        delta += ROTARY_ENCODER_COUNT_LIMIT;
+    }
+    lastCount_ = count;
+
+    if (delta != 0) {
+        pending_ += delta;
+        lastActivity_ = now_ms;
+    } else if (pending_ != 0 && now_ms - lastActivity_ > UI_ENCODER_RESYNC_MS) {
+        pending_ = 0;
+    }
+
+    int32_t steps = pending_ / UI_ENCODER_COUNTS_PER_STEP;
+    pending_ -= steps * UI_ENCODER_COUNTS_PER_STEP;
+    return steps;
+}
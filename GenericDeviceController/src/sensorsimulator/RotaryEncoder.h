@@ -0,0 +1,41 @@
+#ifndef ROTARY_ENCODER_H
+#define ROTARY_ENCODER_H
+
+#include <Arduino.h>
+#include <driver/pcnt.h>
+
+// EC11旋钮的硬件解码：脉冲计数器的两个通道分别以A、B相为脉冲输入、另一相为方向控制，
+// 四个边沿都计数（一个正交周期计4），方向由两相的相位关系决定。计数和毛刺滤波都由外设完成，
+// 快速转动时不会像读取电平的中断那样丢步；执行任务每轮读取一次计数，换算为逻辑步数
+
+#define ROTARY_ENCODER_PCNT_UNIT    PCNT_UNIT_0
+#define ROTARY_ENCODER_COUNT_LIMIT  32000       // 计数达到±该值时硬件归零，读数按该模数计算增量
+
+class RotaryEncoder {
+public:
+    RotaryEncoder();
+
+    /**
+     * @brief 配置脉冲计数器并开始计数
+     * @param pin_a/pin_b 编码器A、B相引脚（已设为上拉输入）
+     * @param glitch_filter 毛刺滤波的APB时钟周期数（0~1023，0为不滤波）
+     * @return false表示计数器配置失败
+     */
+    bool begin(int pin_a, int pin_b, uint16_t glitch_filter);
+
+    /**
+     * @brief 取出上次调用以来转过的逻辑步数（顺时针为正），不足一步的计数留到下次
+     * @param now_ms 当前时间，停止转动超过UI_ENCODER_RESYNC_MS时丢弃不足一步的计数
+     */
+    int32_t takeSteps(unsigned long now_ms);
+
+    bool ready() const { return ready_; }
+
+private:
+    bool ready_;
+    int16_t lastCount_;             // 上次读取的计数器值
+    int32_t pending_;               // 尚未换算为步数的计数
+    unsigned long lastActivity_;    // 上次计数变化的时间
+};
+
+#endif // ROTARY_ENCODER_H
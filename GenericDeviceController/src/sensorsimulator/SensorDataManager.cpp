@@ -1,15 +1,26 @@
 #include "SensorDataManager.h"
+#include "../core/AsyncLog.h"
 
 // 全局变量定义
-RoomEnvironment rooms[MAX_ROOMS];
+RoomEnvironment rooms[ROOM_COUNT];
+
+// 每个房间的遥测上报状态
+struct TelemetryState {
+    SensorData last;                 // 上次上报的数据
+    unsigned long last_publish_ms;   // 上次上报时间
+    bool published;                  // 是否已上报过
+};
+
+static TelemetryState telemetry[ROOM_COUNT];
+static SensorTelemetryCallback telemetryCallback = nullptr;
 
 /**
  * @brief 获取指定房间的传感器数据
  * @param room 房间索引
  * @return 传感器数据
  */
-SensorData getSensorData(RoomIndex room) {
-    if (room >= 0 && room < MAX_ROOMS) {
+SensorData getSensorData(RoomId room) {
+    if (room >= 0 && room < ROOM_COUNT) {
         return rooms[room].sensors;
     }
     // 返回错误数据
@@ -17,6 +28,18 @@ SensorData getSensorData(RoomIndex room) {
     return error_data;
 }
 
+/**
+ * @brief 获取指定房间传感器数据的只读指针，避免按值复制整个SensorData
+ * @param room 房间索引
+ * @return 传感器数据指针，房间索引无效时返回nullptr
+ */
+const SensorData* getSensorDataPtr(RoomId room) {
+    if (room >= 0 && room < ROOM_COUNT) {
+        return &rooms[room].sensors;
+    }
+    return nullptr;
+}
+
 /**
  * @brief 设置指定房间的传感器数据（为后续硬件编码器预留）
  * @param room 房间索引
@@ -24,8 +47,8 @@ SensorData getSensorData(RoomIndex room) {
  * @param humidity 湿度值
  * @param brightness 亮度值 (0-100%)
  */
-void setSensorData(RoomIndex room, float temp, float humidity, float brightness, bool smoke, bool gas) {
-    if (room >= 0 && room < MAX_ROOMS) {
+void setSensorData(RoomId room, float temp, float humidity, float brightness, bool smoke, bool gas) {
+    if (room >= 0 && room < ROOM_COUNT) {
         rooms[room].sensors.temperature = temp;
         rooms[room].sensors.humidity = humidity;
         if (brightness != -999.0) {
@@ -33,19 +56,9 @@ void setSensorData(RoomIndex room, float temp, float humidity, float brightness,
         }
         rooms[room].sensors.smoke_detected = smoke;
         rooms[room].sensors.gas_leak = gas;
-        Serial.print("[SensorDataManager] Updated room ");
-        Serial.print(room);
-        Serial.print(": temp=");
-        Serial.print(temp);
-        Serial.print("°C, humidity=");
-        Serial.print(humidity);
-        Serial.print("%, brightness=");
-        Serial.print(rooms[room].sensors.brightness);
-        Serial.print("%, smoke=");
-        Serial.print(smoke ? "true" : "false");
-        Serial.print(", gas=");
-        Serial.print(gas ? "true" : "false");
-        Serial.println();
+        // 编码器每转动一格都会调用，使用调试级别，发布版本中不产生代码
+        LOG_DEBUG("[SensorDataManager] Updated room %d: temp=%.2f°C, humidity=%.2f%%, brightness=%.2f%%, smoke=%s, gas=%s",
+                  (int)room, temp, humidity, rooms[room].sensors.brightness, smoke ? "true" : "false", gas ? "true" : "false");
     }
 }
 
@@ -53,68 +66,94 @@ void setSensorData(RoomIndex room, float temp, float humidity, float brightness,
  * @brief 初始化传感器数据，设置默认值
  */
 void initSensorData() {
-    Serial.println("[SensorDataManager] Initializing sensor data...");
+    LOG_INFO("[SensorDataManager] Initializing sensor data...");
     
     // 客厅默认数据
-    rooms[LIVINGROOM].sensors.temperature = 24.5;
-    rooms[LIVINGROOM].sensors.humidity = 45.2;
-    rooms[LIVINGROOM].sensors.brightness = 65.0;
-    rooms[LIVINGROOM].sensors.smoke_detected = false;
-    rooms[LIVINGROOM].sensors.gas_leak = false;
+    rooms[ROOM_LIVINGROOM].sensors.temperature = 24.5;
+    rooms[ROOM_LIVINGROOM].sensors.humidity = 45.2;
+    rooms[ROOM_LIVINGROOM].sensors.brightness = 65.0;
+    rooms[ROOM_LIVINGROOM].sensors.smoke_detected = false;
+    rooms[ROOM_LIVINGROOM].sensors.gas_leak = false;
     
     // 卧室默认数据
-    rooms[BEDROOM].sensors.temperature = 23.8;
-    rooms[BEDROOM].sensors.humidity = 48.5;
-    rooms[BEDROOM].sensors.brightness = 45.0;
-    rooms[BEDROOM].sensors.smoke_detected = false;
-    rooms[BEDROOM].sensors.gas_leak = false;
+    rooms[ROOM_BEDROOM].sensors.temperature = 23.8;
+    rooms[ROOM_BEDROOM].sensors.humidity = 48.5;
+    rooms[ROOM_BEDROOM].sensors.brightness = 45.0;
+    rooms[ROOM_BEDROOM].sensors.smoke_detected = false;
+    rooms[ROOM_BEDROOM].sensors.gas_leak = false;
     
     // 厨房默认数据
-    rooms[KITCHEN].sensors.temperature = 26.1;
-    rooms[KITCHEN].sensors.humidity = 52.3;
-    rooms[KITCHEN].sensors.brightness = 70.0;
-    rooms[KITCHEN].sensors.smoke_detected = false;
-    rooms[KITCHEN].sensors.gas_leak = false;
+    rooms[ROOM_KITCHEN].sensors.temperature = 26.1;
+    rooms[ROOM_KITCHEN].sensors.humidity = 52.3;
+    rooms[ROOM_KITCHEN].sensors.brightness = 70.0;
+    rooms[ROOM_KITCHEN].sensors.smoke_detected = false;
+    rooms[ROOM_KITCHEN].sensors.gas_leak = false;
     
     // 浴室默认数据
-    rooms[BATHROOM].sensors.temperature = 25.3;
-    rooms[BATHROOM].sensors.humidity = 65.8;
-    rooms[BATHROOM].sensors.brightness = 55.0;
-    rooms[BATHROOM].sensors.smoke_detected = false;
-    rooms[BATHROOM].sensors.gas_leak = false;
+    rooms[ROOM_BATHROOM].sensors.temperature = 25.3;
+    rooms[ROOM_BATHROOM].sensors.humidity = 65.8;
+    rooms[ROOM_BATHROOM].sensors.brightness = 55.0;
+    rooms[ROOM_BATHROOM].sensors.smoke_detected = false;
+    rooms[ROOM_BATHROOM].sensors.gas_leak = false;
     
     // 室外默认数据
-    rooms[OUTDOOR].sensors.temperature = 20.0;
-    rooms[OUTDOOR].sensors.humidity = 60.0;
-    rooms[OUTDOOR].sensors.brightness = 85.0;
-    rooms[OUTDOOR].sensors.smoke_detected = false;
-    rooms[OUTDOOR].sensors.gas_leak = false;
+    rooms[ROOM_OUTDOOR].sensors.temperature = 20.0;
+    rooms[ROOM_OUTDOOR].sensors.humidity = 60.0;
+    rooms[ROOM_OUTDOOR].sensors.brightness = 85.0;
+    rooms[ROOM_OUTDOOR].sensors.smoke_detected = false;
+    rooms[ROOM_OUTDOOR].sensors.gas_leak = false;
     
-    Serial.println("[SensorDataManager] Sensor data initialized successfully");
+    LOG_INFO("[SensorDataManager] Sensor data initialized successfully");
 }
 
-// 房间ID映射表 - 与Node1Config.h中的room_id保持一致
-static const struct {
-    const char* name;
-    RoomIndex index;
-} room_map[] = {
-    {"livingroom", LIVINGROOM},
-    {"bedroom", BEDROOM},
-    {"kitchen", KITCHEN},
-    {"bathroom", BATHROOM},
-    {"outdoor", OUTDOOR}
-};
+/**
+ * @brief 注册遥测上报回调
+ * @param callback 回调函数
+ */
+void setSensorTelemetryCallback(SensorTelemetryCallback callback) {
+    telemetryCallback = callback;
+}
+
+/**
+ * @brief (私有辅助函数) 判断数值变化是否超过死区
+ */
+static bool exceedsDeadband(float current, float last, float deadband) {
+    return fabsf(current - last) >= deadband;
+}
 
 /**
- * @brief 根据房间ID字符串获取房间索引
- * @param room_id 房间ID字符串
- * @return 房间索引，如果未找到返回-1
+ * @brief 检查各房间传感器数据，按死区、最小间隔和心跳决定是否上报，需在执行任务中持续调用
  */
-int getRoomIndex(const char* room_id) {
-    for (int i = 0; i < MAX_ROOMS; i++) {
-        if (strcmp(room_id, room_map[i].name) == 0) {
-            return room_map[i].index;
+void updateSensorTelemetry() {
+    if (telemetryCallback == nullptr) {
+        return;
+    }
+
+    unsigned long now = millis();
+    for (int i = 0; i < ROOM_COUNT; i++) {
+        const SensorData& current = rooms[i].sensors;
+        TelemetryState& state = telemetry[i];
+
+        const char* reason = nullptr;
+        if (!state.published) {
+            // 首次上报，建立基准
+            reason = "heartbeat";
+        } else if (current.smoke_detected != state.last.smoke_detected || current.gas_leak != state.last.gas_leak) {
+            // 烟雾/燃气状态跳变，立即上报
+            reason = "alarm";
+        } else if (now - state.last_publish_ms >= TELEMETRY_MIN_INTERVAL_MS &&
+                   (exceedsDeadband(current.temperature, state.last.temperature, TELEMETRY_DEADBAND_TEMPERATURE) ||
+                    exceedsDeadband(current.humidity, state.last.humidity, TELEMETRY_DEADBAND_HUMIDITY) ||
+                    exceedsDeadband(current.brightness, state.last.brightness, TELEMETRY_DEADBAND_BRIGHTNESS))) {
+            reason = "change";
+        } else if (now - state.last_publish_ms >= TELEMETRY_HEARTBEAT_MS) {
+            reason = "heartbeat";
+        }
+
+        if (reason != nullptr && telemetryCallback((RoomId)i, current, reason)) {
+            state.last = current;
+            state.last_publish_ms = now;
+            state.published = true;
         }
     }
-    return -1;
-} 
\ No newline at end of file
+}
@@ -2,18 +2,7 @@
 #define SENSOR_DATA_MANAGER_H
 
 #include <Arduino.h>
-
-// 房间索引枚举
-enum RoomIndex {
-    LIVINGROOM = 0,
-    BEDROOM = 1,
-    KITCHEN = 2,
-    BATHROOM = 3,
-    OUTDOOR = 4
-};
-
-// 房间数量常量
-#define MAX_ROOMS 5
+#include "../core/Symbols.h"   // 房间编号（RoomId）与HAL、UI共用同一张符号表
 
 // 传感器数据结构
 struct SensorData {
@@ -29,8 +18,37 @@ struct RoomEnvironment {
     SensorData sensors;
 };
 
+// =================== 变化驱动的遥测上报 ===================
+// 死区：与上次上报值的差超过死区才视为变化（可在包含本头文件前重新定义）
+#ifndef TELEMETRY_DEADBAND_TEMPERATURE
+#define TELEMETRY_DEADBAND_TEMPERATURE  0.2     // °C
+#endif
+#ifndef TELEMETRY_DEADBAND_HUMIDITY
+#define TELEMETRY_DEADBAND_HUMIDITY     1.0     // %
+#endif
+#ifndef TELEMETRY_DEADBAND_BRIGHTNESS
+#define TELEMETRY_DEADBAND_BRIGHTNESS   2.0     // %
+#endif
+// 同一房间两次变化上报的最小间隔，烟雾/燃气状态跳变不受此限制
+#ifndef TELEMETRY_MIN_INTERVAL_MS
+#define TELEMETRY_MIN_INTERVAL_MS       1000
+#endif
+// 心跳：数据无变化时，同一房间最长静默时间
+#ifndef TELEMETRY_HEARTBEAT_MS
+#define TELEMETRY_HEARTBEAT_MS          60000
+#endif
+
+/**
+ * @brief 遥测上报回调，由主程序注册并负责发布
+ * @param room 房间索引
+ * @param data 当前传感器数据
+ * @param reason 上报原因："change"、"alarm"或"heartbeat"
+ * @return true表示已发布，false表示未发布（如MQTT未连接），下次更新时重试
+ */
+typedef bool (*SensorTelemetryCallback)(RoomId room, const SensorData& data, const char* reason);
+
 // 全局变量声明
-extern RoomEnvironment rooms[MAX_ROOMS];
+extern RoomEnvironment rooms[ROOM_COUNT];
 
 // 接口函数声明
 /**
@@ -38,7 +56,14 @@ extern RoomEnvironment rooms[MAX_ROOMS];
  * @param room 房间索引
  * @return 传感器数据
  */
-SensorData getSensorData(RoomIndex room);
+SensorData getSensorData(RoomId room);
+
+/**
+ * @brief 获取指定房间传感器数据的只读指针，避免按值复制整个SensorData
+ * @param room 房间索引
+ * @return 传感器数据指针，房间索引无效时返回nullptr
+ */
+const SensorData* getSensorDataPtr(RoomId room);
 
 /**
  * @brief 设置指定房间的传感器数据（为后续硬件编码器预留）
@@ -47,7 +72,7 @@ SensorData getSensorData(RoomIndex room);
  * @param humidity 湿度值
  * @param brightness 亮度值 (0-100%)
  */
-void setSensorData(RoomIndex room, float temp, float humidity, float brightness = -999.0, bool smoke = false, bool gas = false);
+void setSensorData(RoomId room, float temp, float humidity, float brightness = -999.0, bool smoke = false, bool gas = false);
 
 /**
  * @brief 初始化传感器数据，设置默认值
@@ -55,10 +80,14 @@ void setSensorData(RoomIndex room, float temp, float humidity, float brightness
 void initSensorData();
 
 /**
- * @brief 根据房间ID字符串获取房间索引
- * @param room_id 房间ID字符串
- * @return 房间索引，如果未找到返回-1
+ * @brief 注册遥测上报回调
+ * @param callback 回调函数
+ */
+void setSensorTelemetryCallback(SensorTelemetryCallback callback);
+
+/**
+ * @brief 检查各房间传感器数据，按死区、最小间隔和心跳决定是否上报，需在执行任务中持续调用
  */
-int getRoomIndex(const char* room_id);
+void updateSensorTelemetry();
 
 #endif // SENSOR_DATA_MANAGER_H 
\ No newline at end of file
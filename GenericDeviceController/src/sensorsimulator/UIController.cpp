@@ -1,16 +1,16 @@
 #include "UIController.h"
+#include "../core/AsyncLog.h"
+#include "../core/LoopProfiler.h"
 
 // 全局实例指针
 UIController* g_uiController = nullptr;
 
-// 房间名称映射（定义）
-const char* ROOM_NAMES[] = {"客厅", "卧室", "厨房", "浴室", "室外"};
+// 房间显示名见core/Symbols.h的ROOM_SYMBOLS
 
-// 中断服务程序包装函数
-void IRAM_ATTR encoderISR() {
-    if (g_uiController) g_uiController->handleEncoderInterrupt();
-}
+// 传感器项目名称，顺序与SensorItem一致（用于日志）
+static const char* ITEM_NAMES[] = {"温度", "湿度", "亮度", "烟雾", "燃气"};
 
+// 中断服务程序包装函数
 void IRAM_ATTR encoderSwitchISR() {
     if (g_uiController) g_uiController->handleEncoderSwitchInterrupt();
 }
@@ -21,20 +21,20 @@ void IRAM_ATTR backButtonISR() {
 
 UIController::UIController() 
     : tft(TFT_CS, TFT_DC, TFT_RST),
+#if UI_FRAMEBUFFER
+      canvas(SCREEN_WIDTH, SCREEN_HEIGHT),
+#endif
+      gfx(&tft),
       currentState(STATE_OVERVIEW),
       selectedRoom(0),
       selectedItem(ITEM_TEMPERATURE),
       editMode(false),
-      encoderPressed(false),
-      backButtonPressed(false),
-      encoderDirection(0),
-      lastEncoderA(HIGH),
-      encoderStepAccumulator(0),
-      lastEncoderTime(0),
-      lastEncoderSwitchState(HIGH),
-      lastBackButtonState(HIGH),
+      encoderPosition(0),
       lastUpdate(0),
       needRedraw(true) {
+    memset(&shownModel, 0, sizeof(shownModel));
+    buttons[BUTTON_ENCODER] = {EC11_SW, HIGH, 0};
+    buttons[BUTTON_BACK] = {BTN_OK, HIGH, 0};
     g_uiController = this;
 }
 
@@ -48,23 +48,21 @@ void UIController::begin() {
     tft.setRotation(0); // 竖屏模式
     tft.fillScreen(COLOR_BLACK);
     
-    // 初始化U8g2库，用于中文显示
-    u8g2.begin(tft);
-    u8g2.setFontMode(1);  // 透明背景
-    u8g2.setFontDirection(0);  // 从左到右
-    u8g2.setFont(u8g2_font_wqy12_t_gb2312);  // 设置中文字体
-    
     // 初始化GPIO引脚
     pinMode(EC11_A, INPUT_PULLUP);
     pinMode(EC11_B, INPUT_PULLUP);
     pinMode(EC11_SW, INPUT_PULLUP);
     pinMode(BTN_OK, INPUT_PULLUP);
     
-    // 读取初始编码器状态
-    lastEncoderA = digitalRead(EC11_A);
+    // 旋钮由脉冲计数器解码，不使用中断
+    if (!encoder.begin(EC11_A, EC11_B, UI_ENCODER_GLITCH_FILTER)) {
+        LOG_WARN("[UI] 编码器脉冲计数器初始化失败，旋钮不可用");
+    }
     
-    // 设置中断
-    attachInterrupt(digitalPinToInterrupt(EC11_A), encoderISR, CHANGE);
+    // 按键中断：记录电平变化，去抖在handleInput()中进行
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        buttons[i].level = digitalRead(buttons[i].pin);
+    }
     attachInterrupt(digitalPinToInterrupt(EC11_SW), encoderSwitchISR, CHANGE);
     attachInterrupt(digitalPinToInterrupt(BTN_OK), backButtonISR, CHANGE);
     
@@ -72,6 +70,18 @@ void UIController::begin() {
     displayStartupScreen();
     
     delay(1000);
+
+#if UI_FRAMEBUFFER
+    // 启动界面之后改为绘制到离屏画布，由DMA刷新到屏幕；DMA通道建立前先释放Arduino SPI占用的总线
+    SPI.end();
+    if (canvas.begin(TFT_SCLK, TFT_MOSI, TFT_CS, TFT_DC, UI_SPI_CLOCK_HZ)) {
+        gfx = &canvas;
+        LOG_INFO("[UI] 启用帧缓冲（%dx%d），由DMA刷新屏幕", SCREEN_WIDTH, SCREEN_HEIGHT);
+    } else {
+        SPI.begin();
+        LOG_WARN("[UI] 帧缓冲不可用，直接绘制到屏幕");
+    }
+#endif
 }
 
 void UIController::update() {
@@ -80,61 +90,79 @@ void UIController::update() {
     handleInput();
     
     if (needRedraw) {
-        switch (currentState) {
-            case STATE_OVERVIEW:
-                drawOverviewPage();
-                break;
-            case STATE_BROWSE:
-            case STATE_EDIT:
-                drawRoomPage();
-                break;
-            case STATE_SETTINGS:
-                drawSettingsPage();
-                break;
-        }
+        beginFrame();
+        render();
+        endFrame();
         needRedraw = false;
         lastUpdate = currentTime;
         // Serial.println("[UI] 屏幕已刷新");
+    } else if (currentState == STATE_SETTINGS && currentTime - lastUpdate >= UI_LOOP_STATS_REFRESH_MS) {
+        // 设置页的轮次统计定期刷新，只重绘统计区域
+        beginFrame();
+        drawLoopStats();
+        endFrame();
+        lastUpdate = currentTime;
+    }
+}
+
+void UIController::beginFrame() {
+#if UI_FRAMEBUFFER
+    // 上一帧可能仍在由DMA发送，改写画布前等待传输结束
+    if (gfx == &canvas) {
+        canvas.waitFlush();
     }
+#endif
+}
+
+void UIController::endFrame() {
+#if UI_FRAMEBUFFER
+    // 启动传输后立即返回，执行任务继续处理命令
+    if (gfx == &canvas) {
+        canvas.flush(UI_FLUSH_DIRTY_ROWS);
+    }
+#endif
 }
 
 void UIController::handleInput() {
     unsigned long currentTime = millis();
     
-    // 处理编码器旋转 - 两个咔嗒对应一个步长
-    if (encoderDirection != 0) {
-        encoderStepAccumulator += encoderDirection;
-        lastEncoderTime = currentTime;
-        encoderDirection = 0;
-        
-        // 当累积器达到±2时，执行一次旋转操作
-        if (abs(encoderStepAccumulator) >= 2) {
-            int logicalDirection = (encoderStepAccumulator > 0) ? 1 : -1;
-            handleEncoderRotation(logicalDirection);
-            encoderStepAccumulator = 0;  // 重置累积器
-            // Serial.print("[UI] 编码器累积步长达到，执行旋转: ");
-            // Serial.println(logicalDirection > 0 ? "正向" : "反向");
-        }
+    // 处理编码器旋转：取出计数器累计的全部步数逐步处理，快速转动时不丢步
+    int32_t steps = encoder.takeSteps(currentTime);
+    encoderPosition += steps;
+    for (; steps > 0; steps--) {
+        handleEncoderRotation(1);
+    }
+    for (; steps < 0; steps++) {
+        handleEncoderRotation(-1);
     }
     
-    // 超时重置累积器
-    if (encoderStepAccumulator != 0 && (currentTime - lastEncoderTime) > 500) {
-        encoderStepAccumulator = 0;
+    // 处理按键：按中断记录的时间去抖
+    ButtonEvent event;
+    while (buttonEvents.pop(event)) {
+        applyButtonLevel((UIButton)event.button, event.level, event.timeMs);
     }
     
-    if (encoderPressed) {
-        encoderPressed = false;
-        // Serial.println("[UI] 编码器按键触发");
-        handleEncoderPress();
-        delay(200);
+    // 最后一次电平变化落在去抖时间内被忽略、或队列满丢弃了事件时，去抖时间过后按当前电平补齐
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        applyButtonLevel((UIButton)i, digitalRead(buttons[i].pin), currentTime);
+    }
+}
+
+void UIController::applyButtonLevel(UIButton button, uint8_t level, uint32_t timeMs) {
+    ButtonState& state = buttons[button];
+    if (level == state.level || (uint32_t)(timeMs - state.changedMs) < UI_BUTTON_DEBOUNCE_MS) {
+        return;
     }
+    state.level = level;
+    state.changedMs = timeMs;
     
-    // 处理返回按键
-    if (backButtonPressed) {
-        backButtonPressed = false;
-        // Serial.println("[UI] 返回按键触发");
-        handleBackButton();
-        delay(200);
+    // 按下（高变低）时触发
+    if (level == LOW) {
+        if (button == BUTTON_ENCODER) {
+            handleEncoderPress();
+        } else {
+            handleBackButton();
+        }
     }
 }
 
@@ -143,14 +171,14 @@ void UIController::handleEncoderRotation(int direction) {
         case STATE_OVERVIEW:
             // 概览页：选择房间
             selectedRoom += direction;
-            if (selectedRoom < 0) selectedRoom = MAX_ROOMS - 1;
-            if (selectedRoom >= MAX_ROOMS) selectedRoom = 0;
+            if (selectedRoom < 0) selectedRoom = ROOM_COUNT - 1;
+            if (selectedRoom >= ROOM_COUNT) selectedRoom = 0;
             setRedraw();
             break;
             
         case STATE_BROWSE:
             // 浏览模式：选择传感器项目
-            if (selectedRoom == LIVINGROOM || selectedRoom == BEDROOM || selectedRoom == OUTDOOR) {
+            if (selectedRoom == ROOM_LIVINGROOM || selectedRoom == ROOM_BEDROOM || selectedRoom == ROOM_OUTDOOR) {
                 // 卧室、客厅、室外：温度 -> 湿度 -> 亮度 -> 温度
                 if (direction > 0) {
                     // 正向旋转：温度 -> 湿度 -> 亮度 -> 温度
@@ -171,7 +199,7 @@ void UIController::handleEncoderRotation(int direction) {
                         selectedItem = ITEM_TEMPERATURE;
                     }
                 }
-            } else if (selectedRoom == KITCHEN) {
+            } else if (selectedRoom == ROOM_KITCHEN) {
                 // 厨房：温度 -> 湿度 -> 烟雾 -> 燃气 -> 温度
                 if (direction > 0) {
                     // 正向旋转：温度 -> 湿度 -> 烟雾 -> 燃气 -> 温度
@@ -207,12 +235,7 @@ void UIController::handleEncoderRotation(int direction) {
                 }
             }
             
-            Serial.print("[UI] 浏览模式切换到: ");
-            if (selectedItem == ITEM_TEMPERATURE) Serial.println("温度");
-            else if (selectedItem == ITEM_HUMIDITY) Serial.println("湿度");
-            else if (selectedItem == ITEM_BRIGHTNESS) Serial.println("亮度");
-            else if (selectedItem == ITEM_SMOKE) Serial.println("烟雾");
-            else Serial.println("燃气");
+            LOG_INFO("[UI] 浏览模式切换到: %s", ITEM_NAMES[selectedItem]);
             setRedraw();
             break;
             
@@ -235,12 +258,7 @@ void UIController::handleEncoderPress() {
             currentState = STATE_BROWSE;
             selectedItem = ITEM_TEMPERATURE;
             editMode = false;
-            Serial.print("[UI] 进入房间浏览模式，初始选择: ");
-            if (selectedItem == ITEM_TEMPERATURE) Serial.println("温度");
-            else if (selectedItem == ITEM_HUMIDITY) Serial.println("湿度");
-            else if (selectedItem == ITEM_BRIGHTNESS) Serial.println("亮度");
-            else if (selectedItem == ITEM_SMOKE) Serial.println("烟雾");
-            else Serial.println("燃气");
+            LOG_INFO("[UI] 进入房间浏览模式，初始选择: %s", ITEM_NAMES[selectedItem]);
             setRedraw();
             break;
             
@@ -248,12 +266,7 @@ void UIController::handleEncoderPress() {
             // 浏览模式：进入编辑模式
             currentState = STATE_EDIT;
             editMode = true;
-            Serial.print("[UI] 进入编辑模式，编辑项目: ");
-            if (selectedItem == ITEM_TEMPERATURE) Serial.println("温度");
-            else if (selectedItem == ITEM_HUMIDITY) Serial.println("湿度");
-            else if (selectedItem == ITEM_BRIGHTNESS) Serial.println("亮度");
-            else if (selectedItem == ITEM_SMOKE) Serial.println("烟雾");
-            else Serial.println("燃气");
+            LOG_INFO("[UI] 进入编辑模式，编辑项目: %s", ITEM_NAMES[selectedItem]);
             setRedraw();
             break;
             
@@ -261,12 +274,7 @@ void UIController::handleEncoderPress() {
             // 编辑模式：退出编辑，回到浏览模式
             currentState = STATE_BROWSE;
             editMode = false;
-            Serial.print("[UI] 退出编辑模式，当前选择: ");
-            if (selectedItem == ITEM_TEMPERATURE) Serial.println("温度");
-            else if (selectedItem == ITEM_HUMIDITY) Serial.println("湿度");
-            else if (selectedItem == ITEM_BRIGHTNESS) Serial.println("亮度");
-            else if (selectedItem == ITEM_SMOKE) Serial.println("烟雾");
-            else Serial.println("燃气");
+            LOG_INFO("[UI] 退出编辑模式，当前选择: %s", ITEM_NAMES[selectedItem]);
             setRedraw();
             break;
             
@@ -301,7 +309,7 @@ void UIController::handleBackButton() {
 }
 
 void UIController::adjustSensorValue(int direction) {
-    SensorData data = getSensorData((RoomIndex)selectedRoom);
+    SensorData data = getSensorData((RoomId)selectedRoom);
     
     if (selectedItem == ITEM_TEMPERATURE) {
         data.temperature += direction * 0.5f;
@@ -318,56 +326,204 @@ void UIController::adjustSensorValue(int direction) {
         data.gas_leak = !data.gas_leak;  // 切换布尔值
     }
     
-    setSensorData((RoomIndex)selectedRoom, data.temperature, data.humidity, data.brightness, data.smoke_detected, data.gas_leak);
+    setSensorData((RoomId)selectedRoom, data.temperature, data.humidity, data.brightness, data.smoke_detected, data.gas_leak);
 }
 
-void UIController::drawOverviewPage() {
-    tft.fillScreen(COLOR_BLACK);
+// 界面模型与增量刷新
+// 控件部位，对应drawOverviewRow()/drawRoomRow()的parts参数
+#define UI_PART_LABEL   0x01    // 选中光标和名称
+#define UI_PART_VALUE   0x02    // 数值（概览页为温度）
+#define UI_PART_VALUE2  0x04    // 概览页的湿度
+#define UI_PART_BAR     0x08    // 房间页的进度条
+#define UI_PART_ALL     0x0F
+
+// 概览页各房间行的位置与控件区域
+#define UI_OVERVIEW_ROW_Y       40
+#define UI_OVERVIEW_ROW_SPACING 20
+
+// 房间页各项目行的位置（亮度和烟雾不会同时出现），顺序与SensorItem一致
+static const int ROOM_ROW_Y[UI_MAX_ROWS] = {30, 54, 78, 78, 96};
+static const char* ROOM_ROW_LABELS[UI_MAX_ROWS] = {"温度:", "湿度:", "亮度:", "烟雾:", "燃气:"};
+static const uint16_t ITEM_SELECTED_COLORS[UI_MAX_ROWS] = {COLOR_ORANGE, COLOR_CYAN, COLOR_YELLOW, COLOR_MAGENTA, COLOR_MAGENTA};
+static const uint16_t ITEM_EDITING_COLORS[UI_MAX_ROWS] = {COLOR_RED, COLOR_BLUE, COLOR_MAGENTA, COLOR_RED, COLOR_RED};
+
+// 控件区域的高度：ASCII文字占y..y+7，中文（基线y+8）约占y-3..y+9
+#define UI_ROW_TOP_OFFSET   3
+#define UI_ROW_HEIGHT       14
+
+// 底部右侧操作提示区域，设置页的连接状态区域（WiFi、SSID、IP和MQTT状态，止于轮次统计区域之上）
+#define UI_HINT_X           (SCREEN_WIDTH - 50)
+#define UI_HINT_Y           (SCREEN_HEIGHT - 24)
+#define UI_STATUS_Y         27
+
+/**
+ * @brief 房间页是否显示该项目
+ */
+static bool roomHasItem(int room, SensorItem item) {
+    switch (item) {
+        case ITEM_TEMPERATURE:
+        case ITEM_HUMIDITY:
+            return true;
+        case ITEM_BRIGHTNESS:
+            return room == ROOM_LIVINGROOM || room == ROOM_BEDROOM || room == ROOM_OUTDOOR;
+        case ITEM_SMOKE:
+        case ITEM_GAS:
+            return room == ROOM_KITCHEN;
+    }
+    return false;
+}
+
+/**
+ * @brief 显示值（保留1位小数）转为×10的整数，用于比较是否变化
+ */
+static int16_t toTenths(float value) {
+    return (int16_t)lroundf(value * 10.0f);
+}
+
+/**
+ * @brief 编辑模式与浏览模式属于同一页面
+ */
+static UIState pageOf(UIState state) {
+    return state == STATE_EDIT ? STATE_BROWSE : state;
+}
+
+static bool sameRow(const UIRowModel& a, const UIRowModel& b) {
+    return a.visible == b.visible && a.selected == b.selected && a.color == b.color &&
+           a.value == b.value && a.value2 == b.value2;
+}
+
+void UIController::buildModel(UIModel& model) {
+    extern bool mqtt_connected(); // MQTT连接状态（PubSubClient由网络任务独占）
+    memset(&model, 0, sizeof(model));
+    model.valid = true;
+    model.state = currentState;
+    model.room = selectedRoom;
+    model.wifi = WiFi.isConnected();
+    model.mqtt = mqtt_connected();
+
+    if (currentState == STATE_OVERVIEW) {
+        for (int i = 0; i < ROOM_COUNT; i++) {
+            SensorData data = getSensorData((RoomId)i);
+            UIRowModel& row = model.rows[i];
+            row.visible = true;
+            row.selected = (i == selectedRoom);
+            row.color = row.selected ? COLOR_YELLOW : COLOR_WHITE;
+            row.value = toTenths(data.temperature);
+            row.value2 = toTenths(data.humidity);
+        }
+    } else if (currentState == STATE_BROWSE || currentState == STATE_EDIT) {
+        SensorData data = getSensorData((RoomId)selectedRoom);
+        const float values[UI_MAX_ROWS] = {
+            data.temperature, data.humidity, data.brightness,
+            data.smoke_detected ? 0.1f : 0.0f, data.gas_leak ? 0.1f : 0.0f
+        };
+        for (int item = 0; item < UI_MAX_ROWS; item++) {
+            UIRowModel& row = model.rows[item];
+            row.visible = roomHasItem(selectedRoom, (SensorItem)item);
+            row.selected = (item == selectedItem);
+            if (row.selected) {
+                row.color = (currentState == STATE_EDIT) ? ITEM_EDITING_COLORS[item] : ITEM_SELECTED_COLORS[item];
+            } else {
+                row.color = COLOR_WHITE;
+            }
+            row.value = toTenths(values[item]);
+        }
+    }
+}
+
+void UIController::render() {
+    UIModel next;
+    buildModel(next);
+
+    bool samePage = shownModel.valid && pageOf(shownModel.state) == pageOf(next.state) &&
+                    (pageOf(next.state) != STATE_BROWSE || shownModel.room == next.room);
+    if (UI_INCREMENTAL_RENDER && samePage) {
+        drawChanges(shownModel, next);
+    } else {
+        switch (next.state) {
+            case STATE_OVERVIEW:
+                drawOverviewPage(next);
+                break;
+            case STATE_BROWSE:
+            case STATE_EDIT:
+                drawRoomPage(next);
+                break;
+            case STATE_SETTINGS:
+                drawSettingsPage(next);
+                break;
+        }
+    }
+    shownModel = next;
+}
+
+void UIController::drawChanges(const UIModel& shown, const UIModel& next) {
+    switch (next.state) {
+        case STATE_OVERVIEW:
+            for (int i = 0; i < ROOM_COUNT; i++) {
+                const UIRowModel& before = shown.rows[i];
+                const UIRowModel& after = next.rows[i];
+                if (sameRow(before, after)) {
+                    continue;
+                }
+                // 选中状态变化时整行变色；否则只重绘变化的数值
+                uint8_t parts = 0;
+                if (before.selected != after.selected || before.color != after.color) {
+                    parts = UI_PART_ALL;
+                }
+                if (before.value != after.value) parts |= UI_PART_VALUE;
+                if (before.value2 != after.value2) parts |= UI_PART_VALUE2;
+                drawOverviewRow(i, after, parts, true);
+            }
+            break;
+
+        case STATE_BROWSE:
+        case STATE_EDIT:
+            for (int item = 0; item < UI_MAX_ROWS; item++) {
+                const UIRowModel& before = shown.rows[item];
+                const UIRowModel& after = next.rows[item];
+                if (!after.visible || sameRow(before, after)) {
+                    continue;
+                }
+                uint8_t parts = 0;
+                if (before.selected != after.selected || before.color != after.color) {
+                    parts |= UI_PART_LABEL | UI_PART_VALUE;
+                }
+                if (before.value != after.value) {
+                    parts |= UI_PART_VALUE | UI_PART_BAR;
+                }
+                drawRoomRow((SensorItem)item, after, parts, true);
+            }
+            if (shown.state != next.state) {
+                drawRoomHint(next.state, true);
+            }
+            break;
+
+        case STATE_SETTINGS:
+            // WiFi断开时SSID和IP行消失，MQTT行随之上移，连接状态区域整体重绘；轮次统计由update()定期刷新
+            if (shown.wifi != next.wifi || shown.mqtt != next.mqtt) {
+                drawSettingsStatus(next, true);
+            }
+            break;
+    }
+}
+
+void UIController::drawOverviewPage(const UIModel& model) {
+    gfx->fillScreen(COLOR_BLACK);
     
     // 绘制标题
     drawHeader("环境监控");
     
     // 绘制列标题
     int y = 25;
-    tft.setTextColor(COLOR_GRAY);
-    tft.setTextSize(1);
+    gfx->setTextColor(COLOR_GRAY);
+    gfx->setTextSize(1);
     printChineseSmall(8, y + 8, "房间", COLOR_GRAY);
     printChineseSmall(50, y + 8, "温度", COLOR_GRAY);
     printChineseSmall(95, y + 8, "湿度", COLOR_GRAY);
     
-    y += 15;
-    
     // 绘制所有房间数据
-    for (int i = 0; i < MAX_ROOMS; i++) {
-        SensorData data = getSensorData((RoomIndex)i);
-        
-        // 选中房间用不同颜色显示
-        uint16_t textColor = (i == selectedRoom) ? COLOR_YELLOW : COLOR_WHITE;
-        tft.setTextColor(textColor);
-        tft.setTextSize(1);
-        
-        // 显示选中指示符
-        if (i == selectedRoom) {
-            tft.setCursor(0, y);
-            tft.print(">");
-        }
-        
-        // 房间名（中文）
-        printChineseSmall(8, y + 8, getRoomName(i), textColor);
-        
-        tft.setTextColor(textColor);
-        
-        // 温度数据
-        tft.setCursor(45, y);
-        tft.print(data.temperature, 1);
-        tft.print("C");
-        
-        // 湿度数据
-        tft.setCursor(90, y);
-        tft.print(data.humidity, 1);
-        tft.print("%");
-        
-        y += 20;
+    for (int i = 0; i < ROOM_COUNT; i++) {
+        drawOverviewRow(i, model.rows[i], UI_PART_ALL, false);
     }
     
     // 底部操作提示
@@ -381,191 +537,58 @@ void UIController::drawOverviewPage() {
     printChineseSmall(SCREEN_WIDTH - 50, bottomY + 18, "按下确认", COLOR_GREEN);
 }
 
-void UIController::drawRoomPage() {
-    tft.fillScreen(COLOR_BLACK);
-    
-    // 绘制标题
-    String title = getRoomName(selectedRoom);
-    drawHeader(title.c_str());
-    
-    SensorData data = getSensorData((RoomIndex)selectedRoom);
-    
-    int y = 30;
-    
-    // 温度行
-    bool tempSelected = (selectedItem == ITEM_TEMPERATURE);
-    bool tempEditing = (currentState == STATE_EDIT && tempSelected);
-    
-    uint16_t tempColor = COLOR_WHITE;
-    if (tempSelected) {
-        tempColor = tempEditing ? COLOR_RED : COLOR_ORANGE;
-    }
-    
-    tft.setTextColor(tempColor);
-    tft.setTextSize(1);
-    
-    if (tempSelected) {
-        tft.setCursor(0, y);
-        tft.print(">");
+void UIController::drawOverviewRow(int room, const UIRowModel& row, uint8_t parts, bool clear) {
+    int y = UI_OVERVIEW_ROW_Y + room * UI_OVERVIEW_ROW_SPACING;
+    int top = y - UI_ROW_TOP_OFFSET;
+
+    // 选中房间用不同颜色显示
+    gfx->setTextSize(1);
+
+    if (parts & UI_PART_LABEL) {
+        if (clear) gfx->fillRect(0, top, 44, UI_ROW_HEIGHT, COLOR_BLACK);
+        // 显示选中指示符
+        if (row.selected) {
+            gfx->setTextColor(row.color);
+            gfx->setCursor(0, y);
+            gfx->print(">");
+        }
+        // 房间名（中文）
+        printChineseSmall(8, y + 8, getRoomName(room), row.color);
     }
-    
-    // 使用U8g2显示中文
-    u8g2.setForegroundColor(tempColor);
-    u8g2.setCursor(8, y + 8);
-    u8g2.print("温度:");
-    
-    // 使用原生库显示数字
-    tft.setTextColor(tempColor);
-    tft.setCursor(65, y);
-    tft.print(data.temperature, 1);
-    tft.print("C");
-    
-    y += 12;
-    
-    // 温度进度条 (范围: -10°C ~ 40°C，总共50°C)
-    // 将温度值映射到0-50范围用于进度条显示
-    float tempForProgress = data.temperature + 10.0f;  // 将-10~40映射到0~50
-    drawProgressBar(8, y, 100, 6, tempForProgress, 50.0f);
-    
-    y += 12;
-    
-    // 湿度行
-    bool humSelected = (selectedItem == ITEM_HUMIDITY);
-    bool humEditing = (currentState == STATE_EDIT && humSelected);
-    
-    uint16_t humColor = COLOR_WHITE;
-    if (humSelected) {
-        humColor = humEditing ? COLOR_BLUE : COLOR_CYAN;
+
+    gfx->setTextColor(row.color);
+
+    // 温度数据
+    if (parts & UI_PART_VALUE) {
+        if (clear) gfx->fillRect(44, top, 45, UI_ROW_HEIGHT, COLOR_BLACK);
+        gfx->setCursor(45, y);
+        gfx->print(row.value / 10.0f, 1);
+        gfx->print("C");
     }
-    
-    tft.setTextColor(humColor);
-    
-    if (humSelected) {
-        tft.setCursor(0, y);
-        tft.print(">");
+
+    // 湿度数据
+    if (parts & UI_PART_VALUE2) {
+        if (clear) gfx->fillRect(89, top, SCREEN_WIDTH - 89, UI_ROW_HEIGHT, COLOR_BLACK);
+        gfx->setCursor(90, y);
+        gfx->print(row.value2 / 10.0f, 1);
+        gfx->print("%");
     }
+}
+
+void UIController::drawRoomPage(const UIModel& model) {
+    gfx->fillScreen(COLOR_BLACK);
     
-    // 使用U8g2显示中文
-    u8g2.setForegroundColor(humColor);
-    u8g2.setCursor(8, y + 8);
-    u8g2.print("湿度:");
-    
-    // 使用原生库显示数字
-    tft.setTextColor(humColor);
-    tft.setCursor(65, y);
-    tft.print(data.humidity, 1);
-    tft.print("%");
-    
-    y += 12;
-    
-    // 湿度进度条
-    drawProgressBar(8, y, 100, 6, data.humidity, 100.0f);
-    
-    y += 12;
-    
-    // 亮度行（只在卧室、客厅、室外显示）
-    if (selectedRoom == LIVINGROOM || selectedRoom == BEDROOM || selectedRoom == OUTDOOR) {
-        bool brightSelected = (selectedItem == ITEM_BRIGHTNESS);
-        bool brightEditing = (currentState == STATE_EDIT && brightSelected);
-        
-        uint16_t brightColor = COLOR_WHITE;
-        if (brightSelected) {
-            brightColor = brightEditing ? COLOR_MAGENTA : COLOR_YELLOW;
-        }
-        
-        tft.setTextColor(brightColor);
-        
-        if (brightSelected) {
-            tft.setCursor(0, y);
-            tft.print(">");
-        }
-        
-        // 使用U8g2显示中文
-        u8g2.setForegroundColor(brightColor);
-        u8g2.setCursor(8, y + 8);
-        u8g2.print("亮度:");
-        
-        // 使用原生库显示数字
-        tft.setTextColor(brightColor);
-        tft.setCursor(65, y);
-        tft.print(data.brightness, 1);
-        tft.print("%");
-        
-        y += 12;
-        
-        // 亮度进度条
-        drawProgressBar(8, y, 100, 6, data.brightness, 100.0f);
-        
-        y += 12;
-    }
+    // 绘制标题
+    String title = getRoomName(model.room);
+    drawHeader(title.c_str());
     
-    // 烟雾和燃气传感器行（只在厨房显示）
-    if (selectedRoom == KITCHEN) {
-        // 烟雾传感器行
-        bool smokeSelected = (selectedItem == ITEM_SMOKE);
-        bool smokeEditing = (currentState == STATE_EDIT && smokeSelected);
-        
-        uint16_t smokeColor = COLOR_WHITE;
-        if (smokeSelected) {
-            smokeColor = smokeEditing ? COLOR_RED : COLOR_MAGENTA;
-        }
-        
-        tft.setTextColor(smokeColor);
-        
-        if (smokeSelected) {
-            tft.setCursor(0, y);
-            tft.print(">");
-        }
-        
-        // 使用U8g2显示中文
-        u8g2.setForegroundColor(smokeColor);
-        u8g2.setCursor(8, y + 8);
-        u8g2.print("烟雾:");
-        
-        // 使用原生库显示状态
-        tft.setTextColor(smokeColor);
-        tft.setCursor(65, y);
-        tft.print("[");
-        printChineseSmall(75, y + 8, data.smoke_detected ? "报警" : "正常", smokeColor);
-        tft.setCursor(105, y);
-        tft.print("]");
-        
-        y += 18;
-        
-        // 燃气传感器行
-        bool gasSelected = (selectedItem == ITEM_GAS);
-        bool gasEditing = (currentState == STATE_EDIT && gasSelected);
-        
-        uint16_t gasColor = COLOR_WHITE;
-        if (gasSelected) {
-            gasColor = gasEditing ? COLOR_RED : COLOR_MAGENTA;
+    // 温度、湿度行带进度条；亮度行只在卧室、客厅、室外显示，烟雾和燃气行只在厨房显示
+    for (int item = 0; item < UI_MAX_ROWS; item++) {
+        if (model.rows[item].visible) {
+            drawRoomRow((SensorItem)item, model.rows[item], UI_PART_ALL, false);
         }
-        
-        tft.setTextColor(gasColor);
-        
-        if (gasSelected) {
-            tft.setCursor(0, y);
-            tft.print(">");
-        }
-        
-        // 使用U8g2显示中文
-        u8g2.setForegroundColor(gasColor);
-        u8g2.setCursor(8, y + 8);
-        u8g2.print("燃气:");
-        
-        // 使用原生库显示状态
-        tft.setTextColor(gasColor);
-        tft.setCursor(65, y);
-        tft.print("[");
-        printChineseSmall(75, y + 8, data.gas_leak ? "泄漏" : "正常", gasColor);
-        tft.setCursor(105, y);
-        tft.print("]");
-        
-        y += 12;
     }
     
-    y += 8;
-    
     // 底部操作提示
     int bottomY = SCREEN_HEIGHT - 20;
     
@@ -573,7 +596,61 @@ void UIController::drawRoomPage() {
     printChineseSmall(0, bottomY + 18, "返回", COLOR_GREEN);
     
     // 右下角：根据状态显示不同提示
-    if (currentState == STATE_BROWSE) {
+    drawRoomHint(model.state, false);
+}
+
+void UIController::drawRoomRow(SensorItem item, const UIRowModel& row, uint8_t parts, bool clear) {
+    int y = ROOM_ROW_Y[item];
+    int top = y - UI_ROW_TOP_OFFSET;
+
+    gfx->setTextSize(1);
+
+    if (parts & UI_PART_LABEL) {
+        if (clear) gfx->fillRect(0, top, 64, UI_ROW_HEIGHT, COLOR_BLACK);
+        if (row.selected) {
+            gfx->setTextColor(row.color);
+            gfx->setCursor(0, y);
+            gfx->print(">");
+        }
+        // 显示中文标签
+        printChineseSmall(8, y + 8, ROOM_ROW_LABELS[item], row.color);
+    }
+
+    if (parts & UI_PART_VALUE) {
+        if (clear) gfx->fillRect(64, top, SCREEN_WIDTH - 64, UI_ROW_HEIGHT, COLOR_BLACK);
+        gfx->setTextColor(row.color);
+        gfx->setCursor(65, y);
+        if (item == ITEM_SMOKE || item == ITEM_GAS) {
+            // 使用原生库显示状态
+            const char* alarm = (item == ITEM_SMOKE) ? "报警" : "泄漏";
+            gfx->print("[");
+            printChineseSmall(75, y + 8, row.value ? alarm : "正常", row.color);
+            gfx->setCursor(105, y);
+            gfx->print("]");
+        } else {
+            // 使用原生库显示数字
+            gfx->print(row.value / 10.0f, 1);
+            gfx->print(item == ITEM_TEMPERATURE ? "C" : "%");
+        }
+    }
+
+    if ((parts & UI_PART_BAR) && item <= ITEM_BRIGHTNESS) {
+        // 只清除进度条内部，边框不变
+        if (clear) gfx->fillRect(9, y + 13, 98, 4, COLOR_BLACK);
+        if (item == ITEM_TEMPERATURE) {
+            // 温度范围-10°C ~ 40°C，映射到0~50用于进度条显示
+            drawProgressBar(8, y + 12, 100, 6, row.value / 10.0f + 10.0f, 50.0f);
+        } else {
+            drawProgressBar(8, y + 12, 100, 6, row.value / 10.0f, 100.0f);
+        }
+    }
+}
+
+void UIController::drawRoomHint(UIState state, bool clear) {
+    if (clear) gfx->fillRect(UI_HINT_X, UI_HINT_Y, SCREEN_WIDTH - UI_HINT_X, SCREEN_HEIGHT - UI_HINT_Y, COLOR_BLACK);
+
+    int bottomY = SCREEN_HEIGHT - 20;
+    if (state == STATE_BROWSE) {
         printChineseSmall(SCREEN_WIDTH - 50, bottomY + 8, "转动选择", COLOR_GREEN);
         printChineseSmall(SCREEN_WIDTH - 50, bottomY + 18, "按下编辑", COLOR_GREEN);
     } else {
@@ -582,29 +659,45 @@ void UIController::drawRoomPage() {
     }
 }
 
-void UIController::drawSettingsPage() {
-    tft.fillScreen(COLOR_BLACK);
+void UIController::drawSettingsPage(const UIModel& model) {
+    gfx->fillScreen(COLOR_BLACK);
     
     drawHeader("系统信息");
     
+    // WiFi与MQTT状态
+    drawSettingsStatus(model, false);
+    
+    // 任务轮次频率与最长卡顿
+    drawLoopStats();
+
+    // 底部操作提示
+    int bottomY = SCREEN_HEIGHT - 20;
+    
+    // 左下角：返回
+    printChineseSmall(0, bottomY + 18, "返回", COLOR_GREEN);
+    
+}
+
+void UIController::drawSettingsStatus(const UIModel& model, bool clear) {
+    if (clear) gfx->fillRect(0, UI_STATUS_Y, SCREEN_WIDTH, UI_LOOP_STATS_Y - UI_STATUS_Y, COLOR_BLACK);
+
     int y = 30;
-    tft.setTextColor(COLOR_WHITE);
-    tft.setTextSize(1);
+    gfx->setTextSize(1);
     
     // WiFi状态
-    tft.setTextColor(COLOR_WHITE);
-    tft.setCursor(0, y);
-    tft.print("WiFi:");
-    if (WiFi.isConnected()) {
+    gfx->setTextColor(COLOR_WHITE);
+    gfx->setCursor(0, y);
+    gfx->print("WiFi:");
+    if (model.wifi) {
         printChineseSmall(35, y + 8, "已连接", COLOR_GREEN);
         y += 12;
-        tft.setCursor(0, y);
-        tft.print("   ");
-        tft.print(WiFi.SSID());
+        gfx->setCursor(0, y);
+        gfx->print("   ");
+        gfx->print(WiFi.SSID());
         y += 12;
-        tft.setCursor(0, y);
-        tft.print("   ");
-        tft.print(WiFi.localIP());
+        gfx->setCursor(0, y);
+        gfx->print("   ");
+        gfx->print(WiFi.localIP());
     } else {
         printChineseSmall(35, y + 8, "未连接", COLOR_RED);
     }
@@ -612,171 +705,156 @@ void UIController::drawSettingsPage() {
     y += 20;
     
     // MQTT状态
-    extern PubSubClient client; // 引用外部MQTT客户端
-    tft.setTextColor(COLOR_WHITE);
-    tft.setCursor(0, y);
-    tft.print("MQTT:");
-    if (client.connected()) {
+    gfx->setTextColor(COLOR_WHITE);
+    gfx->setCursor(0, y);
+    gfx->print("MQTT:");
+    if (model.mqtt) {
         printChineseSmall(40, y + 8, "在线", COLOR_GREEN);
     } else {
         printChineseSmall(40, y + 8, "离线", COLOR_RED);
     }
-    
-    // 底部操作提示
-    int bottomY = SCREEN_HEIGHT - 20;
-    
-    // 左下角：返回
-    printChineseSmall(0, bottomY + 18, "返回", COLOR_GREEN);
-    
+}
+
+void UIController::drawLoopStats() {
+    extern void loop_profiler_stats(LoopStats& network, LoopStats& executor); // 由主程序提供
+    LoopStats network;
+    LoopStats executor;
+    loop_profiler_stats(network, executor);
+    const LoopStats& worst = network.worst_stall_us >= executor.worst_stall_us ? network : executor;
+
+    int y = UI_LOOP_STATS_Y;
+    gfx->fillRect(0, y, SCREEN_WIDTH, 36, COLOR_BLACK);
+    gfx->setTextSize(1);
+    gfx->setTextColor(COLOR_WHITE);
+    gfx->setCursor(0, y);
+    gfx->printf("Net  %4luHz max %4lums", (unsigned long)network.hz, (unsigned long)(network.window_max_us / 1000));
+    gfx->setCursor(0, y + 12);
+    gfx->printf("Exec %4luHz max %4lums", (unsigned long)executor.hz, (unsigned long)(executor.window_max_us / 1000));
+    gfx->setTextColor(worst.worst_stall_us >= LOOP_STALL_THRESHOLD_MS * 1000UL ? COLOR_ORANGE : COLOR_GRAY);
+    gfx->setCursor(0, y + 24);
+    gfx->printf("Stall %lums %s", (unsigned long)(worst.worst_stall_us / 1000), worst.worst_section);
 }
 
 void UIController::drawHeader(const char* title) {
-    // 计算中文字符串的显示宽度
-    int titleWidth = 0;
-    const char* p = title;
-    while (*p) {
-        if ((*p & 0x80) == 0) {
-            // ASCII字符
-            titleWidth += 6;
-            p++;
-        } else {
-            // 中文字符（UTF-8编码）
-            titleWidth += 12;  // U8g2中文字体宽度约12像素
-            // 跳过UTF-8多字节序列
-            if ((*p & 0xE0) == 0xC0) p += 2;      // 2字节
-            else if ((*p & 0xF0) == 0xE0) p += 3; // 3字节（中文）
-            else if ((*p & 0xF8) == 0xF0) p += 4; // 4字节
-            else p++;
-        }
-    }
+    int titleWidth = glyph_atlas_text_width(title);
     
     // 居中显示
     int x = (SCREEN_WIDTH - titleWidth) / 2;
     printChinese(x, 15, title, COLOR_WHITE);
     
     // 绘制分隔线
-    tft.drawLine(0, 18, SCREEN_WIDTH, 18, COLOR_GRAY);
+    gfx->drawLine(0, 18, SCREEN_WIDTH, 18, COLOR_GRAY);
 }
 
-// U8g2中文显示辅助函数
+// 中文显示辅助函数：y为基线，背景透明，字形取自GlyphAtlas
 void UIController::printChinese(int x, int y, const char* text, uint16_t color) {
-    u8g2.setForegroundColor(color);
-    u8g2.setFont(u8g2_font_wqy12_t_gb2312);
-    u8g2.setCursor(x, y);
-    u8g2.print(text);
+#if UI_FRAMEBUFFER
+    // 画布模式下颜色只转换一次字节序，字形像素直接写入画布
+    bool toCanvas = gfx == &canvas;
+    uint16_t canvasColor = FrameCanvas::panelColor(color);
+#endif
+    while (*text) {
+        uint32_t codepoint = utf8_next(text);
+        const GlyphInfo* glyph = glyph_atlas_find(codepoint);
+        if (glyph == nullptr) {
+            x += codepoint < 0x80 ? GLYPH_ATLAS_FALLBACK_NARROW : GLYPH_ATLAS_FALLBACK_WIDE;
+            continue;
+        }
+        const uint8_t* bitmap = glyph_atlas_bitmap(*glyph);
+        int16_t left = x + glyph->left;
+        int16_t top = y + glyph->top;
+#if UI_FRAMEBUFFER
+        if (toCanvas) {
+            canvas.drawGlyph(left, top, bitmap, glyph->width, glyph->height, canvasColor);
+            x += glyph->advance;
+            continue;
+        }
+#endif
+        // 直接绘制到屏幕时每段连续的点写成一条横线，减少SPI地址窗口的设置次数
+        uint8_t rowBytes = (glyph->width + 7) / 8;
+        for (uint8_t row = 0; row < glyph->height; row++, bitmap += rowBytes) {
+            uint8_t col = 0;
+            while (col < glyph->width) {
+                if (!(bitmap[col >> 3] & (0x80 >> (col & 7)))) {
+                    col++;
+                    continue;
+                }
+                uint8_t start = col;
+                while (col < glyph->width && (bitmap[col >> 3] & (0x80 >> (col & 7)))) {
+                    col++;
+                }
+                gfx->drawFastHLine(left + start, top + row, col - start, color);
+            }
+        }
+        x += glyph->advance;
+    }
 }
 
 void UIController::printChineseSmall(int x, int y, const char* text, uint16_t color) {
-    u8g2.setForegroundColor(color);
-    u8g2.setFont(u8g2_font_wqy12_t_gb2312);  // 可以换成更小的字体
-    u8g2.setCursor(x, y);
-    u8g2.print(text);
+    printChinese(x, y, text, color);  // 图集只有一种字号
 }
 
 void UIController::drawProgressBar(int x, int y, int width, int height, float value, float maxValue) {
     // 背景
-    tft.drawRect(x, y, width, height, COLOR_GRAY);
+    gfx->drawRect(x, y, width, height, COLOR_GRAY);
     
     // 填充
     int fillWidth = (int)(width * value / maxValue);
     if (fillWidth > 0) {
-        tft.fillRect(x + 1, y + 1, fillWidth - 1, height - 2, COLOR_GREEN);
+        gfx->fillRect(x + 1, y + 1, fillWidth - 1, height - 2, COLOR_GREEN);
     }
 }
 
 void UIController::drawWiFiIcon(int x, int y) {
     if (WiFi.isConnected()) {
-        tft.setTextColor(COLOR_GREEN);
-        tft.setCursor(x, y);
-        tft.print("W");
+        gfx->setTextColor(COLOR_GREEN);
+        gfx->setCursor(x, y);
+        gfx->print("W");
     } else {
-        tft.setTextColor(COLOR_RED);
-        tft.setCursor(x, y);
-        tft.print("W");
+        gfx->setTextColor(COLOR_RED);
+        gfx->setCursor(x, y);
+        gfx->print("W");
     }
 }
 
 void UIController::drawMQTTIcon(int x, int y) {
-    extern PubSubClient client;
-    if (client.connected()) {
-        tft.setTextColor(COLOR_GREEN);
-        tft.setCursor(x, y);
-        tft.print("M");
+    extern bool mqtt_connected();
+    if (mqtt_connected()) {
+        gfx->setTextColor(COLOR_GREEN);
+        gfx->setCursor(x, y);
+        gfx->print("M");
     } else {
-        tft.setTextColor(COLOR_RED);
-        tft.setCursor(x, y);
-        tft.print("M");
+        gfx->setTextColor(COLOR_RED);
+        gfx->setCursor(x, y);
+        gfx->print("M");
     }
 }
 
 const char* UIController::getRoomName(int index) {
-    if (index >= 0 && index < MAX_ROOMS) {
-        return ROOM_NAMES[index];
-    }
-    return "未知";
+    return room_symbol_label(index);
 }
 
 SensorData UIController::getCurrentRoomData() {
-    return getSensorData((RoomIndex)selectedRoom);
+    return getSensorData((RoomId)selectedRoom);
 }
 
 
 
-// 中断处理函数实现
-void IRAM_ATTR UIController::handleEncoderInterrupt() {
-    int currentA = digitalRead(EC11_A);
-    int currentB = digitalRead(EC11_B);
-    
-    if (currentA != lastEncoderA) {
-        if (currentA == currentB) {
-            encoderDirection = -1; // 逆时针
-        } else {
-            encoderDirection = 1; // 顺时针
-        }
-        lastEncoderA = currentA;
-    }
-}
-
+// 中断处理函数实现：只记录电平和时间
 void IRAM_ATTR UIController::handleEncoderSwitchInterrupt() {
-    static unsigned long lastChange = 0;
-    unsigned long now = millis();
-    
-    // 基本防抖：忽略80ms内的重复变化
-    if (now - lastChange < 80) {
-        return;
-    }
-    
-    bool currentState = digitalRead(EC11_SW);
-    
-    // 检测从高到低的变化（按下事件）
-    if (lastEncoderSwitchState == HIGH && currentState == LOW) {
-        encoderPressed = true;
-        lastChange = now;
-    }
-    
-    // 更新状态（无论是按下还是松开）
-    lastEncoderSwitchState = currentState;
+    queueButtonEvent(BUTTON_ENCODER);
 }
 
 void IRAM_ATTR UIController::handleBackButtonInterrupt() {
-    static unsigned long lastChange = 0;
-    unsigned long now = millis();
-    
-    // 基本防抖：忽略50ms内的重复变化
-    if (now - lastChange < 50) {
-        return;
-    }
-    
-    bool currentState = digitalRead(BTN_OK);
-    
-    // 检测从高到低的变化（按下事件）
-    if (lastBackButtonState == HIGH && currentState == LOW) {
-        backButtonPressed = true;
-        lastChange = now;
-    }
-    
-    // 更新状态（无论是按下还是松开）
-    lastBackButtonState = currentState;
+    queueButtonEvent(BUTTON_BACK);
+}
+
+void IRAM_ATTR UIController::queueButtonEvent(UIButton button) {
+    ButtonEvent event;
+    event.button = button;
+    event.level = digitalRead(buttons[button].pin);
+    event.timeMs = millis();
+    buttonEvents.push(event);   // 队列满时丢弃，handleInput()按当前电平补齐
 }
 
 void UIController::displayStartupScreen() {
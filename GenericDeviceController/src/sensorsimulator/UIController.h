@@ -11,7 +11,12 @@
 #include <SPI.h>
 #include <WiFi.h>
 #include <PubSubClient.h>
-#include <U8g2_for_Adafruit_GFX.h>
+#include "GlyphAtlas.h"
+#include "RotaryEncoder.h"
+#include "../core/SpscQueue.h"
+#if UI_FRAMEBUFFER
+#include "FrameCanvas.h"
+#endif
 
 // UI硬件引脚定义（内置在UIController中）
 // TFT屏幕引脚 (ST7735s)
@@ -64,14 +69,60 @@ enum SensorItem {
     ITEM_GAS = 4            // 燃气
 };
 
-// 房间名称映射（声明）
-extern const char* ROOM_NAMES[];
+// 设置页的任务轮次统计区域与刷新间隔
+#define UI_LOOP_STATS_Y           96
+#define UI_LOOP_STATS_REFRESH_MS  1000
+
+// 界面模型：屏幕上各控件当前显示的内容。每次刷新由UI状态和传感器数据生成新模型，
+// 与已显示的模型逐个控件比较，只清除并重绘发生变化的控件区域（见Config.h中的UI_INCREMENTAL_RENDER）
+#define UI_MAX_ROWS 5   // 概览页每个房间一行，房间页每个传感器项目（SensorItem）一行
+
+struct UIRowModel {
+    bool visible;       // 房间页中该房间没有的项目不显示
+    bool selected;      // 选中光标
+    uint16_t color;     // 文字颜色（选中、编辑状态）
+    int16_t value;      // 显示值×10（概览页为温度，房间页为该项目的值，烟雾/燃气为0/1）
+    int16_t value2;     // 概览页的湿度×10
+};
+
+struct UIModel {
+    bool valid;         // false表示屏幕内容未知（启动后尚未绘制），需要整页重绘
+    UIState state;
+    int room;
+    bool wifi;          // 设置页的连接状态
+    bool mqtt;
+    UIRowModel rows[UI_MAX_ROWS];
+};
+
+// 按键编号
+enum UIButton {
+    BUTTON_ENCODER = 0,     // 编码器按键
+    BUTTON_BACK,            // 返回/OK键
+    BUTTON_COUNT
+};
+
+// 按键中断记录的电平变化
+struct ButtonEvent {
+    uint8_t button;
+    uint8_t level;
+    uint32_t timeMs;
+};
+
+// 按键去抖状态
+struct ButtonState {
+    uint8_t pin;
+    uint8_t level;          // 去抖后的电平
+    uint32_t changedMs;     // 去抖后电平上次变化的时间
+};
 
 // UI控制器实现
 class UIController {
 private:
     Adafruit_ST7735 tft;
-    U8G2_FOR_ADAFRUIT_GFX u8g2;
+#if UI_FRAMEBUFFER
+    FrameCanvas canvas;     // 离屏帧缓冲
+#endif
+    Adafruit_GFX* gfx;      // 页面绘制目标：帧缓冲模式下为canvas，否则为tft
     
     // UI状态变量
     UIState currentState;
@@ -79,23 +130,17 @@ private:
     SensorItem selectedItem;
     bool editMode;
     
-    // 旋钮状态
-    volatile bool encoderPressed;
-    volatile bool backButtonPressed;
-    volatile int encoderDirection;
-    int lastEncoderA;
-    int encoderStepAccumulator;  // 步长累积器：两个咔嗒对应一个步长
-    unsigned long lastEncoderTime;  // 上次编码器活动时间
-    
-    // 按键状态记录（用于CHANGE中断的电平检测）
-    bool lastEncoderSwitchState;  // 编码器按键上次状态
-    bool lastBackButtonState;     // 返回按键上次状态
+    // 旋钮与按键
+    RotaryEncoder encoder;
+    int32_t encoderPosition;        // 累计处理的逻辑步数（顺时针为正）
+    // 两个按键中断都在GPIO中断服务中依次执行，不会相互打断，对队列而言只有一个生产者
+    SpscQueue<ButtonEvent, UI_BUTTON_EVENT_QUEUE_DEPTH> buttonEvents;
+    ButtonState buttons[BUTTON_COUNT];
     
     // 显示刷新
     unsigned long lastUpdate;
     bool needRedraw;
-    
-
+    UIModel shownModel;     // 屏幕上当前显示的内容
 
 public:
     UIController();
@@ -104,25 +149,46 @@ public:
     void handleInput();
     
     // 中断处理函数（需要设为static并绑定实例）
-    void IRAM_ATTR handleEncoderInterrupt();
     void IRAM_ATTR handleEncoderSwitchInterrupt();
     void IRAM_ATTR handleBackButtonInterrupt();
 
     // 工具函数
     void setRedraw() { needRedraw = true; }
+    UIState getState() const { return currentState; }
+    void invalidate() { shownModel.valid = false; needRedraw = true; }    // 下次刷新整页重绘
+    Adafruit_ST7735& display() { return tft; }  // 主机基准测试读取绘制像素数
+    int32_t getEncoderPosition() const { return encoderPosition; }  // 主机测试核对旋钮是否丢步
+#if UI_FRAMEBUFFER
+    const FrameCanvas& frame() const { return canvas; }
+    bool usingFrameBuffer() const { return gfx == &canvas; }
+#endif
 
 private:
-    // 页面绘制函数
-    void drawOverviewPage();
-    void drawRoomPage();
-    void drawSettingsPage();
+    // 界面模型与增量刷新
+    void buildModel(UIModel& model);
+    void render();
+    void drawChanges(const UIModel& shown, const UIModel& next);
+    void beginFrame();
+    void endFrame();
+
+    // 页面绘制函数（整页重绘）
+    void drawOverviewPage(const UIModel& model);
+    void drawRoomPage(const UIModel& model);
+    void drawSettingsPage(const UIModel& model);
+
+    // 控件绘制函数；clear为true时先清除控件区域（增量刷新）
+    void drawOverviewRow(int room, const UIRowModel& row, uint8_t parts, bool clear);
+    void drawRoomRow(SensorItem item, const UIRowModel& row, uint8_t parts, bool clear);
+    void drawRoomHint(UIState state, bool clear);
+    void drawSettingsStatus(const UIModel& model, bool clear);
+    void drawLoopStats();
     void drawHeader(const char* title);
     void drawProgressBar(int x, int y, int width, int height, float value, float maxValue);
     void drawWiFiIcon(int x, int y);
     void drawMQTTIcon(int x, int y);
     void displayStartupScreen();
     
-    // U8g2中文显示辅助函数
+    // 中文显示辅助函数（y为基线）
     void printChinese(int x, int y, const char* text, uint16_t color);
     void printChineseSmall(int x, int y, const char* text, uint16_t color);
     
@@ -130,6 +196,8 @@ private:
     void handleEncoderRotation(int direction);
     void handleEncoderPress();
     void handleBackButton();
+    void IRAM_ATTR queueButtonEvent(UIButton button);
+    void applyButtonLevel(UIButton button, uint8_t level, uint32_t timeMs);
     
     // 数据调节
     void adjustSensorValue(int direction);
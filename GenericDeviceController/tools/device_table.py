@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+设备表生成脚本
+
+把节点配置头文件（src/nodeconfig/NodeXConfig.h）中的builtin_devices列表和NODE_ID编译为二进制设备表，
+写入flash的devtable分区后，固件启动时直接映射使用（见src/core/DeviceTable.h，布局与其中的结构体一致）。
+对同一份配置，输出与固件把内置设备表编译到内存时的结果逐字节相同。
+
+重新接线或把设备移到另一个节点时，可以在命令行上增删设备，不必修改头文件、也不必重新编译固件：
+    python3 tools/device_table.py --node 1 -o node1.devtable
+    python3 tools/device_table.py --node 1 --remove bedroom/curtain --add bedroom/curtain/21 -o node1.devtable
+    python3 tools/device_table.py --dump node1.devtable
+    esptool.py --chip esp32 write_flash 0x3EF000 node1.devtable
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4C425444          # "DTBL"
+VERSION = 1
+MAX_DEVICES = 32
+MAX_ROOMS = 8
+MAX_NAMES = 24
+NODE_ID_LEN = 24
+NONE = 0xFF
+FLAG_VIRTUAL = 0x01
+PARTITION_OFFSET = 0x3EF000     # partitions_devtable.csv中devtable分区的地址
+PARTITION_SIZE = 0x1000
+
+# magic, version, size, crc32, node_id, device_count, room_count, name_count, reserved,
+# rooms_offset, names_offset, entries_offset, index_offset
+HEADER = struct.Struct("<IHHI%dsBBBBHHHH" % NODE_ID_LEN)
+ENTRY = struct.Struct("<BBBB")
+assert HEADER.size == 48
+
+
+# =================== 读取节点配置 ===================
+
+def parse_config(path):
+    """返回(NODE_ID, [(room_id, device_id, pin, is_virtual), ...])"""
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    source = re.sub(r"//[^\n]*", "", source)
+
+    node_id = re.search(r'NODE_ID\s*=\s*"([^"]*)"', source)
+    block = re.search(r"builtin_devices\s*\[[^\]]*\]\s*=\s*\{(.*?)\};", source, flags=re.S)
+    if node_id is None or block is None:
+        sys.exit(f"{path}: NODE_ID or builtin_devices[] not found")
+    devices = []
+    for room, name, pin, virtual in re.findall(
+            r'\{\s*"([^"]+)"\s*,\s*"([^"]+)"\s*,\s*(\d+)\s*,\s*(true|false)\s*\}', block.group(1)):
+        devices.append((room, name, int(pin), virtual == "true"))
+    return node_id.group(1), devices
+
+
+def parse_device(text):
+    """ROOM/NAME/PIN[/virtual]"""
+    parts = text.split("/")
+    if len(parts) not in (3, 4) or not parts[2].isdigit() or (len(parts) == 4 and parts[3] != "virtual"):
+        raise argparse.ArgumentTypeError(f"expected ROOM/NAME/PIN[/virtual], got '{text}'")
+    return parts[0], parts[1], int(parts[2]), len(parts) == 4
+
+
+# =================== 编译与解析 ===================
+
+def compile_table(node_id, devices):
+    """按DeviceTable.h中device_table_compile()的布局生成设备表"""
+    if len(devices) > MAX_DEVICES:
+        sys.exit(f"{len(devices)} devices, at most {MAX_DEVICES}")
+    rooms, names = [], []
+    for room, name, _, _ in devices:
+        if room not in rooms:
+            rooms.append(room)
+        if name not in names:
+            names.append(name)
+    if len(rooms) > MAX_ROOMS or len(names) > MAX_NAMES:
+        sys.exit(f"{len(rooms)} rooms / {len(names)} device names, at most {MAX_ROOMS} / {MAX_NAMES}")
+    node_bytes = node_id.encode()
+    if len(node_bytes) >= NODE_ID_LEN:
+        sys.exit(f"node id '{node_id}' is longer than {NODE_ID_LEN - 1} bytes")
+
+    rooms_offset = HEADER.size
+    names_offset = rooms_offset + 2 * len(rooms)
+    entries_offset = (names_offset + 2 * len(names) + 3) & ~3
+    index_offset = entries_offset + ENTRY.size * len(devices)
+    strings_offset = index_offset + len(rooms) * len(names)
+
+    strings = bytearray()
+    string_offsets = []
+    for text in rooms + names:
+        string_offsets.append(strings_offset + len(strings))
+        strings += text.encode() + b"\0"
+
+    index = bytearray([NONE]) * (len(rooms) * len(names))
+    entries = bytearray()
+    for i, (room, name, pin, virtual) in enumerate(devices):
+        slot = rooms.index(room) * len(names) + names.index(name)
+        if index[slot] != NONE:
+            sys.exit(f"duplicate device {room}/{name}")
+        if pin > 0xFF:
+            sys.exit(f"{room}/{name}: invalid pin {pin}")
+        index[slot] = i
+        entries += ENTRY.pack(rooms.index(room), names.index(name), pin, FLAG_VIRTUAL if virtual else 0)
+
+    body = bytearray()
+    body += struct.pack("<%dH" % len(rooms), *string_offsets[:len(rooms)])
+    body += struct.pack("<%dH" % len(names), *string_offsets[len(rooms):])
+    body += bytes(entries_offset - names_offset - 2 * len(names))
+    body += entries + index + strings
+    size = HEADER.size + len(body)
+    if size > PARTITION_SIZE:
+        sys.exit(f"device table is {size} bytes, the partition holds {PARTITION_SIZE}")
+
+    header = HEADER.pack(MAGIC, VERSION, size, zlib.crc32(body) & 0xFFFFFFFF, node_bytes,
+                         len(devices), len(rooms), len(names), 0,
+                         rooms_offset, names_offset, entries_offset, index_offset)
+    return header + bytes(body)
+
+
+def decode_table(blob):
+    """返回(NODE_ID, 设备列表)，内容无效时退出"""
+    if len(blob) < HEADER.size:
+        sys.exit("not a device table: too short")
+    (magic, version, size, crc, node_id, device_count, room_count, name_count, _,
+     rooms_offset, names_offset, entries_offset, _) = HEADER.unpack_from(blob)
+    if magic != MAGIC or version != VERSION or size > len(blob):
+        sys.exit("not a device table (bad magic, version or size)")
+    if zlib.crc32(blob[HEADER.size:size]) & 0xFFFFFFFF != crc:
+        sys.exit("device table CRC mismatch")
+
+    def string_at(offset):
+        return blob[offset:blob.index(b"\0", offset)].decode()
+
+    rooms = [string_at(o) for o in struct.unpack_from("<%dH" % room_count, blob, rooms_offset)]
+    names = [string_at(o) for o in struct.unpack_from("<%dH" % name_count, blob, names_offset)]
+    devices = []
+    for i in range(device_count):
+        room, name, pin, flags = ENTRY.unpack_from(blob, entries_offset + i * ENTRY.size)
+        devices.append((rooms[room], names[name], pin, bool(flags & FLAG_VIRTUAL)))
+    return node_id.rstrip(b"\0").decode(), devices
+
+
+def print_table(node_id, devices, size):
+    print(f"[DevTable] node {node_id or '(firmware default)'}: {len(devices)} device(s), {size} bytes")
+    for room, name, pin, virtual in devices:
+        print(f"  {room + '/' + name:<32} {'virtual' if virtual else 'pin %d' % pin}")
+
+
+def main():
+    project = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    parser = argparse.ArgumentParser(description="Compile a node config header into a devtable partition image")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--node", type=int, help="read src/nodeconfig/Node<N>Config.h")
+    source.add_argument("--config", help="path to a node config header")
+    source.add_argument("--dump", metavar="FILE", help="print the contents of a device table image")
+    parser.add_argument("--node-id", help="override NODE_ID (MQTT client id)")
+    parser.add_argument("--add", type=parse_device, action="append", default=[], metavar="ROOM/NAME/PIN[/virtual]")
+    parser.add_argument("--remove", action="append", default=[], metavar="ROOM/NAME")
+    parser.add_argument("-o", "--output", help="output file (default: print only)")
+    args = parser.parse_args()
+
+    if args.dump:
+        with open(args.dump, "rb") as f:
+            blob = f.read()
+        node_id, devices = decode_table(blob)
+        print_table(node_id, devices, HEADER.unpack_from(blob)[2])
+        return
+
+    path = args.config or os.path.join(project, "src", "nodeconfig", f"Node{args.node}Config.h")
+    node_id, devices = parse_config(path)
+    for removed in args.remove:
+        kept = [d for d in devices if f"{d[0]}/{d[1]}" != removed]
+        if len(kept) == len(devices):
+            sys.exit(f"--remove {removed}: no such device")
+        devices = kept
+    devices += args.add
+    if args.node_id is not None:
+        node_id = args.node_id
+
+    blob = compile_table(node_id, devices)
+    print_table(node_id, devices, len(blob))
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(blob)
+        print(f"[DevTable] wrote {args.output}; flash with:\n"
+              f"  esptool.py --chip esp32 write_flash 0x{PARTITION_OFFSET:X} {args.output}")
+
+
+if __name__ == "__main__":
+    main()
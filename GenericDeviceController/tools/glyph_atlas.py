@@ -0,0 +1,341 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+UI字形图集生成脚本
+
+扫描src/sensorsimulator/UIController.cpp中界面显示的字符串和src/core/Symbols.h中的房间显示名（跳过LOG_*日志和注释），
+从U8g2的wqy12字体（u8g2_fonts.c中的u8g2_font_wqy12_t_gb2312）中只取出用到的字形，
+生成src/sensorsimulator/GlyphAtlasData.h：每个字形的位图（Adafruit_GFX drawBitmap格式，逐行、高位在前）、
+度量信息，以及按码点直接取下标的完美哈希表。固件不再链接整套GB2312字体。
+
+作为PlatformIO的pre脚本在每次编译前运行（见platformio.ini的extra_scripts），内容未变化时不改写输出文件；
+native平台（主机构建）没有真实字体，使用按码点生成的替身字形。
+
+也可以单独运行：
+    python3 tools/glyph_atlas.py --font <U8g2_for_Adafruit_GFX/src/u8g2_fonts.c>
+    python3 tools/glyph_atlas.py --mock-font
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+FONT_NAME = "u8g2_font_wqy12_t_gb2312"
+UI_SOURCES = (os.path.join("src", "sensorsimulator", "UIController.cpp"),
+              os.path.join("src", "core", "Symbols.h"))
+OUTPUT = os.path.join("src", "sensorsimulator", "GlyphAtlasData.h")
+EMPTY_SLOT = 0xFF
+
+
+# =================== UI字符串 ===================
+
+def collect_ui_text(path):
+    """返回界面字符串中用到的全部字符（含其中的ASCII字符）"""
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    chars = set()
+    for line in source.splitlines():
+        code = re.sub(r'//(?=(?:[^"]*"[^"]*")*[^"]*$).*', "", line)
+        if "LOG_" in code:
+            continue
+        for literal in re.findall(r'"((?:[^"\\]|\\.)*)"', code):
+            if any(ord(c) > 0x7F for c in literal):
+                chars.update(c for c in literal if c >= " ")
+    return sorted(chars, key=ord)
+
+
+# =================== U8g2字体 ===================
+
+def read_c_byte_string(path, name):
+    """从C源文件中取出名为name的字体数组（由字符串字面量拼接而成）"""
+    with open(path, encoding="latin-1") as f:
+        source = f.read()
+    match = re.search(r"\b" + re.escape(name) + r"\s*\[[^\]]*\][^=]*=", source)
+    if not match:
+        raise ValueError(f"{name} not found in {path}")
+    end = source.index(";", match.end())
+    data = bytearray()
+    for literal in re.findall(r'"((?:[^"\\]|\\.)*)"', source[match.end():end], flags=re.S):
+        data += decode_c_escapes(literal)
+    return bytes(data)
+
+
+def decode_c_escapes(literal):
+    out = bytearray()
+    i = 0
+    simple = {"n": 10, "t": 9, "r": 13, "a": 7, "b": 8, "f": 12, "v": 11, "\\": 92, '"': 34, "'": 39, "?": 63}
+    while i < len(literal):
+        c = literal[i]
+        if c != "\\":
+            out.append(ord(c))
+            i += 1
+            continue
+        i += 1
+        c = literal[i]
+        if c in "01234567":
+            digits = re.match(r"[0-7]{1,3}", literal[i:]).group(0)
+            out.append(int(digits, 8) & 0xFF)
+            i += len(digits)
+        elif c == "x":
+            digits = re.match(r"[0-9a-fA-F]+", literal[i + 1:]).group(0)
+            out.append(int(digits, 16) & 0xFF)
+            i += 1 + len(digits)
+        else:
+            out.append(simple[c])
+            i += 1
+    return bytes(out)
+
+
+class BitReader:
+    """U8g2字形数据的位流，每字节从低位读起"""
+
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+        self.bit = 0
+
+    def unsigned(self, count):
+        value = 0
+        for i in range(count):
+            if self.data[self.pos] >> self.bit & 1:
+                value |= 1 << i
+            self.bit += 1
+            if self.bit == 8:
+                self.bit = 0
+                self.pos += 1
+        return value
+
+    def signed(self, count):
+        return self.unsigned(count) - (1 << (count - 1))
+
+
+class U8g2Font:
+    """U8g2字体格式：23字节字体头，ASCII字形区，Unicode查找表与字形区"""
+
+    def __init__(self, data):
+        self.data = data
+        (self.glyph_count, self.bbx_mode, self.bits_0, self.bits_1, self.bits_w, self.bits_h,
+         self.bits_x, self.bits_y, self.bits_dx) = data[0:9]
+        self.start_unicode = data[21] << 8 | data[22]
+        self.glyphs = {}
+        self._index_ascii()
+        self._index_unicode()
+
+    def _index_ascii(self):
+        pos = 23
+        while pos + 1 < len(self.data) and self.data[pos + 1] != 0:
+            self.glyphs[self.data[pos]] = pos + 2
+            pos += self.data[pos + 1]
+
+    def _index_unicode(self):
+        table = 23 + self.start_unicode
+        # 新版字体在Unicode字形前有一张(偏移, 码点)跳转表，第一项的偏移即表长；旧版字形紧接在字体头之后
+        for glyph_start in ((table + (self.data[table] << 8 | self.data[table + 1])), table):
+            glyphs = self._walk_unicode(glyph_start)
+            if glyphs:
+                self.glyphs.update(glyphs)
+                return
+        raise ValueError("cannot locate unicode glyphs in font")
+
+    def _walk_unicode(self, pos):
+        glyphs = {}
+        last = 0
+        while pos + 1 < len(self.data):
+            code = self.data[pos] << 8 | self.data[pos + 1]
+            if code == 0:
+                return glyphs
+            size = self.data[pos + 2] if pos + 2 < len(self.data) else 0
+            if code <= last or size < 3:
+                return None
+            glyphs[code] = pos + 3
+            last = code
+            pos += size
+        return None
+
+    def glyph(self, code):
+        """返回(宽, 高, 水平偏移, 顶部相对基线的偏移, 前进宽度, 按行的像素列表)，字体中没有该字符时返回None"""
+        if code not in self.glyphs:
+            return None
+        reader = BitReader(self.data, self.glyphs[code])
+        width = reader.unsigned(self.bits_w)
+        height = reader.unsigned(self.bits_h)
+        x = reader.signed(self.bits_x)
+        y = reader.signed(self.bits_y)
+        advance = reader.signed(self.bits_dx)
+        pixels = [0] * (width * height)
+        if width > 0:
+            position = 0
+            while True:
+                zeros = reader.unsigned(self.bits_0)
+                ones = reader.unsigned(self.bits_1)
+                while True:
+                    position += zeros
+                    for i in range(ones):
+                        if position + i < len(pixels):
+                            pixels[position + i] = 1
+                    position += ones
+                    if reader.unsigned(1) == 0:
+                        break
+                if position >= width * height:
+                    break
+        rows = [pixels[r * width:(r + 1) * width] for r in range(height)]
+        return width, height, x, -(height + y), advance, rows
+
+
+class MockFont:
+    """主机构建用的替身字形：按码点生成固定点阵，中文11x11，ASCII 5x8"""
+
+    def glyph(self, code):
+        wide = code > 0x7F
+        width, height = (11, 11) if wide else (5, 8)
+        rows = []
+        for r in range(height):
+            seed = ((code + 1) * 2654435761 + r * 40503) & 0xFFFFFFFF
+            seed ^= seed >> 15
+            rows.append([(seed >> c) & 1 for c in range(width)])
+        return width, height, 0, -10 if wide else -8, 12 if wide else 6, rows
+
+
+# =================== 图集 ===================
+
+def perfect_hash(codes):
+    """找到乘数与表大小，使(code * multiplier) >> (32 - bits)两两不同"""
+    bits = max(4, (len(codes) * 4 - 1).bit_length())
+    while True:
+        for i in range(200000):
+            multiplier = (2654435761 + 2 * i) & 0xFFFFFFFF
+            slots = {((code * multiplier) & 0xFFFFFFFF) >> (32 - bits) for code in codes}
+            if len(slots) == len(codes):
+                return multiplier, bits
+        bits += 1
+
+
+def pack_rows(rows, width):
+    data = bytearray()
+    for row in rows:
+        for byte_start in range(0, width, 8):
+            value = 0
+            for i in range(8):
+                if byte_start + i < width and row[byte_start + i]:
+                    value |= 0x80 >> i
+            data.append(value)
+    return data
+
+
+def generate(chars, font, font_label):
+    glyphs = []
+    missing = []
+    bitmaps = bytearray()
+    for char in chars:
+        glyph = font.glyph(ord(char))
+        if glyph is None:
+            missing.append(char)
+            continue
+        width, height, left, top, advance, rows = glyph
+        glyphs.append((ord(char), width, height, left, top, advance, len(bitmaps), char))
+        bitmaps += pack_rows(rows, width)
+    if len(glyphs) >= EMPTY_SLOT:
+        raise ValueError("too many glyphs for an 8-bit slot table")
+
+    codes = [g[0] for g in glyphs]
+    multiplier, bits = perfect_hash(codes)
+    slots = [EMPTY_SLOT] * (1 << bits)
+    for index, code in enumerate(codes):
+        slots[((code * multiplier) & 0xFFFFFFFF) >> (32 - bits)] = index
+
+    lines = [
+        "// GlyphAtlasData.h",
+        f"// 由tools/glyph_atlas.py根据{'、'.join(p.replace(os.sep, '/') for p in UI_SOURCES)}生成，不要手动修改",
+        f"// 字体：{font_label}，{len(glyphs)}个字形，位图{len(bitmaps)}字节，哈希表{len(slots)}项",
+        "#ifndef GLYPH_ATLAS_DATA_H",
+        "#define GLYPH_ATLAS_DATA_H",
+        "",
+        f"#define GLYPH_ATLAS_COUNT           {len(glyphs)}",
+        f"#define GLYPH_ATLAS_HASH_MULTIPLIER 0x{multiplier:08X}u",
+        f"#define GLYPH_ATLAS_HASH_BITS       {bits}",
+        "",
+        "static const GlyphInfo GLYPH_ATLAS_GLYPHS[GLYPH_ATLAS_COUNT] = {",
+    ]
+    for code, width, height, left, top, advance, offset, char in glyphs:
+        label = char if char not in "\\" else "\\\\"
+        lines.append(f"    {{0x{code:04X}, {width}, {height}, {left}, {top}, {advance}, {offset}}},  // {label}")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const uint8_t GLYPH_ATLAS_SLOTS[1 << GLYPH_ATLAS_HASH_BITS] = {")
+    for i in range(0, len(slots), 16):
+        lines.append("    " + ", ".join(f"0x{s:02X}" for s in slots[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append(f"static const uint8_t GLYPH_ATLAS_BITMAPS[{max(1, len(bitmaps))}] = {{")
+    for i in range(0, len(bitmaps), 16):
+        lines.append("    " + ", ".join(f"0x{b:02X}" for b in bitmaps[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // GLYPH_ATLAS_DATA_H")
+    return "\n".join(lines) + "\n", glyphs, missing, len(bitmaps)
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == content:
+                return False
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(content)
+    return True
+
+
+def build_atlas(project_dir, font_path=None, mock=False):
+    chars = sorted(set().union(*(collect_ui_text(os.path.join(project_dir, p)) for p in UI_SOURCES)), key=ord)
+    if mock:
+        font, label = MockFont(), "主机构建替身字形"
+    else:
+        font, label = U8g2Font(read_c_byte_string(font_path, FONT_NAME)), FONT_NAME
+    content, glyphs, missing, size = generate(chars, font, label)
+    if missing:
+        raise ValueError("glyphs missing from font: " + "".join(missing))
+    changed = write_if_changed(os.path.join(project_dir, OUTPUT), content)
+    print(f"[GlyphAtlas] {len(glyphs)} glyph(s), {size} bitmap byte(s) from {label}"
+          f"{', updated ' + OUTPUT if changed else ''}")
+
+
+def find_font(project_dir, libdeps_dir=None):
+    patterns = []
+    if libdeps_dir:
+        patterns.append(os.path.join(libdeps_dir, "*", "U8g2_for_Adafruit_GFX*", "src", "u8g2_fonts.c"))
+    patterns.append(os.path.join(project_dir, ".pio", "libdeps", "*", "U8g2_for_Adafruit_GFX*", "src", "u8g2_fonts.c"))
+    for pattern in patterns:
+        found = sorted(glob.glob(pattern))
+        if found:
+            return found[0]
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the UI glyph atlas")
+    parser.add_argument("--font", help="path to U8g2_for_Adafruit_GFX/src/u8g2_fonts.c")
+    parser.add_argument("--mock-font", action="store_true", help="use stand-in glyphs (host build)")
+    parser.add_argument("--project", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+    args = parser.parse_args()
+    font = args.font or (None if args.mock_font else find_font(args.project))
+    if font is None and not args.mock_font:
+        sys.exit("u8g2_fonts.c not found; install the U8g2_for_Adafruit_GFX library or pass --font")
+    build_atlas(args.project, font, args.mock_font)
+
+
+if __name__ == "__main__":
+    main()
+elif "Import" in globals():
+    # PlatformIO pre脚本（SCons执行时提供Import）
+    Import("env")  # noqa: F821
+    project = env.subst("$PROJECT_DIR")  # noqa: F821
+    if env.subst("$PIOPLATFORM") == "native":  # noqa: F821
+        build_atlas(project, mock=True)
+    else:
+        font_path = find_font(project, env.subst("$PROJECT_LIBDEPS_DIR"))  # noqa: F821
+        if font_path is None:
+            sys.exit("[GlyphAtlas] u8g2_fonts.c not found, run `pio pkg install` first")
+        build_atlas(project, font_path)
@@ -7,8 +7,19 @@ MQTT_BROKER_HOST = "localhost"
 # MQTT Broker 端口
 MQTT_BROKER_PORT = 1883
 
+# 命令的发布QoS。ESP32以持久会话和QoS 1订阅命令Topic时，Broker会在节点短暂断线期间缓存QoS 1的命令，
+# 节点重连后补发；QoS 0的命令在节点离线时直接丢弃
+MQTT_COMMAND_QOS = 1
+
 # API 请求的超时时间（单位：秒）。
 # 如果 FastAPI 发出命令后，在这个时间内没有收到ESP32的执行回执，
 # 就会认为请求失败，并向客户端返回一个超时错误。
 # 注意：窗帘设备需要较长时间（约6秒）来完成物理动作，所以超时时间设置为8秒
-API_REQUEST_TIMEOUT = 8
\ No newline at end of file
+API_REQUEST_TIMEOUT = 8
+
+# 批量命令（场景）单次最多包含的设备命令数，需与ESP32端BATCH_MAX_ENTRIES一致
+BATCH_MAX_COMMANDS = 16
+
+# 发送给ESP32的命令编码格式："json" 或 "msgpack"
+# 节点按收到命令的格式返回回执，API服务对两种格式的回执都能解码
+PAYLOAD_FORMAT = "json"
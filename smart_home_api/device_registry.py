@@ -34,6 +34,10 @@ DEVICE_REGISTRY = {
         "brightness_sensor": {
             "type": "sensor",
             "valid_actions": ["READ"]
+        },
+        "sensors": {
+            "type": "snapshot",
+            "valid_actions": ["READ_ALL"]
         }
     },
     "bedroom": {
@@ -72,6 +76,10 @@ DEVICE_REGISTRY = {
         "brightness_sensor": {
             "type": "sensor",
             "valid_actions": ["READ"]
+        },
+        "sensors": {
+            "type": "snapshot",
+            "valid_actions": ["READ_ALL"]
         }
     },
     "kitchen": {
@@ -98,6 +106,10 @@ DEVICE_REGISTRY = {
         "gas_sensor": {
             "type": "sensor",
             "valid_actions": ["READ"]
+        },
+        "sensors": {
+            "type": "snapshot",
+            "valid_actions": ["READ_ALL"]
         }
     },
     "bathroom": {
@@ -120,6 +132,10 @@ DEVICE_REGISTRY = {
         "humidity_sensor": {
             "type": "sensor",
             "valid_actions": ["READ"]
+        },
+        "sensors": {
+            "type": "snapshot",
+            "valid_actions": ["READ_ALL"]
         }
     },
     "outdoor": {
@@ -134,10 +150,29 @@ DEVICE_REGISTRY = {
         "brightness_sensor": {
             "type": "sensor",
             "valid_actions": ["READ"]
+        },
+        "sensors": {
+            "type": "snapshot",
+            "valid_actions": ["READ_ALL"]
         }
     }
 }
 
+# 传感器快照数组的字段顺序，与ESP32端core/AckMessages.h的write_sensor_rooms()一致
+SENSOR_SNAPSHOT_FIELDS = ["temperature", "humidity", "brightness", "smoke_detected", "gas_leak"]
+
+def expand_sensor_snapshot(rooms: dict) -> dict:
+    """
+    将节点返回的紧凑快照 {"room": [t, h, b, smoke, gas]} 展开为带字段名的字典
+    """
+    expanded = {}
+    for room_id, values in rooms.items():
+        room = dict(zip(SENSOR_SNAPSHOT_FIELDS, values))
+        room["smoke_detected"] = bool(room.get("smoke_detected"))
+        room["gas_leak"] = bool(room.get("gas_leak"))
+        expanded[room_id] = room
+    return expanded
+
 def is_valid_request(room_id: str, device_id: str, action: str) -> bool:
     """
     校验API请求是否合法
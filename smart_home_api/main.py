@@ -2,16 +2,16 @@
 # FastAPI Web服务入口，定义API接口和处理HTTP请求。
 
 import uuid
-import json
 import asyncio
 from fastapi import FastAPI, HTTPException, status
 from pydantic import BaseModel
-from typing import Optional
+from typing import Optional, List
 
-from .config import API_REQUEST_TIMEOUT
+from .config import API_REQUEST_TIMEOUT, BATCH_MAX_COMMANDS
 from .mqtt_client import mqtt_client
 from .request_manager import request_manager
-from .device_registry import is_valid_request
+from .device_registry import is_valid_request, expand_sensor_snapshot
+from .telemetry_cache import telemetry_cache
 
 # 初始化FastAPI应用
 app = FastAPI(title="Smart Home API")
@@ -21,6 +21,17 @@ class ActionRequest(BaseModel):
     action: str
     value: Optional[int] = None # value是可选的，因为有些命令不需要值，比如开灯和关灯
 
+# 批量命令中的单个设备命令
+class BatchCommand(BaseModel):
+    room: str
+    device: str
+    action: str
+    value: Optional[int] = None
+
+# 批量命令请求体，所有命令由同一个节点在一次回调中执行
+class BatchRequest(BaseModel):
+    commands: List[BatchCommand]
+
 # FastAPI生命周期事件：应用启动时执行
 @app.on_event("startup")
 def startup_event():
@@ -85,7 +96,7 @@ async def device_action(room_id: str, device_id: str, req: ActionRequest):
         mqtt_client.subscribe(state_topic)
         
         # 8. 发布命令
-        mqtt_client.publish(command_topic, json.dumps(payload))
+        mqtt_client.publish(command_topic, payload)
 
         # 9. 等待设备执行确认，如果设备在规定时间内没有响应，则抛出超时异常
         # 程序会在这里阻塞，直到event.set()被调用，或者超时
@@ -94,7 +105,15 @@ async def device_action(room_id: str, device_id: str, req: ActionRequest):
         # 10. 从RequestManager获取设备返回的结果
         result = request_manager.get_result(correlation_id)
         
-        # 11. 检查设备是否返回错误状态
+        # 11. 同一设备的较新命令在执行前到达，本命令被节点合并掉，不会执行
+        if result and result.get("state") == "SUPERSEDED":
+            # 409表示该请求与之后的请求冲突，设备最终状态以较新的请求为准
+            raise HTTPException(
+                status_code=status.HTTP_409_CONFLICT,
+                detail="Command superseded by a newer command for the same device."
+            )
+
+        # 12. 检查设备是否返回错误状态
         if result and result.get("state") == "ERROR":
             # 502表示设备返回了错误状态
             error_code = result.get("error_code", "UNKNOWN_ERROR")
@@ -119,6 +138,14 @@ async def device_action(room_id: str, device_id: str, req: ActionRequest):
                     status_code=status.HTTP_502_BAD_GATEWAY,
                     detail="Sensor data incomplete or malformed"
                 )
+        elif device_id == "sensors" and req.action == "READ_ALL":
+            # 房间级传感器快照响应 - 一条回执包含该房间全部传感器数据
+            if result and "rooms" in result:
+                return {"status": "success", "snapshot": expand_sensor_snapshot(result["rooms"])}
+            raise HTTPException(
+                status_code=status.HTTP_502_BAD_GATEWAY,
+                detail="Sensor snapshot incomplete or malformed"
+            )
         elif device_id == "ac" and req.action == "SET_TEMP":
             # 空调温度设置响应 - 包含温度信息
             return {"status": "success", "confirmed_result": result}
@@ -134,5 +161,124 @@ async def device_action(room_id: str, device_id: str, req: ActionRequest):
             detail="Device did not respond in time."
         )
     finally:
-        # 12. 取消订阅状态Topic，释放资源。这可以防止API服务不必要地接收该设备未来的所有状态更新
-        mqtt_client.unsubscribe(state_topic)
\ No newline at end of file
+        # 13. 取消订阅状态Topic，释放资源。这可以防止API服务不必要地接收该设备未来的所有状态更新
+        mqtt_client.unsubscribe(state_topic)
+
+# 定义遥测查询API接口，直接返回节点主动上报的最新传感器数据，无需向设备发送命令
+@app.get("/api/v1/telemetry", status_code=status.HTTP_200_OK)
+async def get_telemetry():
+    """
+    返回遥测缓存中所有房间的最新传感器数据
+    """
+    return {"status": "success", "rooms": telemetry_cache.get_all()}
+
+# 定义节点级传感器快照API接口，一次请求返回节点上全部房间的传感器数据
+@app.get("/api/v1/nodes/{node_id}/sensors", status_code=status.HTTP_200_OK)
+async def node_sensors(node_id: str):
+    """
+    向节点发送READ_ALL命令，并等待包含全部房间传感器数据的快照回执
+    """
+    correlation_id = str(uuid.uuid4())
+    event = request_manager.start_request(correlation_id)
+
+    command_topic = f"smarthome/{node_id}/sensors/command"
+    state_topic = f"smarthome/{node_id}/sensors/state"
+    payload = {
+        "action": "READ_ALL",
+        "correlation_id": correlation_id
+    }
+
+    try:
+        mqtt_client.subscribe(state_topic)
+        mqtt_client.publish(command_topic, payload)
+        await asyncio.wait_for(event.wait(), timeout=API_REQUEST_TIMEOUT)
+        result = request_manager.get_result(correlation_id)
+
+        if result and result.get("state") == "ERROR":
+            error_code = result.get("error_code", "UNKNOWN_ERROR")
+            error_message = result.get("error_message", "Device reported an error")
+            raise HTTPException(
+                status_code=status.HTTP_502_BAD_GATEWAY,
+                detail=f"Device error: {error_code} - {error_message}"
+            )
+        if not result or "rooms" not in result:
+            raise HTTPException(
+                status_code=status.HTTP_502_BAD_GATEWAY,
+                detail="Sensor snapshot incomplete or malformed"
+            )
+        return {"status": "success", "snapshot": expand_sensor_snapshot(result["rooms"])}
+
+    except asyncio.TimeoutError:
+        raise HTTPException(
+            status_code=status.HTTP_504_GATEWAY_TIMEOUT,
+            detail="Device did not respond in time."
+        )
+    finally:
+        mqtt_client.unsubscribe(state_topic)
+
+# 定义批量控制API接口（场景），一次请求对应节点的一条汇总回执
+@app.post("/api/v1/nodes/{node_id}/batch", status_code=status.HTTP_200_OK)
+async def node_batch(node_id: str, req: BatchRequest):
+    """
+    将多个设备命令打包发送给同一节点，并等待节点返回汇总回执
+    """
+    # 1. 校验命令数量和每条命令的合法性
+    if not req.commands or len(req.commands) > BATCH_MAX_COMMANDS:
+        raise HTTPException(
+            status_code=status.HTTP_400_BAD_REQUEST,
+            detail=f"Batch must contain 1-{BATCH_MAX_COMMANDS} commands."
+        )
+    for index, cmd in enumerate(req.commands):
+        if not is_valid_request(cmd.room, cmd.device, cmd.action):
+            raise HTTPException(
+                status_code=status.HTTP_400_BAD_REQUEST,
+                detail=f"Invalid command at index {index}: room, device, or action not recognized."
+            )
+        if cmd.device == "ac" and cmd.action in ["ON", "SET_TEMP"]:
+            if cmd.value is None or cmd.value < 0 or cmd.value > 40:
+                raise HTTPException(
+                    status_code=status.HTTP_400_BAD_REQUEST,
+                    detail=f"Invalid command at index {index}: AC {cmd.action} operation requires valid temperature value (0-40°C)."
+                )
+
+    # 2. 生成关联ID并开始等待
+    correlation_id = str(uuid.uuid4())
+    event = request_manager.start_request(correlation_id)
+
+    command_topic = f"smarthome/{node_id}/batch/command"
+    state_topic = f"smarthome/{node_id}/batch/state"
+    payload = {
+        "correlation_id": correlation_id,
+        "commands": [cmd.dict() for cmd in req.commands]
+    }
+
+    try:
+        # 3. 先订阅回执Topic再发布命令
+        mqtt_client.subscribe(state_topic)
+        mqtt_client.publish(command_topic, payload)
+
+        # 4. 等待汇总回执（含舵机条目时在最后一个舵机结束后返回）
+        await asyncio.wait_for(event.wait(), timeout=API_REQUEST_TIMEOUT)
+        result = request_manager.get_result(correlation_id)
+
+        # 5. 整条批量命令被拒绝（JSON错误、条目过多、上一条批量命令未结束等）
+        if result and result.get("state") == "ERROR":
+            error_code = result.get("error_code", "UNKNOWN_ERROR")
+            error_message = result.get("error_message", "Device reported an error")
+            raise HTTPException(
+                status_code=status.HTTP_502_BAD_GATEWAY,
+                detail=f"Device error: {error_code} - {error_message}"
+            )
+
+        # 6. 逐条结果原样返回，部分条目失败不影响整体状态码
+        results = result.get("results", []) if result else []
+        failed = sum(1 for item in results if item.get("state") == "ERROR")
+        return {"status": "success" if failed == 0 else "partial", "failed": failed, "results": results}
+
+    except asyncio.TimeoutError:
+        raise HTTPException(
+            status_code=status.HTTP_504_GATEWAY_TIMEOUT,
+            detail="Device did not respond in time."
+        )
+    finally:
+        mqtt_client.unsubscribe(state_topic)
@@ -1,9 +1,10 @@
 # 封装MQTT通信相关逻辑。
 
-import json
 import paho.mqtt.client as mqtt
-from .config import MQTT_BROKER_HOST, MQTT_BROKER_PORT
+from .config import MQTT_BROKER_HOST, MQTT_BROKER_PORT, MQTT_COMMAND_QOS
 from .request_manager import request_manager
+from .telemetry_cache import telemetry_cache, TELEMETRY_TOPIC
+from . import payload_codec
 
 class MQTTClient:
     # 单例模式，确保全局只有一个MQTT客户端实例
@@ -41,12 +42,12 @@ class MQTTClient:
         self.client.disconnect()
         print("Disconnected from MQTT Broker.")
 
-    def publish(self, topic: str, payload: str):
+    def publish(self, topic: str, payload: dict):
         """
-        发布消息到指定Topic
+        按配置的编码格式和QoS发布消息到指定Topic
         """
         print(f"[MQTT] Publishing to topic '{topic}': {payload}")
-        self.client.publish(topic, payload)
+        self.client.publish(topic, payload_codec.encode(payload), qos=MQTT_COMMAND_QOS)
 
     def subscribe(self, topic: str):
         """
@@ -72,6 +73,8 @@ class MQTTClient:
         """
         if rc == 0: # 连接成功
             print("Successfully connected to MQTT Broker.")
+            # 订阅传感器遥测，放在on_connect中以便重连后自动恢复订阅
+            client.subscribe(TELEMETRY_TOPIC)
         else: # 连接失败
             print(f"Failed to connect, return code {rc}\n")
 
@@ -80,10 +83,14 @@ class MQTTClient:
         任何已订阅的Topic收到消息时，都会调用此回调函数
         接收设备执行回执（ACK）的核心入口点
         """
-        print(f"[MQTT] Received message on topic '{msg.topic}': {msg.payload.decode()}")
         try:
-            # 解析收到的JSON消息
-            payload = json.loads(msg.payload.decode())
+            # 解析收到的消息（JSON或MessagePack）
+            payload = payload_codec.decode(msg.payload)
+            print(f"[MQTT] Received message on topic '{msg.topic}': {payload}")
+            # 传感器遥测没有correlation_id，直接更新缓存
+            if msg.topic.endswith("/sensors/telemetry"):
+                telemetry_cache.update(payload)
+                return
             # 提取最重要的correlation_id
             correlation_id = payload.get("correlation_id")
 
@@ -0,0 +1,21 @@
+# 消息编码，负责命令和回执在JSON与MessagePack之间的编解码。
+
+import json
+import msgpack
+from .config import PAYLOAD_FORMAT
+
+def encode(payload: dict) -> bytes:
+    """
+    按配置的格式编码命令。ESP32节点会以相同的格式返回回执
+    """
+    if PAYLOAD_FORMAT == "msgpack":
+        return msgpack.packb(payload, use_bin_type=True)
+    return json.dumps(payload).encode()
+
+def decode(data: bytes) -> dict:
+    """
+    解码节点发布的消息，按首字节自动识别格式：JSON以'{'开头，MessagePack以map类型字节开头
+    """
+    if data and (data[0] & 0xF0 == 0x80 or data[0] in (0xDE, 0xDF)):
+        return msgpack.unpackb(data, raw=False)
+    return json.loads(data.decode())
@@ -0,0 +1,35 @@
+# 传感器遥测缓存，保存ESP32节点主动上报的最新传感器数据。
+
+import time
+from .device_registry import expand_sensor_snapshot
+
+# 遥测Topic，节点在传感器数据变化（超过死区）、烟雾/燃气跳变或心跳到期时发布
+TELEMETRY_TOPIC = "smarthome/+/sensors/telemetry"
+
+class TelemetryCache:
+    # 单例模式，确保全局只有一个TelemetryCache实例
+    _instance = None
+    def __new__(cls, *args, **kwargs):
+        if not cls._instance:
+            cls._instance = super().__new__(cls)
+            cls._rooms = {}  # _rooms: key为room_id，value为展开后的传感器数据及更新时间
+        return cls._instance
+
+    def update(self, payload: dict):
+        """
+        收到遥测消息时调用，更新对应房间的缓存
+        """
+        rooms = expand_sensor_snapshot(payload.get("rooms", {}))
+        for room_id, data in rooms.items():
+            data["reason"] = payload.get("reason")
+            data["updated_at"] = time.time()
+            self._rooms[room_id] = data
+
+    def get_all(self) -> dict:
+        """
+        返回所有房间的最新遥测数据
+        """
+        return dict(self._rooms)
+
+# 创建全局唯一实例
+telemetry_cache = TelemetryCache()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+重复命令测试脚本
+
+直接通过MQTT向节点发送两次相同correlation_id的窗帘命令，模拟MQTT重投或上位机重试：
+第一次命令执行完整的舵机动作（数秒），重复命令应由节点的去重缓存直接重放原回执（毫秒级），
+且回执内容与第一次完全一致。需要MQTT Broker和Node1在线，不经过API服务。
+"""
+
+import json
+import sys
+import threading
+import time
+import uuid
+
+import paho.mqtt.client as mqtt
+
+MQTT_BROKER_HOST = "localhost"
+MQTT_BROKER_PORT = 1883
+
+ROOM_ID = "livingroom"
+DEVICE_ID = "curtain"
+ACK_TIMEOUT = 10  # 秒，窗帘动作约5秒
+
+COMMAND_TOPIC = f"smarthome/{ROOM_ID}/{DEVICE_ID}/command"
+STATE_TOPIC = f"smarthome/{ROOM_ID}/{DEVICE_ID}/state"
+
+
+class AckWaiter:
+    """按correlation_id收集回执"""
+
+    def __init__(self):
+        self._acks = []
+        self._cond = threading.Condition()
+
+    def on_message(self, client, userdata, msg):
+        payload = json.loads(msg.payload.decode())
+        with self._cond:
+            self._acks.append((time.perf_counter(), payload))
+            self._cond.notify_all()
+
+    def wait(self, correlation_id, count, timeout):
+        """等待指定correlation_id的第count条回执，返回(到达时间, 回执)"""
+        deadline = time.perf_counter() + timeout
+        with self._cond:
+            while True:
+                matched = [a for a in self._acks if a[1].get("correlation_id") == correlation_id]
+                if len(matched) >= count:
+                    return matched[count - 1]
+                remaining = deadline - time.perf_counter()
+                if remaining <= 0:
+                    return None
+                self._cond.wait(remaining)
+
+
+def send_and_wait(client, waiter, payload, count):
+    """发送命令并等待回执，返回(耗时ms, 回执)"""
+    start = time.perf_counter()
+    client.publish(COMMAND_TOPIC, json.dumps(payload))
+    ack = waiter.wait(payload["correlation_id"], count, ACK_TIMEOUT)
+    if ack is None:
+        return None, None
+    return (ack[0] - start) * 1000, ack[1]
+
+
+def main():
+    host = sys.argv[1] if len(sys.argv) > 1 else MQTT_BROKER_HOST
+    waiter = AckWaiter()
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION1)
+    client.on_message = waiter.on_message
+    client.connect(host, MQTT_BROKER_PORT, 60)
+    client.subscribe(STATE_TOPIC)
+    client.loop_start()
+    time.sleep(0.5)
+
+    print("重复命令测试 (关联ID去重缓存)")
+    print("=" * 60)
+    passed = True
+    try:
+        # 先关闭窗帘，确保第一次ON命令会执行完整的舵机动作
+        send_and_wait(client, waiter, {"action": "OFF", "correlation_id": str(uuid.uuid4())}, 1)
+
+        payload = {"action": "ON", "correlation_id": str(uuid.uuid4())}
+        first_ms, first_ack = send_and_wait(client, waiter, payload, 1)
+        duplicate_ms, duplicate_ack = send_and_wait(client, waiter, payload, 2)
+
+        if first_ack is None or duplicate_ack is None:
+            print("✗ 失败: 未收到回执")
+            passed = False
+        else:
+            print(f"{'第一次命令':<12}{first_ms:>10.1f} ms  {first_ack}")
+            print(f"{'重复命令':<12}{duplicate_ms:>10.1f} ms  {duplicate_ack}")
+            if duplicate_ack != first_ack:
+                print("✗ 失败: 重复命令的回执与原回执不一致")
+                passed = False
+            elif duplicate_ms >= first_ms / 10:
+                print("✗ 失败: 重复命令被再次执行")
+                passed = False
+            else:
+                print(f"✓ 通过: 重复命令直接重放回执，耗时为第一次的{duplicate_ms / first_ms:.1%}")
+    finally:
+        client.loop_stop()
+        client.disconnect()
+    sys.exit(0 if passed else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+消息编码对比脚本
+
+对比JSON与MessagePack两种格式下，典型命令和回执消息的负载大小与编解码耗时。
+消息内容与ESP32节点实际收发的格式一致，无需连接API服务或设备。
+这里测量的是上位机（Python）一侧的编解码；节点一侧MessageWriter的编码耗时见
+GenericDeviceController/native/bench/trace_replay.cpp的bench_codec()（主机构建的[Codec]一节）。
+"""
+
+import json
+import timeit
+import msgpack
+
+# 编解码重复次数
+ITERATIONS = 20000
+
+CORRELATION_ID = "550e8400-e29b-41d4-a716-446655440000"
+
+# 典型消息：命令（上位机 -> 节点）与回执（节点 -> 上位机）
+SAMPLES = {
+    "command ON": {"action": "ON", "value": None, "correlation_id": CORRELATION_ID},
+    "command SET_TEMP": {"action": "SET_TEMP", "value": 23, "correlation_id": CORRELATION_ID},
+    "ack state": {"state": "ON", "correlation_id": CORRELATION_ID},
+    "ack sensor": {"state": "READ", "correlation_id": CORRELATION_ID, "value": 26.1, "unit": "°C"},
+    "ack ac": {"state": "SET_TEMP", "correlation_id": CORRELATION_ID, "temperature": 23, "unit": "°C"},
+    "ack error": {
+        "state": "ERROR", "correlation_id": CORRELATION_ID,
+        "error_code": "DEVICE_NOT_FOUND", "error_message": "Device not found in this node's configuration"
+    },
+    "ack snapshot": {
+        "state": "READ_ALL", "correlation_id": CORRELATION_ID,
+        "rooms": {
+            "livingroom": [24.5, 45.2, 65, 0, 0],
+            "bedroom": [23.8, 48.5, 45, 0, 0],
+            "kitchen": [26.1, 52.3, 70, 0, 0],
+            "bathroom": [25.3, 65.8, 55, 0, 0],
+            "outdoor": [20.0, 60.0, 85, 0, 0]
+        }
+    },
+    "batch command": {
+        "correlation_id": CORRELATION_ID,
+        "commands": [
+            {"room": "livingroom", "device": "light", "action": "OFF", "value": None},
+            {"room": "bedroom", "device": "light", "action": "OFF", "value": None},
+            {"room": "bedroom", "device": "curtain", "action": "OFF", "value": None},
+            {"room": "kitchen", "device": "hood", "action": "OFF", "value": None},
+            {"room": "bathroom", "device": "fan", "action": "OFF", "value": None}
+        ]
+    },
+}
+
+
+def json_encode(payload):
+    return json.dumps(payload, ensure_ascii=False, separators=(",", ":")).encode()
+
+
+def json_decode(data):
+    return json.loads(data.decode())
+
+
+def msgpack_encode(payload):
+    return msgpack.packb(payload, use_bin_type=True)
+
+
+def msgpack_decode(data):
+    return msgpack.unpackb(data, raw=False)
+
+
+def measure_us(func, arg):
+    """单次调用的平均耗时（微秒）"""
+    return timeit.timeit(lambda: func(arg), number=ITERATIONS) / ITERATIONS * 1e6
+
+
+def main():
+    print("消息编码对比 (JSON vs MessagePack)")
+    print("=" * 92)
+    print(f"{'消息':<18}{'JSON字节':>10}{'MsgPack字节':>13}{'节省':>8}"
+          f"{'JSON编码us':>12}{'MsgPack编码us':>15}{'JSON解码us':>12}{'MsgPack解码us':>15}")
+    print("-" * 92)
+
+    total_json = 0
+    total_msgpack = 0
+    for name, payload in SAMPLES.items():
+        json_data = json_encode(payload)
+        msgpack_data = msgpack_encode(payload)
+        # 两种格式解码结果必须一致
+        assert json_decode(json_data) == msgpack_decode(msgpack_data), name
+
+        total_json += len(json_data)
+        total_msgpack += len(msgpack_data)
+        saving = 1 - len(msgpack_data) / len(json_data)
+        print(f"{name:<18}{len(json_data):>10}{len(msgpack_data):>13}{saving:>8.0%}"
+              f"{measure_us(json_encode, payload):>12.2f}{measure_us(msgpack_encode, payload):>15.2f}"
+              f"{measure_us(json_decode, json_data):>12.2f}{measure_us(msgpack_decode, msgpack_data):>15.2f}")
+
+    print("-" * 92)
+    print(f"{'合计':<18}{total_json:>10}{total_msgpack:>13}{1 - total_msgpack / total_json:>8.0%}")
+
+
+if __name__ == "__main__":
+    main()
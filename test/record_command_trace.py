@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+命令录制脚本
+
+订阅Broker上所有设备的命令Topic（含批量命令），把收到的命令按到达时间写成trace文件，
+供固件的主机基准测试（GenericDeviceController/native/bench/trace_replay.cpp）回放。
+只录制命令，不需要节点在线；API服务或上位机照常发送命令即可。按Ctrl+C结束录制。
+
+trace格式：每行一条命令 "<相对首条命令的毫秒数> <topic> <payload>"，#开头的行为注释。
+MessagePack等二进制负载无法写成单行文本，录制时跳过。
+"""
+
+import sys
+import time
+
+import paho.mqtt.client as mqtt
+
+MQTT_BROKER_HOST = "localhost"
+MQTT_BROKER_PORT = 1883
+COMMAND_TOPIC = "smarthome/+/+/command"
+DEFAULT_OUTPUT = "command.trace"
+
+
+class TraceRecorder:
+    """把收到的命令写入trace文件，时间以首条命令为0"""
+
+    def __init__(self, path):
+        self._file = open(path, "w", encoding="utf-8")
+        self._file.write(f"# 录制于{time.strftime('%Y-%m-%d %H:%M:%S')}，订阅{COMMAND_TOPIC}\n")
+        self._file.write("# <相对首条命令的毫秒数> <topic> <payload>\n")
+        self._start = None
+        self.count = 0
+        self.skipped = 0
+
+    def on_message(self, client, userdata, msg):
+        try:
+            payload = msg.payload.decode("utf-8")
+        except UnicodeDecodeError:
+            self.skipped += 1
+            return
+        if "\n" in payload:
+            payload = " ".join(payload.split())
+        now = time.perf_counter()
+        if self._start is None:
+            self._start = now
+        offset_ms = int((now - self._start) * 1000)
+        self._file.write(f"{offset_ms} {msg.topic} {payload}\n")
+        self._file.flush()
+        self.count += 1
+        print(f"{offset_ms:>8} ms  {msg.topic}")
+
+    def close(self):
+        self._file.close()
+
+
+def main():
+    output = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_OUTPUT
+    host = sys.argv[2] if len(sys.argv) > 2 else MQTT_BROKER_HOST
+    recorder = TraceRecorder(output)
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION1)
+    client.on_message = recorder.on_message
+    client.connect(host, MQTT_BROKER_PORT, 60)
+    client.subscribe(COMMAND_TOPIC)
+
+    print(f"正在录制{COMMAND_TOPIC}到{output}，按Ctrl+C结束...")
+    try:
+        client.loop_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        client.disconnect()
+        recorder.close()
+    print(f"已录制{recorder.count}条命令，跳过{recorder.skipped}条二进制负载")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+断线恢复测试脚本
+
+在节点与MQTT Broker之间运行一个TCP代理，反复切断节点的连接：每次断线期间直接向Broker发布若干条QoS 1的灯光命令，
+恢复后统计节点的重连耗时（代理恢复到节点重新建立连接）、恢复耗时（代理恢复到收到第一条补发命令的回执）
+以及最终没有收到回执的命令数。分别以MQTT_PERSISTENT_SESSION为0和1编译固件运行本脚本，即可对比两种会话模式。
+
+准备：将Node1配置中的MQTT_PORT改为代理端口（默认1884），MQTT_SERVER指向运行本脚本的主机；
+本地mosquitto监听1883端口。不需要API服务。
+"""
+
+import json
+import select
+import socket
+import sys
+import threading
+import time
+import uuid
+
+import paho.mqtt.client as mqtt
+
+MQTT_BROKER_HOST = "localhost"
+MQTT_BROKER_PORT = 1883
+PROXY_PORT = 1884
+
+ROOM_ID = "livingroom"
+DEVICE_ID = "light"
+CYCLES = 10                 # 断线次数
+OUTAGE_SECONDS = 3          # 每次断线时长
+COMMANDS_PER_OUTAGE = 3     # 每次断线期间发布的命令数
+ACK_TIMEOUT = 15            # 秒，恢复后等待补发命令回执的时间
+
+COMMAND_TOPIC = f"smarthome/{ROOM_ID}/{DEVICE_ID}/command"
+STATE_TOPIC = f"smarthome/{ROOM_ID}/{DEVICE_ID}/state"
+
+
+class CuttableProxy:
+    """把节点的连接转发到Broker，可随时切断全部连接并在断线期间拒绝新连接"""
+
+    def __init__(self, listen_port, broker_host, broker_port):
+        self._broker = (broker_host, broker_port)
+        self._server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self._server.bind(("0.0.0.0", listen_port))
+        self._server.listen(4)
+        self._lock = threading.Lock()
+        self._sockets = []
+        self._up = True
+        self.last_connect = None    # 最近一次建立转发的时间
+        threading.Thread(target=self._accept_loop, daemon=True).start()
+
+    def cut(self):
+        """切断全部连接（两端同时关闭，Broker立即感知节点离线），之后拒绝新连接"""
+        with self._lock:
+            self._up = False
+            for s in self._sockets:
+                try:
+                    s.shutdown(socket.SHUT_RDWR)
+                except OSError:
+                    pass
+                s.close()
+            self._sockets = []
+
+    def restore(self):
+        with self._lock:
+            self._up = True
+
+    def _accept_loop(self):
+        while True:
+            node, _ = self._server.accept()
+            with self._lock:
+                if not self._up:
+                    node.close()
+                    continue
+                try:
+                    broker = socket.create_connection(self._broker)
+                except OSError:
+                    node.close()
+                    continue
+                self._sockets += [node, broker]
+                self.last_connect = time.perf_counter()
+            threading.Thread(target=self._pump, args=(node, broker), daemon=True).start()
+
+    @staticmethod
+    def _pump(a, b):
+        peers = {a: b, b: a}
+        try:
+            while True:
+                readable, _, _ = select.select([a, b], [], [])
+                for s in readable:
+                    data = s.recv(4096)
+                    if not data:
+                        return
+                    peers[s].sendall(data)
+        except (OSError, ValueError):
+            pass
+        finally:
+            a.close()
+            b.close()
+
+
+class AckCollector:
+    """记录每个correlation_id第一条回执的到达时间"""
+
+    def __init__(self):
+        self._acks = {}
+        self._cond = threading.Condition()
+
+    def on_message(self, client, userdata, msg):
+        payload = json.loads(msg.payload.decode())
+        with self._cond:
+            self._acks.setdefault(payload.get("correlation_id"), (time.perf_counter(), payload))
+            self._cond.notify_all()
+
+    def wait_all(self, correlation_ids, timeout):
+        """等待一组命令的回执，返回已收到的 {correlation_id: (到达时间, 回执)}"""
+        deadline = time.perf_counter() + timeout
+        with self._cond:
+            while True:
+                received = {c: self._acks[c] for c in correlation_ids if c in self._acks}
+                remaining = deadline - time.perf_counter()
+                if len(received) == len(correlation_ids) or remaining <= 0:
+                    return received
+                self._cond.wait(remaining)
+
+
+def main():
+    host = sys.argv[1] if len(sys.argv) > 1 else MQTT_BROKER_HOST
+    proxy = CuttableProxy(PROXY_PORT, host, MQTT_BROKER_PORT)
+    collector = AckCollector()
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION1)
+    client.on_message = collector.on_message
+    client.connect(host, MQTT_BROKER_PORT, 60)
+    client.subscribe(STATE_TOPIC)
+    client.loop_start()
+
+    print(f"断线恢复测试：等待节点经代理端口{PROXY_PORT}连接...")
+    while proxy.last_connect is None:
+        time.sleep(0.1)
+    time.sleep(2)   # 等待节点完成订阅
+
+    print(f"{'轮次':<6}{'重连(ms)':>10}{'恢复(ms)':>10}{'丢失':>6}")
+    print("-" * 32)
+    reconnect_times, recovery_times, lost_total = [], [], 0
+    try:
+        for cycle in range(1, CYCLES + 1):
+            proxy.cut()
+            sent = []
+            for i in range(COMMANDS_PER_OUTAGE):
+                correlation_id = str(uuid.uuid4())
+                action = "ON" if (cycle + i) % 2 else "OFF"
+                client.publish(COMMAND_TOPIC, json.dumps({"action": action, "correlation_id": correlation_id}), qos=1)
+                sent.append(correlation_id)
+            time.sleep(OUTAGE_SECONDS)
+
+            restored = time.perf_counter()
+            proxy.restore()
+            received = collector.wait_all(sent, ACK_TIMEOUT)
+
+            reconnect_ms = (proxy.last_connect - restored) * 1000 if proxy.last_connect > restored else None
+            recovery_ms = (min(r[0] for r in received.values()) - restored) * 1000 if received else None
+            lost = len(sent) - len(received)
+            lost_total += lost
+            if reconnect_ms is not None:
+                reconnect_times.append(reconnect_ms)
+            if recovery_ms is not None:
+                recovery_times.append(recovery_ms)
+            print(f"{cycle:<6}{reconnect_ms if reconnect_ms is not None else float('nan'):>10.0f}"
+                  f"{recovery_ms if recovery_ms is not None else float('nan'):>10.0f}{lost:>6}")
+            time.sleep(1)
+    finally:
+        client.loop_stop()
+        client.disconnect()
+
+    print("-" * 32)
+    if reconnect_times:
+        print(f"平均重连耗时: {sum(reconnect_times) / len(reconnect_times):.0f} ms")
+    if recovery_times:
+        print(f"平均恢复耗时: {sum(recovery_times) / len(recovery_times):.0f} ms")
+    print(f"丢失命令: {lost_total}/{CYCLES * COMMANDS_PER_OUTAGE}")
+    sys.exit(0 if lost_total == 0 else 1)
+
+
+if __name__ == "__main__":
+    main()